@@ -335,7 +335,7 @@ void SVGP::AddObservation(const std::vector<Vector>& x, const std::vector<real>&
 	FullUpdateGaussianProcess();
 }
 void SVGP::AddObservation(const Vector& x, const real& y) {
-	X.AddRow(x);
+	X.AppendRow(x);
 	Y.AddElement(y);
 }
 void SVGP::Clear() {
@@ -78,7 +78,7 @@ public:
 		assert(weights_.Size()==weights.Size());
 		weights = weights_;
 	}
-	virtual Vector getWeights()
+	virtual const Vector& getWeights() const
 	{
 		return weights;
 	}
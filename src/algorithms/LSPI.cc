@@ -19,10 +19,11 @@ LSPI::LSPI(real gamma_, real Delta_, int n_dimension_, int n_actions_, int max_i
   max_iteration(max_iteration_),
   bfs(bfs_), 
   Samples(Samples_), 
-  policy(n_dimension, n_actions, bfs)
+  policy(n_dimension, n_actions, bfs),
+  features(n_actions, bfs->size())
 {
 	assert(gamma>=0 && gamma <=1);
-	n_basis = n_actions*(bfs->size() + 1);
+	n_basis = features.Size();
 	algorithm = 1;
 	A.Resize(n_basis, n_basis);
 	A = Matrix::Unity(n_basis,n_basis) * 1e-6;
@@ -39,11 +40,12 @@ LSPI::LSPI(real gamma_, real Delta_, int n_dimension_, int n_actions_, int max_i
      algorithm(algorithm_),
      bfs(bfs_), 
 	 Samples(Samples_), 
-     policy(n_dimension, n_actions, bfs)
+     policy(n_dimension, n_actions, bfs),
+     features(n_actions, bfs->size())
 {
 	assert(gamma>=0 && gamma <=1);
 	assert(algorithm>=1 && algorithm<=2);
-	n_basis = n_actions*(bfs->size() + 1);
+	n_basis = features.Size();
 //	n_basis = n_actions*20;
 	A.Resize(n_basis, n_basis);
 	A = Matrix::Unity(n_basis,n_basis) * 1e-6;
@@ -58,14 +60,7 @@ LSPI::~LSPI()
 Vector LSPI::BasisFunction(const Vector& state, int action)
 {
 	bfs->Evaluate(state);
-	Vector Phi_state = bfs->F();
-	Vector Phi(n_basis);
-	Phi[(bfs->size() + 1)*action] = 1.0;
-	for(int i = 0; i<bfs->size(); ++i)
-	{
-            Phi[(bfs->size() + 1)*action + i + 1] = Phi_state[i];
-	}
-	return Phi;
+	return features.Features(bfs->F(), action);
 }
 
 //Vector LSPI::BasisFunction(const Vector& state, int action)
@@ -96,63 +91,55 @@ Vector LSPI::BasisFunction(const Vector& state, int action)
 //	return phi;
 //}
 
+/** Evaluate the current policy on the stored samples.
+
+    Only the blocks of A for the sampled actions are updated (see
+    StateActionFeatures), and the weights are obtained by solving
+    \f$A w = b\f$ rather than by inverting A.
+ */
 void LSPI::LSTDQ()
 {
-	Vector Phi_;
-	Vector Phi;
-	Matrix res;
-
     A = Matrix::Unity(n_basis,n_basis) * 1e-6;
     b.Clear();
         
     for(int i=0; i<Samples->getNRollouts(); ++i) {
         for(int j=0; j<Samples->getNSamples(i); ++j) {
-            Phi_ = BasisFunction(Samples->getState(i,j), Samples->getAction(i,j));
+            bfs->Evaluate(Samples->getState(i,j));
+            Vector f = bfs->F();
+            int a = Samples->getAction(i,j);
+            real r = Samples->getReward(i,j);
             if(Samples->getEndsim(i,j)){
-                res = OuterProduct(Phi_, Phi_);
+                features.AddSample(A, b, f, a, r);
             } else{
-                Phi = BasisFunction(Samples->getNextState(i,j),policy.SelectAction(Samples->getNextState(i,j)));
-                res = OuterProduct(Phi_,(Phi_ - (Phi*gamma)));
+                int a2 = policy.SelectAction(Samples->getNextState(i,j));
+                bfs->Evaluate(Samples->getNextState(i,j));
+                features.AddSample(A, b, f, a, r, bfs->F(), a2, gamma);
             }
-            A += res;
-            b += Phi_*Samples->getReward(i,j);
         }
     }
-    const Matrix w_ = A.Inverse_LU();
-    w = w_*b;
+    w = A.LU_Solve(b);
 }
 void LSPI::LSTDQ(const Vector& state, const int& action, const real& reward, const Vector& state_, const int& action_, const bool& endsim, const bool& update) 
 {
-	Vector Phi_;
-	Vector Phi;
-	Matrix res;
-	
-	Phi_ = BasisFunction(state, action);
+	bfs->Evaluate(state);
+	Vector f = bfs->F();
 	if(endsim) {
-		res = OuterProduct(Phi_, Phi_);
+		features.AddSample(A, b, f, action, reward);
 	}
 	else {
-		Phi = BasisFunction(state_,action_);
-		res = OuterProduct(Phi_,(Phi_ - (Phi*gamma)));
+		bfs->Evaluate(state_);
+		features.AddSample(A, b, f, action, reward, bfs->F(), action_, gamma);
 	}
-	
-	A += res;
-	b += Phi_*reward;
 
-	
-	const Matrix w_ = A.Inverse_LU();
-	w = w_*b;
+	w = A.LU_Solve(b);
 }
 void LSPI::Update()
 {
 	policy.Update(w);
 }
+/// As LSTDQ(), but with A holding the inverse, updated by Sherman-Morrison.
 void LSPI::LSTDQ_OPT()
 {
-	Vector Phi_;
-	Vector Phi;
-	Vector Phi_dif;
-	Matrix res;
 	real d = 0.000001;
 	A = Matrix::Unity(n_basis,n_basis) * (1/d);
 	b.Clear();
@@ -161,23 +148,21 @@ void LSPI::LSTDQ_OPT()
         {
             for(int j=0; j<Samples->getNSamples(i); ++j)
                 {
-                    Phi_ = BasisFunction(Samples->getState(i,j), Samples->getAction(i,j));
+                    bfs->Evaluate(Samples->getState(i,j));
+                    Vector f = bfs->F();
+                    int a = Samples->getAction(i,j);
+                    real r = Samples->getReward(i,j);
                     if(Samples->getEndsim(i,j)){
-                        Phi_dif = Phi_;
+                        features.AddSampleInverse(A, b, f, a, r);
                     }
                     else{
-                        Phi = BasisFunction(Samples->getNextState(i,j),policy.SelectAction(Samples->getNextState(i,j)));
-                        Phi_dif = Phi_ - (Phi*gamma);
+                        int a2 = policy.SelectAction(Samples->getNextState(i,j));
+                        bfs->Evaluate(Samples->getNextState(i,j));
+                        features.AddSampleInverse(A, b, f, a, r, bfs->F(), a2, gamma);
                     }
-                    res = OuterProduct(Phi_,Phi_dif);
-                    const Matrix p = A;
-                    real v = Product(p*Phi_,Phi_dif);
-                    A -= (((A*res)*A) / (v + 1));
-                    b += Phi_ * Samples->getReward(i,j);
                 }
         }
-	const Matrix w_ = A;
-	w = w_*b;
+	w = A * b;
 }
 
 void LSPI::PolicyIteration()
@@ -18,6 +18,7 @@
 #include "Vector.h"
 #include "Matrix.h"
 #include "BasisSet.h"
+#include "StateActionFeatures.h"
 #include "ContinuousPolicy.h"
 #include "RandomPolicy.h"
 #include <vector>
@@ -38,6 +39,7 @@ protected:
 	RBFBasisSet* bfs;
 	Rollout<Vector,int,AbstractPolicy<Vector, int> >* Samples;
 	FixedContinuousPolicy policy;
+	StateActionFeatures features;
 public:	
 	LSPI(real gamma_, real Delta_, int n_dimension_, int n_actions_, int max_iteration_, RBFBasisSet* bfs_, Rollout<Vector,int,AbstractPolicy<Vector, int> >* Samples_);
 	LSPI(real gamma_, real Delta_, int n_dimension_, int n_actions_, int max_iteration_, int algorithm_, RBFBasisSet* bfs_, Rollout<Vector,int,AbstractPolicy<Vector, int> >* Samples_);
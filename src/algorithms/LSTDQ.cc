@@ -10,6 +10,9 @@
  ***************************************************************************/
 
 #include "LSTDQ.h"
+#include "ParallelFor.h"
+#include <algorithm>
+#include <utility>
 
 LSTDQ::LSTDQ(real gamma_,
              int n_dimension_,
@@ -20,10 +23,13 @@ LSTDQ::LSTDQ(real gamma_,
 	 n_dimension(n_dimension_), 
 	 n_actions(n_actions_), 
 	 bfs(bfs_), Samples(Samples_), 
-	 policy(n_dimension, n_actions, &bfs)
+	 policy(n_dimension, n_actions, &bfs),
+	 features(n_actions, bfs.size()),
+	 n_threads(1),
+	 n_shards(1)
 {
     assert(gamma>=0 && gamma <=1);
-    n_basis = n_actions*(bfs.size() + 1);
+    n_basis = features.Size();
     algorithm = 1;
     A.Resize(n_basis, n_basis);
     b.Resize(n_basis);
@@ -41,11 +47,14 @@ LSTDQ::LSTDQ(real gamma_,
 	 n_actions(n_actions_), 
 	 algorithm(algorithm_),
 	 bfs(bfs_), Samples(Samples_), 
-	 policy(n_dimension, n_actions, &bfs)
+	 policy(n_dimension, n_actions, &bfs),
+	 features(n_actions, bfs.size()),
+	 n_threads(1),
+	 n_shards(1)
 {
     assert(gamma>=0 && gamma <=1);
     assert(algorithm>=1 && algorithm<=2);
-    n_basis = n_actions*(bfs.size() + 1);
+    n_basis = features.Size();
     A.Resize(n_basis, n_basis);
     b.Resize(n_basis);
     w.Resize(n_basis);
@@ -58,56 +67,100 @@ LSTDQ::~LSTDQ()
 Vector LSTDQ::BasisFunction(const Vector& state, int action) const
 {
     bfs.Evaluate(state);
-    Vector Phi_state = bfs.F();
-    Vector Phi(n_basis);
-    Phi[(bfs.size() + 1)*action] = 1.0;
-    
-    for(int i = 0; i<bfs.size(); ++i)
-        {
-            Phi[(bfs.size() + 1)*action + i + 1] = Phi_state[i];
-        }
-    return Phi;
+    return features.Features(bfs.F(), action);
 }
 
-void LSTDQ::Calculate()
+/** Add the samples of trajectories [begin, end) to A_ and b_.
+
+    The features of each trajectory are evaluated in one batch, and
+    the block structure of the state-action features is used to update
+    A_. Only phi is modified otherwise, so that calls with different
+    buffers can run concurrently.
+ */
+void LSTDQ::Accumulate(int begin, int end, Matrix& A_, Vector& b_,
+                       StateActionFeatures& phi) const
 {
-    Vector Phi_;
-    Vector Phi;
-    Matrix res;
-    A = Matrix::Unity(n_basis,n_basis) * 1e-6;
-    b.Clear();
-	
-    for(uint i=0; i<Samples.size(); ++i) {
+    Matrix S;
+    Matrix F;
+    for(int i=begin; i<end; ++i) {
 		//logmsg ("Trajectory %d\n", i);
 		if (Samples.length(i) <= 0) {
 			Swarning("sample legnth %d is %d\n", i, Samples.length(i));
+			continue;
 		}
-        for(int t=0; t<(int)Samples.length(i) - 1; ++t) {
-            Vector s_t = Samples.state(i,t); 
+        int T = Samples.length(i);
+        S.Resize(T, Samples.state(i, 0).Size());
+        for (int t=0; t<T; ++t) {
+            S.setRow(t, Samples.state(i, t));
+        }
+        bfs.Evaluate(S, F);
+        for(int t=0; t<T - 1; ++t) {
             int a_t = Samples.action(i,t);
-            Phi_ = BasisFunction(s_t, a_t);
-            if (Samples.terminated(i) && t >= (int)Samples.length(i) - 3) {
-                res =  OuterProduct(Phi_, Phi_);
+            real r_t = Samples.reward(i,t);
+            if (Samples.terminated(i) && t >= T - 3) {
+                phi.AddSample(A_, b_, F.getRow(t), a_t, r_t);
             } else {
-                Vector s2 = Samples.state(i, t+1);
                 //int a2 = policy.SelectAction(s2);
                 int a2 = Samples.action(i, t+1);
-                Phi = BasisFunction(s2, a2);
-                res = OuterProduct(Phi_,(Phi_ - (Phi*gamma)));
+                phi.AddSample(A_, b_, F.getRow(t), a_t, r_t,
+                              F.getRow(t + 1), a2, gamma);
             }
-            A += res;
-            b += Phi_* Samples.reward(i,t);
         }
     }
-    const Matrix w_ = A.Inverse_LU();
-    w = w_*b;
 }
+
+/** Compute the weights from all samples.
+
+    The weights are obtained by solving \f$A w = b\f$ directly.
+
+    The trajectories are split into n_shards contiguous shards. Each
+    shard is accumulated into its own A and b, using up to n_threads
+    threads, and the shards are then summed pairwise in a fixed tree
+    order. The result thus only depends on n_shards, and not on the
+    number of threads or their scheduling. With the default of one
+    shard, this is the plain sequential sum, and several threads have
+    nothing to share. Each shard needs its own copy of A, so memory
+    grows linearly with n_shards.
+ */
+void LSTDQ::Calculate()
+{
+    int n_trajectories = Samples.size();
+    int n_parts = std::max(1, std::min(n_shards, n_trajectories));
+    std::vector<Matrix> A_part(n_parts, Matrix(n_basis, n_basis));
+    std::vector<Vector> b_part(n_parts, Vector(n_basis));
+    A_part[0] = Matrix::Unity(n_basis,n_basis) * 1e-6;
+    ParallelFor(n_parts, n_threads,
+                [&](int begin, int end, int block) {
+                    StateActionFeatures phi(features);
+                    for (int k=begin; k<end; ++k) {
+                        Accumulate(k * n_trajectories / n_parts,
+                                   (k + 1) * n_trajectories / n_parts,
+                                   A_part[k], b_part[k], phi);
+                    }
+                });
+    for (int stride=1; stride<n_parts; stride *= 2) {
+        int n_pairs = (n_parts - stride + 2 * stride - 1) / (2 * stride);
+        ParallelFor(n_pairs, n_threads,
+                    [&](int begin, int end, int block) {
+                        for (int p=begin; p<end; ++p) {
+                            int k = 2 * stride * p;
+                            A_part[k] += A_part[k + stride];
+                            b_part[k] += b_part[k + stride];
+                        }
+                    });
+    }
+    A = std::move(A_part[0]);
+    b = std::move(b_part[0]);
+    w = A.LU_Solve(b);
+}
+
+/** Compute the weights incrementally.
+
+    Here A holds the inverse of the LSTDQ matrix, which is updated
+    with the Sherman-Morrison formula after each sample.
+ */
 void LSTDQ::Calculate_Opt()
 {
-    Vector Phi_;
-    Vector Phi;
-    Vector Phi_dif;
-    Matrix res;
     real d = 0.000001;
     A = Matrix::Unity(n_basis,n_basis) * (1/d);
     b.Clear();
@@ -116,19 +169,16 @@ void LSTDQ::Calculate_Opt()
 		//logmsg ("Trajectory %d\n", i);
         for(int t=0; t<(int) Samples.length(i) - 1; ++t) {
 			//logmsg ("Time %d/%d\n", t, Samples.length(i));
-            Phi_ = BasisFunction(Samples.state(i,t), Samples.action(i,t));
+            bfs.Evaluate(Samples.state(i,t));
+            Vector f = bfs.F();
             Vector s = Samples.state(i, t+1);
-            Phi = BasisFunction(s,policy.SelectAction(s));
-            Phi_dif = Phi_ - (Phi*gamma);
-            res = OuterProduct(Phi_,Phi_dif);
-            const Matrix p = A;
-            real v = Product(p*Phi_,Phi_dif);
-            A -= (((A*res)*A) / (v + 1));
-            b += Phi_ * Samples.reward(i,t);
+            int a2 = policy.SelectAction(s);
+            bfs.Evaluate(s);
+            features.AddSampleInverse(A, b, f, Samples.action(i,t), Samples.reward(i,t),
+                                      bfs.F(), a2, gamma);
         }
     }
-    const Matrix w_ = A;
-    w = w_*b;
+    w = A * b;
 }
 
 /// This seems to return zero all the time!
@@ -17,6 +17,7 @@
 #include "Vector.h"
 #include "Matrix.h"
 #include "BasisSet.h"
+#include "StateActionFeatures.h"
 #include "ContinuousPolicy.h"
 #include "RandomPolicy.h"
 #include <vector>
@@ -36,6 +37,11 @@ protected:
 	RBFBasisSet& bfs;
 	Demonstrations<Vector, int>& Samples;
 	FixedContinuousPolicy policy;
+	StateActionFeatures features;
+	int n_threads; ///< threads for Calculate() (<= 0: all cores)
+	int n_shards; ///< trajectory shards for the parallel Calculate()
+	void Accumulate(int begin, int end, Matrix& A_, Vector& b_,
+					StateActionFeatures& phi) const;
 public:	
 	LSTDQ(real gamma_,
 		 int n_dimension_,
@@ -53,8 +59,34 @@ public:
 	
 	Vector BasisFunction(const Vector& state, int action) const;
 	void Calculate();
+	/// Use n_threads_ threads in Calculate(), which needs several shards
+	void setNThreads(int n_threads_)
+	{
+		n_threads = n_threads_;
+	}
+	/// Split the trajectories into n_shards_ parts in Calculate()
+	void setNShards(int n_shards_)
+	{
+		assert(n_shards_ > 0);
+		n_shards = n_shards_;
+	}
 	void Calculate_Opt();
 	void Reset();
+	/// The matrix accumulated by Calculate()
+	const Matrix& getMatrix() const
+	{
+		return A;
+	}
+	/// The vector accumulated by Calculate()
+	const Vector& getVector() const
+	{
+		return b;
+	}
+	/// The weights found by Calculate()
+	const Vector& getWeights() const
+	{
+		return w;
+	}
 	real getValue(const Vector& state, int action) const;
 	real getValue(const Vector& state) const
 	{
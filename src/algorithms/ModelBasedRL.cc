@@ -91,7 +91,14 @@ int ModelBasedRL::Act(real reward, int next_state)
         //mdp = model->CreateMeanMDP();
         // update values
         value_iteration->setMDP(mdp);
-        value_iteration->ComputeStateValues(1e-6,1);
+        if (model->TracksDirtyStateActions()) {
+            // replan only around the state-actions that changed,
+            // spending at most as many backups as a full sweep
+            value_iteration->ComputeStateValuesIncremental(model->getDirtyStateActions(), 1e-6, n_states);
+            model->ClearDirtyStateActions();
+        } else {
+            value_iteration->ComputeStateValues(1e-6,1);
+        }
         for (int i=0; i<n_actions; i++) {
             tmpQ[i] = value_iteration->getValue(next_state, i);
         }
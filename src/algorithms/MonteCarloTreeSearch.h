@@ -23,11 +23,31 @@
 #include "Grid.h"
 #include "Environment.h"
 #include "Random.h"
+#include "ParallelFor.h"
 #include <limits>
+#include <vector>
+#include <algorithm>
+#include <mutex>
 
 /** The original UCT Monte Carlo Tree Seach algorithm.
    
-	
+	Nodes are kept in a pool owned by the tree and refer to each other
+	by index, with the children of node i stored contiguously at
+	children[i * nActions + a]. Discarding the tree only resets a
+	counter, so after the first few decisions no memory is allocated
+	for nodes. Optionally, the subtree under the chosen action is kept
+	for the next decision, if its state matches the one observed.
+
+	The search can use more than one thread: see AddThread(). Each
+	extra thread brings its own environment, rollout policy and random
+	number generator, since none of these can be shared. With
+	ROOT_PARALLEL every thread grows an independent tree from the
+	current state and the root statistics are merged before choosing
+	an action. With TREE_PARALLEL all threads grow the same tree,
+	which is locked for selection, expansion and backpropagation but
+	not for the rollouts. Simulations in flight add a virtual loss to
+	the nodes they pass through, so that other threads explore
+	elsewhere in the meantime.
  */
 template <class S, class A>
 class MonteCarloTreeSearch
@@ -40,256 +60,501 @@ private:
   int MaxDepth;                  // Maximum tree depth.
   int NRollouts;                 // Number of sampled rollouts.
   int nActions;
+  bool reuse_subtree;            // Keep the chosen subtree between calls.
 public:
+  enum ParallelMode {
+    ROOT_PARALLEL, ///< independent trees, merged at the root
+    TREE_PARALLEL  ///< one shared tree, with virtual loss
+  };
   struct Node {
     int depth;     // Depth
     S state;
     double reward; //Reward received during the transition from the father's state  
-    Node* father;  //Contains the previous state at the trajectory.
-    MonteCarloTreeSearch& tree;
+    int father;    //Index of the previous state at the trajectory, -1 at the root.
     bool terminal; //Represents if the node is a terminal state.
-    bool leaf;     //Represents if the specific node is a leaf or not
-
-    double epsilon;
-    
-    std::vector<Node*> children; //Pointer to the childrens
+    int nChildren; //Number of expanded children; a leaf has fewer than nActions.
     int nVisits;  // Number of visits
+    int nPending; // Number of simulations in flight through this node
     double aveValue; // Mean Value
+  };
 
-    // Constructor
-    Node(const int& depth_, const S& state_, const double& reward_, MonteCarloTreeSearch::Node* const father_ , MonteCarloTreeSearch& tree_, const bool& terminal_ = false)
-      :	depth(depth_),   
-        state(state_),   //Node's state representation.
-	reward(reward_), //Reward received during the transition from the father node.
-	father(father_), //Father node.
-	tree(tree_),
-	terminal(terminal_)
-    {
-      epsilon  = 1E-06;
-      aveValue = 0; 
-      nVisits  = 0; 
-      leaf     = true;
-      children.resize(tree.nActions,NULL);
-    }
-    
-    Node(const S& state_, MonteCarloTreeSearch& tree_) 
-      : state(state_),   //Node's state representation.
-	tree(tree_)
-    {
-      depth    = 0;
-      reward   = 0;
-      father   = NULL;
-      terminal = false;
-      aveValue = 0;
-      nVisits  = 0;
-      leaf     = true;
-      children.resize(tree.nActions,NULL);
+  //Constructor
+  MonteCarloTreeSearch(const real& gamma_, ContinuousStateEnvironment* environment_, RandomNumberGenerator* rng_, AbstractPolicy<S, A>& policy_, const int& MaxDepth_ =  100, const int& NRollouts_ = 1000)
+    :gamma(gamma_),
+     environment(environment_),
+     rng(rng_),
+     policy(policy_),
+     MaxDepth(MaxDepth_),
+     NRollouts(NRollouts_),
+     reuse_subtree(false),
+     parallel_mode(ROOT_PARALLEL),
+     virtual_loss(1.0),
+     n_nodes(0),
+     root(-1),
+     last_action(-1)
+  {
+    nActions = environment->getNActions(); 
+  };
+
+  //Destructor
+  ~MonteCarloTreeSearch(){
+    for (unsigned int i=0; i<trees.size(); ++i) {
+      delete trees[i];
     }
+  };
 
-    // Destructor
-    ~Node() {
-      for(int i=0; i < tree.nActions; ++i)
-	delete children[i];
+  /// Keep the subtree under the selected action for the next call
+  void setReuseSubtree(bool reuse_subtree_) {
+    reuse_subtree = reuse_subtree_;
+    for (unsigned int i=0; i<trees.size(); ++i) {
+      trees[i]->setReuseSubtree(reuse_subtree_);
     }
+  }
 
-    void selectAction() {
-      Node* cur = this;
-      double RollingValue = 0;
+  /** Add a search thread.
 
-      // Selection phase (we cross the tree according to the UCT)
-      // printf("UCT Search\n");
-      while(cur->isLeaf() == false) {
-	cur = cur->UCTsearch(); //Tree policy
-      }
+      The environment, policy and random number generator are only
+      used by that thread and must not be shared with the tree or with
+      other threads. At the start of every search the thread also
+      seeds its own copy of the global generator behind urandom() from
+      rng_, so environments that call urandom() are safe to use.
+   */
+  void AddThread(ContinuousStateEnvironment* environment_, AbstractPolicy<S, A>* policy_, RandomNumberGenerator* rng_) {
+    Context context = {environment_, policy_, rng_};
+    contexts.push_back(context);
+    trees.push_back(new MonteCarloTreeSearch(gamma, environment_, rng_, *policy_, MaxDepth, NRollouts));
+    trees.back()->setReuseSubtree(reuse_subtree);
+  }
 
-      if(cur->isTerminal() == true) {
-      	RollingValue = cur->getReward();
-      } else {
-	// Expansion phase
-	//	while(cur->getDepth()+1 < tree.MaxDepth && cur->isTerminal() == false) {
-	  cur = cur->expand();
-	  //} 
-	RollingValue = rollOut(cur->state);
-      }
+  /// Number of threads used by the search
+  int getNThreads() const {
+    return 1 + contexts.size();
+  }
+
+  /// How to use the threads. The virtual loss is subtracted from the
+  /// value of a node for each simulation still in flight through it.
+  void setParallelMode(ParallelMode parallel_mode_, real virtual_loss_ = 1.0) {
+    parallel_mode = parallel_mode_;
+    virtual_loss = virtual_loss_;
+  }
+
+  /// Number of nodes currently in the tree
+  int getNNodes() const {
+    return n_nodes;
+  }
 
-      // Backpropagation phase
-      while(cur != NULL) {
-	cur->updateStats(RollingValue);
-	RollingValue = cur->getReward() + tree.gamma*RollingValue;
-	cur = cur->father;
-      }	
+  /// Number of root visits of action in the last search, over all
+  /// trees under ROOT_PARALLEL.
+  int getRootVisits(int action) const {
+    double value;
+    int visits;
+    RootStatistics(action, value, visits);
+    return visits;
+  }
+
+  /// Value of action at the root in the last search, averaged over
+  /// all trees by visits under ROOT_PARALLEL.
+  real getRootValue(int action) const {
+    double value;
+    int visits;
+    RootStatistics(action, value, visits);
+    return value;
+  }
+
+  int SelectAction(const S& state_) {
+    int sel_action;
+    if (contexts.empty()) {
+      Search(state_, NRollouts, MainContext());
+      sel_action = BestAction();
+    } else if (parallel_mode == ROOT_PARALLEL) {
+      sel_action = RootParallelSearch(state_);
+    } else {
+      sel_action = TreeParallelSearch(state_);
     }
+    environment->Reset();
+    environment->setState(state_);
 
-    //Tree expansion
-    Node* expand() {
-      std::vector<int> Unvisited; //Pointer to the childrens
-      int action;
-      // The unvisited children are declared
-      for(action = 0; action < tree.nActions; ++action) {
-	if(children[action] == NULL) {
-	  Unvisited.push_back(action);
-	}
-      }
-      //  printf("Action selection\n");
-      // We select one child (uniform) randomly among the unvisited children.
-      if(Unvisited.empty()) {
-	real bestValue = -1000000000;
-	for(int i = 0; i < tree.nActions; i++) {
-	  real curValue = (children[i]->getReward() + tree.gamma*children[i]->aveValue) + 1000*sqrt((sqrt(2)*log(nVisits)) / (children[i]->nVisits)); //UCT Search
-	  if(curValue > bestValue) {
-	    action = i;
-	    bestValue = curValue;
-	  }
-	}
-      } else {	
-	action = Unvisited[tree.rng->discrete_uniform(Unvisited.size())];
-      }
-      tree.environment->Reset();
-      tree.environment->setState(state);
-      bool running    = tree.environment->Act(action);
-      S child_state   = tree.environment->getState();
-      real reward     = tree.environment->getReward();
+    last_action = sel_action;
+    return sel_action;
+  };
+protected:
+  /// What a thread needs to run simulations.
+  struct Context {
+    ContinuousStateEnvironment* environment;
+    AbstractPolicy<S, A>* policy;
+    RandomNumberGenerator* rng;
+  };
+
+  std::vector<Node> nodes;    ///< node pool; the first n_nodes are in use
+  std::vector<int> children;  ///< nActions child indices per node, -1 if unexpanded
+  ParallelMode parallel_mode;
+  real virtual_loss;
+  int n_nodes;
+  int root;
+  int last_action;            ///< action returned by the last SelectAction()
+  std::vector<Node> spare_nodes; ///< scratch pool for KeepSubtree()
+  std::vector<int> spare_children;
+  std::vector<int> order;
+  std::vector<Context> contexts; ///< one per extra thread
+  std::vector<MonteCarloTreeSearch*> trees; ///< one per extra thread, for ROOT_PARALLEL
+  std::mutex tree_mutex;      ///< guards the tree under TREE_PARALLEL
+
+  Context MainContext() {
+    Context context = {environment, &policy, rng};
+    return context;
+  }
 
-      children[action] = new Node(depth + 1, child_state, reward, this, tree, !running); // The specific child is created
+  /// Number of rollouts done by thread t.
+  int RolloutShare(int t) const {
+    int n_threads = getNThreads();
+    return NRollouts / n_threads + ((t < NRollouts % n_threads) ? 1 : 0);
+  }
 
-      return children[action];
+  /// Seed the urandom() stream of a worker thread.
+  static void SeedThread(int t, Context& context) {
+    if (t > 0) {
+      MersenneTwister::manualSeed(context.rng->random());
     }
+  }
+
+  /// Set up the root for state_ and run n_rollouts simulations.
+  void Search(const S& state_, int n_rollouts, Context context) {
+    PrepareRoot(state_);
+    for(int i=0; i<n_rollouts; ++i) {
+      Simulate(context);
+    }
+  }
+
+  /// Find the best among the available actions
+  int BestAction() const {
+    const int* root_children = &children[root * nActions];
+    int sel_action = 0;
+    double bestValue = nodes[root_children[0]].reward + gamma*nodes[root_children[0]].aveValue;
     
-    //Tree policy
-    Node* UCTsearch() {
-      real bestValue = -1000000000000;
-      Node* selected = NULL;
-      for(int i = 0; i < tree.nActions; ++i) {
-	real curValue = (children[i]->getReward() + tree.gamma*children[i]->aveValue) + 1000*sqrt((log(nVisits)) / (children[i]->nVisits)); //UCT Search
-	if(curValue > bestValue) {
-	  selected = children[i];
-	  bestValue = curValue;
-	}
+    for(int action = 1; action < nActions; ++action) {
+      const Node& child = nodes[root_children[action]];
+      double curValue = child.reward + gamma*child.aveValue;
+      if(curValue > bestValue) {
+	sel_action = action;
+	bestValue = curValue;
       }
-      return selected;
     }
-    double rollOut(S state_) {
-      int t = 0;
-      int horizon = 1000; // tree.MaxDepth - depth;
-      tree.environment->Reset();
-      tree.environment->setState(state_);
-      tree.policy.Reset();
-      bool running = true;
-      real discount = 1.0;
-      real total_reward = 0.0;
-      real discounted_reward = 0.0;
-    
-      real reward = 0.0;
-      do {
-	//get current state
-	S state = tree.environment->getState();
-              
-	//choose an action using Random policy
-	tree.policy.Observe(reward, state);
-	A action = tree.policy.SelectAction();
+    return sel_action;
+  }
 
-	//execute the selected action
-	running = tree.environment->Act(action);
-              
-	// get reward
-	reward = tree.environment->getReward();
-              
-	total_reward += reward;
-	discounted_reward += discount * reward;
-              
-	discount *= tree.gamma;
+  /// Visit-weighted value and visits of a root action, merged over
+  /// the trees of all threads after a root-parallel search.
+  void RootStatistics(int action, double& value, int& visits) const {
+    int n_trees = (parallel_mode == ROOT_PARALLEL) ? getNThreads() : 1;
+    double total = 0;
+    visits = 0;
+    for (int t=0; t<n_trees; ++t) {
+      const MonteCarloTreeSearch* tree = (t == 0) ? this : trees[t - 1];
+      if (tree->root < 0) {
+	continue;
+      }
+      int c = tree->children[tree->root * nActions + action];
+      if (c >= 0 && tree->nodes[c].nVisits > 0) {
+	const Node& child = tree->nodes[c];
+	total += child.nVisits * (child.reward + gamma*child.aveValue);
+	visits += child.nVisits;
+      }
+    }
+    value = (visits > 0) ? total / visits : 0.0;
+  }
 
-	++t;              
-	if (t >= horizon) {
-	  running = false;
+  /// Grow one tree per thread and merge the root children, weighting
+  /// each tree's estimate by its number of visits.
+  int RootParallelSearch(const S& state_) {
+    int n_threads = getNThreads();
+    ParallelFor(n_threads, n_threads, [&](int begin, int end, int block) {
+	for (int t=begin; t<end; ++t) {
+	  if (t == 0) {
+	    Search(state_, RolloutShare(0), MainContext());
+	  } else {
+	    SeedThread(t, contexts[t - 1]);
+	    trees[t - 1]->Search(state_, RolloutShare(t), contexts[t - 1]);
+	  }
 	}
-      }while(running);
-      //printf("Gamma = %f, discounted_reward = %f\n",tree.gamma,discounted_reward);
-      return discounted_reward;
+      });
+    int sel_action = -1;
+    double bestValue = -std::numeric_limits<double>::infinity();
+    for (int action = 0; action < nActions; ++action) {
+      double value;
+      int visits;
+      RootStatistics(action, value, visits);
+      if (visits > 0 && (sel_action < 0 || value > bestValue)) {
+	sel_action = action;
+	bestValue = value;
+      }
     }
-    bool isTerminal() {
-      return terminal;
+    if (sel_action < 0) {
+      sel_action = 0;
     }
-    bool isRoot() {
-      if(father == NULL)
-	return true;
-      else 
-	return false;
+    for (unsigned int i=0; i<trees.size(); ++i) {
+      trees[i]->last_action = sel_action;
     }
-    bool isLeaf() {
-      for(int action = 0; action < tree.nActions; ++action) {
-	if(children[action] == NULL) {
-	  return true;
+    return sel_action;
+  }
+
+  /// Let all threads grow the same tree.
+  int TreeParallelSearch(const S& state_) {
+    PrepareRoot(state_);
+    int n_threads = getNThreads();
+    ParallelFor(n_threads, n_threads, [&](int begin, int end, int block) {
+	for (int t=begin; t<end; ++t) {
+	  Context context = (t == 0) ? MainContext() : contexts[t - 1];
+	  SeedThread(t, context);
+	  int n_rollouts = RolloutShare(t);
+	  for (int i=0; i<n_rollouts; ++i) {
+	    SimulateShared(context);
+	  }
 	}
+      });
+    return BestAction();
+  }
+
+  /// Make a node for state_ the root, reusing the last subtree if possible.
+  void PrepareRoot(const S& state_) {
+    int next_root = -1;
+    if (reuse_subtree && root >= 0 && last_action >= 0) {
+      next_root = children[root * nActions + last_action];
+      if (next_root >= 0 && !(nodes[next_root].state == state_)) {
+        next_root = -1;
       }
-      return false;
-    }    
-    int getDepth() {
-      return depth;
     }
-    double getReward() {
-      return reward;
+    if (next_root >= 0) {
+      KeepSubtree(next_root);
+    } else {
+      n_nodes = 0;
+      root = NewNode(0, state_, 0.0, -1, false);
     }
-    double getValue() {
-      return aveValue;
+  }
+
+  /// Take a node from the pool, growing it if needed.
+  int NewNode(int depth, const S& state, real reward, int father, bool terminal) {
+    if (n_nodes == (int) nodes.size()) {
+      nodes.resize(n_nodes + 1);
+      children.resize((n_nodes + 1) * nActions);
     }
-    void setFather(Node* father_){
-      father = father_;
+    int i = n_nodes++;
+    Node& node = nodes[i];
+    node.depth = depth;
+    node.state = state;
+    node.reward = reward;
+    node.father = father;
+    node.terminal = terminal;
+    node.nChildren = 0;
+    node.nVisits = 0;
+    node.nPending = 0;
+    node.aveValue = 0;
+    for (int a=0; a<nActions; ++a) {
+      children[i * nActions + a] = -1;
     }
-    void setState(S state_) {
-      state = state_;
+    return i;
+  }
+
+  /// Make node r the root and compact its subtree to the start of the pool.
+  void KeepSubtree(int r) {
+    int depth = nodes[r].depth;
+    spare_nodes.resize(std::max(spare_nodes.size(), nodes.size()));
+    spare_children.resize(spare_nodes.size() * nActions);
+    order.resize(nodes.size());
+    int n = 0;
+    order[n] = r;
+    spare_nodes[n] = nodes[r];
+    spare_nodes[n].father = -1;
+    ++n;
+    // Breadth-first, so the new indices of a node's children are
+    // allocated in the order the nodes are visited.
+    for (int k=0; k<n; ++k) {
+      int old = order[k];
+      spare_nodes[k].depth = nodes[old].depth - depth;
+      for (int a=0; a<nActions; ++a) {
+	int c = children[old * nActions + a];
+	if (c >= 0) {
+	  order[n] = c;
+	  spare_nodes[n] = nodes[c];
+	  spare_nodes[n].father = k;
+	  spare_children[k * nActions + a] = n;
+	  ++n;
+	} else {
+	  spare_children[k * nActions + a] = -1;
+	}
+      }
     }
-    void updateStats(double value) {
-      nVisits++;
-      aveValue += (value - aveValue)/ nVisits; // Mean value
+    std::swap(nodes, spare_nodes);
+    std::swap(children, spare_children);
+    n_nodes = n;
+    root = 0;
+  }
+
+  /// Run one simulation from the root.
+  void Simulate(Context& context) {
+    int cur = root;
+    double RollingValue = 0;
+
+    // Selection phase (we cross the tree according to the UCT)
+    while(!isLeaf(cur)) {
+      cur = UCTsearch(cur); //Tree policy
     }
-  };
 
-  //Constructor
-  MonteCarloTreeSearch(const real& gamma_, ContinuousStateEnvironment* environment_, RandomNumberGenerator* rng_, AbstractPolicy<S, A>& policy_, const int& MaxDepth_ =  100, const int& NRollouts_ = 1000)
-    :gamma(gamma_),
-     environment(environment_),
-     rng(rng_),
-     policy(policy_),
-     MaxDepth(MaxDepth_),
-     NRollouts(NRollouts_)
-  {
-    nActions = environment->getNActions(); 
-  };
+    if(nodes[cur].terminal) {
+      RollingValue = nodes[cur].reward;
+    } else {
+      // Expansion phase
+      cur = expand(cur, context);
+      RollingValue = rollOut(nodes[cur].state, context);
+    }
 
-  //Destructor
-  ~MonteCarloTreeSearch(){
-    delete root;
-  };
+    // Backpropagation phase
+    while(cur >= 0) {
+      Node& node = nodes[cur];
+      node.nVisits++;
+      node.aveValue += (RollingValue - node.aveValue)/ node.nVisits; // Mean value
+      RollingValue = node.reward + gamma*RollingValue;
+      cur = node.father;
+    }	
+  }
 
-  int SelectAction(S state_) {
- 
-    root = new Node(0, state_, 0.0, NULL, *this);
-  
-    for(int i=0; i<NRollouts; ++i) {
-      root->selectAction();
+  /// Run one simulation from the root of a tree shared between threads.
+  void SimulateShared(Context& context) {
+    int cur;
+    bool terminal;
+    double RollingValue = 0;
+    S state;
+    {
+      std::lock_guard<std::mutex> lock(tree_mutex);
+      cur = root;
+      nodes[cur].nPending++;
+      while(!isLeaf(cur)) {
+	cur = UCTsearch(cur);
+	nodes[cur].nPending++;
+      }
+      terminal = nodes[cur].terminal;
+      if (terminal) {
+	RollingValue = nodes[cur].reward;
+      } else {
+	cur = expand(cur, context);
+	nodes[cur].nPending++;
+	state = nodes[cur].state;
+      }
+    }
+    if (!terminal) {
+      RollingValue = rollOut(state, context);
     }
+    std::lock_guard<std::mutex> lock(tree_mutex);
+    while(cur >= 0) {
+      Node& node = nodes[cur];
+      node.nPending--;
+      node.nVisits++;
+      node.aveValue += (RollingValue - node.aveValue)/ node.nVisits; // Mean value
+      RollingValue = node.reward + gamma*RollingValue;
+      cur = node.father;
+    }
+  }
 
-    int sel_action = 0;
-    double bestValue = root->children[0]->reward + gamma*root->children[0]->aveValue;
+  bool isLeaf(int i) const {
+    return nodes[i].nChildren < nActions;
+  }
+
+  //Tree expansion
+  int expand(int i, Context& context) {
+    const int* node_children = &children[i * nActions];
+    int action;
+    int n_unvisited = nActions - nodes[i].nChildren;
+    // We select one child (uniform) randomly among the unvisited children.
+    if(n_unvisited == 0) {
+      real bestValue = -1000000000;
+      action = 0;
+      for(int a = 0; a < nActions; a++) {
+	const Node& child = nodes[node_children[a]];
+	real curValue = (child.reward + gamma*child.aveValue) + 1000*sqrt((sqrt(2)*log(nodes[i].nVisits)) / (child.nVisits)); //UCT Search
+	if(curValue > bestValue) {
+	  action = a;
+	  bestValue = curValue;
+	}
+      }
+    } else {	
+      int k = context.rng->discrete_uniform(n_unvisited);
+      for(action = 0; action < nActions; ++action) {
+	if(node_children[action] < 0 && k-- == 0) {
+	  break;
+	}
+      }
+    }
+    ContinuousStateEnvironment* env = context.environment;
+    env->Reset();
+    env->setState(nodes[i].state);
+    bool running    = env->Act(action);
+    real reward     = env->getReward();
+
+    // The specific child is created; this may move the pool.
+    int child = NewNode(nodes[i].depth + 1, env->getState(), reward, i, !running);
+    children[i * nActions + action] = child;
+    nodes[i].nChildren++;
+    return child;
+  }
     
-    //Find the best among the available actions
-    for(int action = 1; action < nActions; ++action) {
-      double curValue = root->children[action]->reward + gamma*root->children[action]->aveValue;
+  //Tree policy
+  int UCTsearch(int i) const {
+    const int* node_children = &children[i * nActions];
+    real log_visits = log(nodes[i].nVisits + nodes[i].nPending);
+    real bestValue = -1000000000000;
+    int selected = -1;
+    for(int a = 0; a < nActions; ++a) {
+      const Node& child = nodes[node_children[a]];
+      int visits = child.nVisits + child.nPending;
+      double aveValue = child.aveValue;
+      if (child.nPending > 0) {
+	aveValue -= virtual_loss * child.nPending / visits; // Virtual loss
+      }
+      real curValue = (child.reward + gamma*aveValue) + 1000*sqrt(log_visits / visits); //UCT Search
       if(curValue > bestValue) {
-	sel_action = action;
+	selected = node_children[a];
 	bestValue = curValue;
       }
     }
+    return selected;
+  }
+
+  double rollOut(const S& state_, Context& context) {
+    int t = 0;
+    int horizon = 1000; // MaxDepth - depth;
+    ContinuousStateEnvironment* environment = context.environment;
+    AbstractPolicy<S, A>& policy = *context.policy;
     environment->Reset();
     environment->setState(state_);
+    policy.Reset();
+    bool running = true;
+    real discount = 1.0;
+    real discounted_reward = 0.0;
+    
+    real reward = 0.0;
+    do {
+      //get current state
+      const S& state = environment->getState();
+              
+      //choose an action using Random policy
+      policy.Observe(reward, state);
+      A action = policy.SelectAction();
 
-    delete root;
+      //execute the selected action
+      running = environment->Act(action);
+              
+      // get reward
+      reward = environment->getReward();
+              
+      discounted_reward += discount * reward;
+              
+      discount *= gamma;
 
-    return sel_action;
-  };
-protected:
-  std::vector< std::vector<Node*> > levels;
-  Node* root;
+      ++t;              
+      if (t >= horizon) {
+	running = false;
+      }
+    }while(running);
+    return discounted_reward;
+  }
 };
 #endif
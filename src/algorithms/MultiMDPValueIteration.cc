@@ -16,6 +16,7 @@
 #include "Vector.h"
 #include <cmath>
 #include <cassert>
+#include <algorithm>
 
 /// Setup a value iteration procedure for a list of MDPs with weights w and discount factor gamma
 MultiMDPValueIteration::MultiMDPValueIteration(const Vector& w_,
@@ -130,6 +131,60 @@ real MultiMDPValueIteration::ComputeActionValueForMDPs(int s, int a)
     return Q_sa;
 }
 
+/// Pack the transitions and rewards of all MDPs for ComputeStateValues()
+void MultiMDPValueIteration::PackMDPs()
+{
+    int N = n_states * n_actions;
+    row_start.resize(N + 1);
+    edge_state.clear();
+    batch_R.resize(N * n_mdps);
+    std::vector<int> slot(n_states, -1);
+    for (int s=0; s<n_states; ++s) {
+        for (int a=0; a<n_actions; ++a) {
+            int ID = s * n_actions + a;
+            row_start[ID] = edge_state.size();
+            for (int mu=0; mu<n_mdps; ++mu) {
+                const DiscreteStateSet& next = mdp_list[mu]->getNextStates(s, a);
+                for (DiscreteStateSet::const_iterator i=next.begin(); i!=next.end(); ++i) {
+                    if (slot[*i] < 0) {
+                        slot[*i] = edge_state.size();
+                        edge_state.push_back(*i);
+                    }
+                }
+                batch_R[ID * n_mdps + mu] = mdp_list[mu]->getExpectedReward(s, a);
+            }
+            int begin = row_start[ID];
+            int end = edge_state.size();
+            std::sort(edge_state.begin() + begin, edge_state.end());
+            for (int e=begin; e<end; ++e) {
+                slot[edge_state[e]] = -1;
+            }
+        }
+    }
+    row_start[N] = edge_state.size();
+
+    edge_probability.resize(edge_state.size() * n_mdps);
+    for (int s=0; s<n_states; ++s) {
+        for (int a=0; a<n_actions; ++a) {
+            int ID = s * n_actions + a;
+            for (int e=row_start[ID]; e<row_start[ID + 1]; ++e) {
+                real* P = &edge_probability[e * n_mdps];
+                for (int mu=0; mu<n_mdps; ++mu) {
+                    P[mu] = mdp_list[mu]->getTransitionProbability(s, a, edge_state[e]);
+                }
+            }
+        }
+    }
+
+    batch_V.resize(n_states * n_mdps);
+    for (int s=0; s<n_states; ++s) {
+        for (int mu=0; mu<n_mdps; ++mu) {
+            batch_V[s * n_mdps + mu] = V[mu](s);
+        }
+    }
+    batch_Q.resize(N * n_mdps);
+}
+
 /*** Compute the current value.
 
      This is an alternative implementation with no helper function calls.
@@ -143,44 +198,94 @@ real MultiMDPValueIteration::ComputeActionValueForMDPs(int s, int a)
      \f]
  */
 void MultiMDPValueIteration::ComputeStateValues(real threshold, int max_iter)
+{
+    Iterate(threshold, max_iter, false);
+}
+
+/** Compute the optimal values of each MDP on its own.
+
+    This uses the same packed sweep as ComputeStateValues(), but every
+    MDP takes its own best action in every state, so that V[mu] and
+    Q[mu] converge to the optimal values of MDP mu, as if a separate
+    ValueIteration had been run on each. V_xi and Q_xi are the
+    w-weighted averages of the individual values, which is the upper
+    bound of SampleBasedRL. Delta is the largest, over the MDPs, of the
+    sum over states of the changes in the values of each MDP, so that
+    every MDP meets the threshold a separate ValueIteration would.
+ */
+void MultiMDPValueIteration::ComputeSeparateStateValues(real threshold, int max_iter)
+{
+    Iterate(threshold, max_iter, true);
+}
+
+/// Run the packed sweeps, with a shared policy unless separate is set.
+void MultiMDPValueIteration::Iterate(real threshold, int max_iter, bool separate)
 {
     pV_xi = V_xi;
     int n_iter = 0;
 
+    PackMDPs();
+    std::vector<real> Q_msa(n_mdps);
+    std::vector<real> Delta_mu(n_mdps);
+
     //logmsg ("Runnign ComputeStateValues with epsilon: %f, iter: %d, gamma: %f", threshold, max_iter, gamma);
     do {
-        // Calculate Q_{mu,t}(s,a) from V_mu(s)
-        for (int mu=0; mu<n_mdps; ++mu) {
-            const DiscreteMDP* mdp = mdp_list[mu];
-            for (int s=0; s<n_states; ++s) {
-                for (int a=0; a<n_actions; ++a) {
-                    real R_sa = mdp->getExpectedReward(s, a);
-                    real Q_msa = 0.0;
-                    for (int s2=0; s2<n_states; ++s2) {
-                        real P = mdp->getTransitionProbability(s, a, s2);
-                        real V2 = V[mu](s2);
-                        Q_msa += P * V2;
+        // Calculate Q_{mu,t}(s,a) from V_mu(s) for all mu at once,
+        // and Q_{xi, t}(s,a) from them.
+        for (int s=0; s<n_states; ++s) {
+            for (int a=0; a<n_actions; ++a) {
+                int ID = s * n_actions + a;
+                for (int mu=0; mu<n_mdps; ++mu) {
+                    Q_msa[mu] = 0.0;
+                }
+                for (int e=row_start[ID]; e<row_start[ID + 1]; ++e) {
+                    const real* P = &edge_probability[e * n_mdps];
+                    const real* V2 = &batch_V[edge_state[e] * n_mdps];
+                    for (int mu=0; mu<n_mdps; ++mu) {
+                        Q_msa[mu] += P[mu] * V2[mu];
                     }
-                    Q[mu](s, a) = R_sa + gamma * Q_msa;
-                    //printf ("Q_%d(%d, %d) = %f = %f + %f * %f\n",
-                    //mu, s, a, Q[mu](s,a),
-                    //R_sa, gamma, Q_msa);
                 }
+                const real* R_sa = &batch_R[ID * n_mdps];
+                real* Q_sa = &batch_Q[ID * n_mdps];
+                real Q_xi_sa = 0.0;
+                for (int mu=0; mu<n_mdps; ++mu) {
+                    Q_sa[mu] = R_sa[mu] + gamma * Q_msa[mu];
+                    Q_xi_sa += w(mu) * Q_sa[mu];
+                }
+                Q_xi(s,a) = Q_xi_sa;
+                //printf ("Q_xi(%d, %d) = %f\n", s, a, Q_xi(s,a));
             }
-            
         }
+        
 
-        // calculate Q_{xi, t}(s,a)
-        for (int s=0; s<n_states; ++s) {
-            for (int a=0; a<n_actions; ++a) {
-                Q_xi(s,a) = 0.0;
+        if (separate) {
+            // Calculate V_{mu, t}(s) = max_a Q_{mu, t}(s,a) for each mu
+            for (int mu=0; mu<n_mdps; ++mu) {
+                Delta_mu[mu] = 0.0;
+            }
+            for (int s=0; s<n_states; ++s) {
+                const real* Q_s = &batch_Q[s * n_actions * n_mdps];
+                real* V_s = &batch_V[s * n_mdps];
+                real V_xi_s = 0.0;
                 for (int mu=0; mu<n_mdps; ++mu) {
-                    Q_xi(s,a) += w(mu) * Q[mu](s,a);
+                    real V_max = Q_s[mu];
+                    for (int a=1; a<n_actions; ++a) {
+                        V_max = std::max(V_max, Q_s[a * n_mdps + mu]);
+                    }
+                    Delta_mu[mu] += fabs(V_max - V_s[mu]);
+                    V_s[mu] = V_max;
+                    V_xi_s += w(mu) * V_max;
                 }
-                //printf ("Q_xi(%d, %d) = %f\n", s, a, Q_xi(s,a));
+                V_xi(s) = V_xi_s;
             }
+            Delta = *std::max_element(Delta_mu.begin(), Delta_mu.end());
+            if (max_iter > 0) {
+                max_iter--;
+            }
+            pV_xi = V_xi;
+            n_iter++;
+            continue;
         }
-        
 
         // Calculate a_t^*(s), V_{xi, t}(s)
         std::vector<int> a_max(n_states);         
@@ -198,9 +303,11 @@ void MultiMDPValueIteration::ComputeStateValues(real threshold, int max_iter)
         }
 
         // Calculate V_{mu, t}(s)
-        for (int mu=0; mu<n_mdps; ++mu) {
-            for (int s=0; s<n_states; ++s) {
-                V[mu](s) = Q[mu](s, a_max[s]);
+        for (int s=0; s<n_states; ++s) {
+            const real* Q_sa = &batch_Q[(s * n_actions + a_max[s]) * n_mdps];
+            real* V_s = &batch_V[s * n_mdps];
+            for (int mu=0; mu<n_mdps; ++mu) {
+                V_s[mu] = Q_sa[mu];
             }
         }
 
@@ -217,6 +324,16 @@ void MultiMDPValueIteration::ComputeStateValues(real threshold, int max_iter)
         n_iter++;
     } while(Delta >= threshold && max_iter != 0);
     //logmsg("Exiting at delta :%f, iter :%d\n", Delta, n_iter);		
+
+    // Unpack the individual value functions
+    for (int mu=0; mu<n_mdps; ++mu) {
+        for (int s=0; s<n_states; ++s) {
+            V[mu](s) = batch_V[s * n_mdps + mu];
+            for (int a=0; a<n_actions; ++a) {
+                Q[mu](s, a) = batch_Q[(s * n_actions + a) * n_mdps + mu];
+            }
+        }
+    }
 }
 
 
@@ -28,6 +28,12 @@
     The main assumption in this algorithm is that the policy is
     reactive and oblivious. In that case, we can use a fixed
     probability measure.
+
+    At the start of ComputeStateValues() the MDPs are packed together
+    in structure-of-arrays form: the union of their next-state sets is
+    stored once per state-action pair, with the n_mdps probabilities
+    of each edge next to each other. A sweep then updates the values
+    of all MDPs at once with contiguous inner loops over the MDPs.
  */
 class MultiMDPValueIteration
 {
@@ -55,6 +61,7 @@ public:
     void Reset();
 
     void ComputeStateValues(real threshold, int max_iter=-1);
+    void ComputeSeparateStateValues(real threshold, int max_iter=-1);
     void ComputeStateActionValues(real threshold, int max_iter=-1);
     inline real getValue (int state, int action)
     {
@@ -90,6 +97,14 @@ public:
         assert(w.Size() == n_mdps);
     }
 protected:
+    std::vector<int> row_start; ///< first edge of each state-action pair
+    std::vector<int> edge_state; ///< next state of each edge
+    std::vector<real> edge_probability; ///< n_mdps probabilities per edge
+    std::vector<real> batch_R; ///< n_mdps expected rewards per state-action pair
+    std::vector<real> batch_V; ///< n_mdps values per state
+    std::vector<real> batch_Q; ///< n_mdps values per state-action pair
+    void PackMDPs();
+    void Iterate(real threshold, int max_iter, bool separate);
     real ComputeActionValueForMDPs(int s, int a);
     real ComputeStateActionValueForSingleMDP(int mu, int s, int a);
 
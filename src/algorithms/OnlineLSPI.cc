@@ -18,10 +18,11 @@ n_dimension(n_dimension_),
 n_actions(n_actions_), 
 max_iteration(max_iteration_),
 bfs(bfs_), 
-policy(n_dimension, n_actions, bfs)
+policy(n_dimension, n_actions, bfs),
+features(n_actions, bfs->size())
 {
 	assert(gamma>=0 && gamma <=1);
-	n_basis = n_actions*(bfs->size() + 1);
+	n_basis = features.Size();
 	algorithm = 1;
 	A.Resize(n_basis, n_basis);
 	A = Matrix::Unity(n_basis,n_basis) * 1e-6;
@@ -37,11 +38,12 @@ n_actions(n_actions_),
 max_iteration(max_iteration_),
 algorithm(algorithm_),
 bfs(bfs_), 
-policy(n_dimension, n_actions, bfs)
+policy(n_dimension, n_actions, bfs),
+features(n_actions, bfs->size())
 {
 	assert(gamma>=0 && gamma <=1);
 	assert(algorithm>=1 && algorithm<=2);
-	n_basis = n_actions*(bfs->size() + 1);
+	n_basis = features.Size();
 	A.Resize(n_basis, n_basis);
 	A = Matrix::Unity(n_basis,n_basis) * 1e-6;
 	b.Resize(n_basis);
@@ -55,15 +57,7 @@ OnlineLSPI::~OnlineLSPI()
 Vector OnlineLSPI::BasisFunction(const Vector& state, int action)
 {
 	bfs->Evaluate(state);
-	Vector Phi_state = bfs->F();
-	Vector Phi(n_basis);
-	Phi[(bfs->size() + 1)*action] = 1.0;
-	
-	for(int i = 0; i<bfs->size(); ++i)
-	{
-		Phi[(bfs->size() + 1)*action + i + 1] = Phi_state[i];
-	}
-	return Phi;
+	return features.Features(bfs->F(), action);
 }
 void OnlineLSPI::LSTD(const Vector& state, const int& action, const real& reward, const Vector& state_, const int& action_, const bool& endsim, const bool& update) 
 { 
@@ -74,51 +68,36 @@ void OnlineLSPI::LSTD(const Vector& state, const int& action, const real& reward
 }
 void OnlineLSPI::LSTDQ(const Vector& state, const int& action, const real& reward, const Vector& state_, const int& action_, const bool& endsim, const bool& update) 
 {
-	Vector Phi_;
-	Vector Phi;
-	Matrix res;
-	
-	Phi_ = BasisFunction(state, action);
+	bfs->Evaluate(state);
+	Vector f = bfs->F();
 	if(endsim) {
-		res = OuterProduct(Phi_, Phi_);
+		features.AddSample(A, b, f, action, reward);
 	}
 	else {
-		Phi = BasisFunction(state_,action_);
-		res = OuterProduct(Phi_,(Phi_ - (Phi*gamma)));
+		bfs->Evaluate(state_);
+		features.AddSample(A, b, f, action, reward, bfs->F(), action_, gamma);
 	}
-	
-	A += res;
-	b += Phi_*reward;
 }
 void OnlineLSPI::LSTDQ_OPT(const Vector& state, const int& action, const real& reward, const Vector& state_, const int& action_, const bool& endsim, const bool& update)
 {
-	Vector Phi_;
-	Vector Phi;
-	Vector Phi_dif;
-	Matrix res;
 	real d = 0.000001;
 	A = Matrix::Unity(n_basis,n_basis) * (1/d);
 	b.Clear();
 	
-	Phi_ = BasisFunction(state, action);
+	bfs->Evaluate(state);
+	Vector f = bfs->F();
 	if(endsim){
-		Phi_dif = Phi_;
+		features.AddSampleInverse(A, b, f, action, reward);
 	}
 	else{
-		Phi = BasisFunction(state_, action_);
-		Phi_dif = Phi_ - (Phi*gamma);
+		bfs->Evaluate(state_);
+		features.AddSampleInverse(A, b, f, action, reward, bfs->F(), action_, gamma);
 	}
-	res = OuterProduct(Phi_,Phi_dif);
-	const Matrix p = A;
-	real v = Product(p*Phi_,Phi_dif);
-	A -= (((A*res)*A) / (v + 1));
-	b += Phi_ * reward;
 }
 void OnlineLSPI::Update()
 {
 	if(algorithm == 1) {
-		const Matrix w_ = A.Inverse_LU();
-		w = w_*b;
+		w = A.LU_Solve(b);
 	}
 	else if( algorithm == 2) {
 		const Matrix w_ = A;
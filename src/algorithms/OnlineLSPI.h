@@ -18,6 +18,7 @@
 #include "Vector.h"
 #include "Matrix.h"
 #include "BasisSet.h"
+#include "StateActionFeatures.h"
 #include "ContinuousPolicy.h"
 #include "RandomPolicy.h"
 #include <vector>
@@ -36,6 +37,7 @@ protected:
 	Vector w;
 	RBFBasisSet* bfs;
 	FixedContinuousPolicy policy;
+	StateActionFeatures features;
 public:	
 	OnlineLSPI(real gamma_, real Delta_, int n_dimension_, int n_actions_, int max_iteration_, RBFBasisSet* bfs_);
 	OnlineLSPI(real gamma_, real Delta_, int n_dimension_, int n_actions_, int max_iteration_, int algorithm_, RBFBasisSet* bfs_);
@@ -31,6 +31,10 @@ OptimisticValueIteration::OptimisticValueIteration(const DiscreteMDPCounts* mdp,
     this->baseline = baseline;
     n_actions = mdp->getNActions();
     n_states = mdp->getNStates();
+    augmented_mdp = NULL;
+    augmented_vi = NULL;
+    augmented_delta = -1;
+    augmented_reward_delta = -1;
     Reset();
 }
 
@@ -44,6 +48,43 @@ void OptimisticValueIteration::Reset()
 
 OptimisticValueIteration::~OptimisticValueIteration()
 {
+    delete augmented_vi;
+    delete augmented_mdp;
+}
+
+/// Set the n_states optimistic actions of (s, a) in the augmented MDP.
+void OptimisticValueIteration::SetAugmentedStateAction(int s, int a, real delta, real reward_delta)
+{
+    int N_sa = (int) ceil(mdp->getNVisits(s, a));
+    real r_sa = mdp->getExpectedReward(s,a);
+    real r_gap = HoeffdingBound(1, N_sa, reward_delta);
+    Vector P_sa = mdp->getTransitionProbabilities(s, a);
+    real gap = WeissmanBound(n_states, N_sa, delta);
+    int a_aug = a * n_states;
+    for (int k=0; k<n_states; k++) {
+        augmented_mdp->setTransitionProbabilities(s, a_aug, MultinomialDeviation(P_sa, k, gap));
+        augmented_mdp->setFixedReward(s, a_aug, r_sa + r_gap);
+        a_aug++;
+    }
+}
+
+/// Take Q and V from the best augmented action for each action.
+void OptimisticValueIteration::CopyAugmentedValues()
+{
+    for (int s=0; s<n_states; s++) {
+        int a_aug = 0;
+        V(s) = -INF;
+        for (int a=0; a<n_actions; a++) {
+            real Qaug_max = augmented_vi->getValue(s, a_aug);
+            for (int k=0; k<n_states; ++k, a_aug++) {
+                //printf("%d %f\n", k, augmented_vi->getValue(s, a_aug));
+                Qaug_max = std::max(Qaug_max, augmented_vi->getValue(s, a_aug));
+            }
+            Q(s,a) = Qaug_max;
+            V(s) = std::max(V(s), Q(s,a));
+            //printf("Q(%d, %d) = %f\n", s, a, Q(s,a));
+        }
+    }            
 }
 
 /** Compute state values using value iteration in an augmented MDP.
@@ -65,42 +106,66 @@ void OptimisticValueIteration::ComputeStateValuesAugmentedMDP(real delta,
                                                               real threshold,
                                                               int max_iter)
 {
-    int n_aug = n_actions * n_states;
-    DiscreteMDP augmented_mdp(n_states, n_aug);
+    if (!augmented_mdp) {
+        augmented_mdp = new DiscreteMDP(n_states, n_actions * n_states);
+        augmented_vi = new ValueIteration(augmented_mdp, gamma);
+    }
     for (int s=0; s<n_states; s++) {
-        int a_aug = 0;
         for (int a=0; a<n_actions; a++) {
-            int N_sa = (int) ceil(mdp->getNVisits(s, a));
-            real r_sa = mdp->getExpectedReward(s,a);
-            real r_gap = HoeffdingBound(1, N_sa, reward_delta);
-            Vector P_sa = mdp->getTransitionProbabilities(s, a);
-            real gap = WeissmanBound(n_states, N_sa, delta);
-            for (int k=0; k<n_states; k++) {
-                augmented_mdp.setTransitionProbabilities(s, a_aug, MultinomialDeviation(P_sa, k, gap));
-                augmented_mdp.setFixedReward(s, a_aug, r_sa + r_gap);
-                a_aug++;
-            }
+            SetAugmentedStateAction(s, a, delta, reward_delta);
         }
     }
+    augmented_delta = delta;
+    augmented_reward_delta = reward_delta;
 
-    augmented_mdp.Check();
+    augmented_mdp->Check();
+    if (!augmented_mdp->isFrozen()) {
+        augmented_mdp->Freeze();
+    }
 
-    ValueIteration vi(&augmented_mdp, gamma);
-    vi.ComputeStateValues(threshold, max_iter);
-    for (int s=0; s<n_states; s++) {
-        int a_aug = 0;
-        V(s) = -INF;
-        for (int a=0; a<n_actions; a++) {
-            real Qaug_max = vi.getValue(s, a_aug);
-            for (int k=0; k<n_states; ++k, a_aug++) {
-                //printf("%d %f\n", k, vi.getValue(s, a_aug));
-                Qaug_max = std::max(Qaug_max, vi.getValue(s, a_aug));
-            }
-            Q(s,a) = Qaug_max;
-            V(s) = std::max(V(s), Q(s,a));
-            //printf("Q(%d, %d) = %f\n", s, a, Q(s,a));
+    augmented_vi->Reset();
+    augmented_vi->ComputeStateValues(threshold, max_iter);
+    CopyAugmentedValues();
+}
+
+/** Replan in the augmented MDP after some state-actions changed.
+
+    Only the augmented actions of the changed state-actions are
+    rebuilt, and prioritised sweeping starts from the previous
+    values. The augmented MDP stays frozen: setting the transitions
+    of an augmented action only re-packs its own CSR row. If the augmented MDP has not been built yet, or the
+    bounds have changed, this falls back to
+    ComputeStateValuesAugmentedMDP().
+
+    \param changed the state-actions modified in the model, e.g. from DiscreteMDPCounts::getDirtyStateActions().
+    \param delta the error probability for the confidence bound.
+    \param reward_delta the error probability for the reward bound.
+    \param threshold stop when no state has a residual above threshold.
+    \param max_backups stop after at most max_backups backups, unless max_backups < 0.
+*/
+void OptimisticValueIteration::UpdateStateValuesAugmentedMDP(const std::vector<DiscreteStateAction>& changed,
+                                                             real delta,
+                                                             real reward_delta,
+                                                             real threshold,
+                                                             int max_backups)
+{
+    if (!augmented_mdp
+        || delta != augmented_delta
+        || reward_delta != augmented_reward_delta) {
+        ComputeStateValuesAugmentedMDP(delta, reward_delta, threshold, max_backups);
+        return;
+    }
+    std::vector<DiscreteStateAction> augmented_changed;
+    for (unsigned int i=0; i<changed.size(); ++i) {
+        int s = changed[i].state;
+        int a = changed[i].action;
+        SetAugmentedStateAction(s, a, delta, reward_delta);
+        for (int k=0; k<n_states; k++) {
+            augmented_changed.push_back(DiscreteStateAction(s, a * n_states + k));
         }
-    }            
+    }
+    augmented_vi->ComputeStateValuesIncremental(augmented_changed, threshold, max_backups);
+    CopyAugmentedValues();
 }
 
 
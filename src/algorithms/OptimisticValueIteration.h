@@ -18,13 +18,26 @@
 #include "real.h"
 #include <vector>
 
+class ValueIteration;
 
 /** Optimistic value iteration.
 
     Perform value iteration on an augmented MDP.
+
+    The augmented MDP and its value iteration are kept between calls,
+    so that UpdateStateValues() can rebuild only the rows of the
+    state-actions that changed in the model and replan from the
+    previous values.
 */
 class OptimisticValueIteration
 {
+protected:
+    DiscreteMDP* augmented_mdp; ///< the optimistic MDP, with n_states augmented actions per action
+    ValueIteration* augmented_vi; ///< value iteration on augmented_mdp
+    real augmented_delta; ///< delta used for augmented_mdp
+    real augmented_reward_delta; ///< reward_delta used for augmented_mdp
+    void SetAugmentedStateAction(int s, int a, real delta, real reward_delta);
+    void CopyAugmentedValues();
 public:
     const DiscreteMDPCounts* mdp;
     real gamma;
@@ -65,6 +78,35 @@ public:
                                        threshold,
                                        max_iter);
     }
+    void UpdateStateValuesAugmentedMDP(const std::vector<DiscreteStateAction>& changed,
+                                       real delta,
+                                       real reward_delta,
+                                       real threshold,
+                                       int max_backups=-1);
+    /// Replan for unknown rewards and transitions after the given state-actions changed.
+    inline void UpdateStateValues(const std::vector<DiscreteStateAction>& changed,
+                                  real delta,
+                                  real threshold,
+                                  int max_backups=-1)
+    {
+        UpdateStateValuesAugmentedMDP(changed,
+                                      delta,
+                                      delta,
+                                      threshold,
+                                      max_backups);
+    }
+    /// Replan with known rewards after the given state-actions changed.
+    inline void UpdateStateValuesKnownRewards(const std::vector<DiscreteStateAction>& changed,
+                                              real delta,
+                                              real threshold,
+                                              int max_backups=-1)
+    {
+        UpdateStateValuesAugmentedMDP(changed,
+                                      delta,
+                                      1.0,
+                                      threshold,
+                                      max_backups);
+    }
     inline real getValue (int state, int action)
     {
         return Q(state, action);
@@ -73,11 +115,11 @@ public:
     {
         return V(state);
     }
-    inline Matrix getValues()
+    inline const Matrix& getValues() const
     {
         return Q;
     }
-    inline Vector getStateValues()
+    inline const Vector& getStateValues() const
     {
         return V;
     }
@@ -73,7 +73,7 @@ public:
     {
         return Q(s, a);
     }
-    Matrix getQMatrix()
+    const Matrix& getQMatrix() const
     {
         return Q;
     }
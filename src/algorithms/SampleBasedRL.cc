@@ -49,18 +49,17 @@ SampleBasedRL::SampleBasedRL(int n_states_,
 
     real w_i = 1.0 / (real) max_samples;
     mdp_list.resize(max_samples);
-    value_iteration.resize(max_samples);
     printf("# Generating mean MDP\n");
     //mdp_list[0] = model->getMeanMDP();
     for (int i=0; i<max_samples; ++i) {
         printf("# Generating sampled MDP\n");
         mdp_list[i] = model->generate();
         weights[i] = w_i;
-        value_iteration[i] = new ValueIteration(mdp_list[i], gamma);
     }
 
     printf ("# Setting up MultiMPDValueIteration\n");
     multi_value_iteration = new MultiMDPValueIteration(weights, mdp_list, gamma);
+    separate_value_iteration = new MultiMDPValueIteration(weights, mdp_list, gamma);
     printf ("# Testing MultiMPDValueIteration\n");
     multi_value_iteration->ComputeStateActionValues(0,1);
 }
@@ -93,9 +92,9 @@ SampleBasedRL::~SampleBasedRL()
 #endif
     for (int i=0; i<max_samples; ++i) {
         delete mdp_list[i];
-        delete value_iteration[i];
     }
     delete multi_value_iteration;
+    delete separate_value_iteration;
 }
 void SampleBasedRL::Reset()
 {
@@ -146,21 +145,14 @@ void SampleBasedRL::Resample()
 
 void SampleBasedRL::CalculateUpperBound(real accuracy, int iterations)
 {
-    for (int j=0; j<max_samples; ++j) {
-        value_iteration[j]->setMDP(mdp_list[j]);
-        value_iteration[j]->ComputeStateValuesStandard(accuracy, iterations);
-    }
-    
-    real Z = 1.0 / (real) max_samples;
+    // QU is the average of the optimal Q-values of the samples
+    separate_value_iteration->setMDPList(mdp_list);
+    separate_value_iteration->ComputeSeparateStateValues(accuracy, iterations);
     for (int s=0; s<n_states; ++s) {
         for (int a=0; a<n_actions; ++a) {
-            QU(s,a) = 0;
-            for (int i=0; i<max_samples; i++) {
-                QU(s, a) += value_iteration[i]->getValue(s, a);
-            }
+            QU(s, a) = separate_value_iteration->getValue(s, a);
         }
     }
-    QU *= Z;
     for (int s=0; s<n_states; ++s) {
 #if 1
         VU(s) = QU(s, 0);
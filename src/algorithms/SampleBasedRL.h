@@ -47,8 +47,8 @@ protected:
     int current_state; ///< current state
     int current_action; ///< current action
     MDPModel* model; ///< pointer to the base MDP model
-    std::vector<ValueIteration*> value_iteration; ///< value iteration on each separate model
     MultiMDPValueIteration* multi_value_iteration; ///< multi-MDP value iteration
+    MultiMDPValueIteration* separate_value_iteration; ///< value iteration on each separate model
     std::vector<real> tmpQ;
     Vector VU; ///< upper bound value
     Vector VL; ///< lower bound value
@@ -0,0 +1,156 @@
+/* -*- Mode: C++; -*- */
+/***************************************************************************
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ ***************************************************************************/
+
+#include "StateActionFeatures.h"
+
+StateActionFeatures::StateActionFeatures(int n_actions_, int n_features)
+    : n_actions(n_actions_),
+      block_size(n_features + 1),
+      u(n_features + 1),
+      v(n_features + 1)
+{
+    assert(n_actions > 0);
+}
+
+/// Set y to \f$[1, f]\f$
+void StateActionFeatures::setBlock(Vector& y, const Vector& f) const
+{
+    assert(f.Size() + 1 == block_size);
+    y.x[0] = 1.0;
+    for (int k=0; k<f.Size(); ++k) {
+        y.x[k + 1] = f.x[k];
+    }
+}
+
+/// The full feature vector \f$\phi(s,a)\f$ given f = f(s)
+Vector StateActionFeatures::Features(const Vector& f, int a) const
+{
+    assert(a >= 0 && a < n_actions);
+    Vector phi(Size());
+    int r = a * block_size;
+    phi[r] = 1.0;
+    for (int k=0; k<f.Size(); ++k) {
+        phi[r + k + 1] = f[k];
+    }
+    return phi;
+}
+
+/// Add a terminal sample, for which \f$\phi' = 0\f$.
+void StateActionFeatures::AddSample(Matrix& A, Vector& b, const Vector& f, int a, real reward)
+{
+    assert(a >= 0 && a < n_actions);
+    setBlock(u, f);
+    int r = a * block_size;
+    A.AddOuterProduct(1.0, u, u, r, r);
+    for (int k=0; k<block_size; ++k) {
+        b[r + k] += u[k] * reward;
+    }
+}
+
+/// Add a sample \f$(s, a, r, s', a')\f$, given f = f(s) and f_next = f(s').
+void StateActionFeatures::AddSample(Matrix& A, Vector& b, const Vector& f, int a, real reward,
+                                    const Vector& f_next, int a_next, real gamma)
+{
+    assert(a >= 0 && a < n_actions);
+    assert(a_next >= 0 && a_next < n_actions);
+    setBlock(u, f);
+    setBlock(v, f_next);
+    int r = a * block_size;
+    if (a_next == a) {
+        for (int k=0; k<block_size; ++k) {
+            v[k] = u[k] - v[k] * gamma;
+        }
+        A.AddOuterProduct(1.0, u, v, r, r);
+    } else {
+        for (int k=0; k<block_size; ++k) {
+            v[k] = - (v[k] * gamma);
+        }
+        A.AddOuterProduct(1.0, u, u, r, r);
+        A.AddOuterProduct(1.0, u, v, r, a_next * block_size);
+    }
+    for (int k=0; k<block_size; ++k) {
+        b[r + k] += u[k] * reward;
+    }
+}
+
+/** Sherman-Morrison update \f$B \leftarrow B - B p q' B / (1 + q' B p)\f$.
+
+    Here p is zero except for the block at r, and q is zero except for
+    the blocks at r and (if q_next is not NULL) r_next.
+ */
+void StateActionFeatures::ShermanMorrison(Matrix& B, int r, const Vector& p,
+                                          const Vector& q, int r_next, const Vector* q_next) const
+{
+    int n = B.Rows();
+    Vector Bp(n);
+    for (int i=0; i<n; ++i) {
+        real sum = 0;
+        for (int k=0; k<block_size; ++k) {
+            sum += B(i, r + k) * p[k];
+        }
+        Bp[i] = sum;
+    }
+    Vector qB(n);
+    real qBp = 0;
+    for (int k=0; k<block_size; ++k) {
+        real q_k = q[k];
+        for (int j=0; j<n; ++j) {
+            qB[j] += q_k * B(r + k, j);
+        }
+        qBp += q_k * Bp[r + k];
+    }
+    if (q_next) {
+        for (int k=0; k<block_size; ++k) {
+            real q_k = (*q_next)[k];
+            for (int j=0; j<n; ++j) {
+                qB[j] += q_k * B(r_next + k, j);
+            }
+            qBp += q_k * Bp[r_next + k];
+        }
+    }
+    B.AddOuterProduct(-1.0 / (1.0 + qBp), Bp, qB);
+}
+
+/// Add a terminal sample to \f$B = A^{-1}\f$.
+void StateActionFeatures::AddSampleInverse(Matrix& B, Vector& b, const Vector& f, int a, real reward)
+{
+    assert(a >= 0 && a < n_actions);
+    setBlock(u, f);
+    int r = a * block_size;
+    ShermanMorrison(B, r, u, u, 0, NULL);
+    for (int k=0; k<block_size; ++k) {
+        b[r + k] += u[k] * reward;
+    }
+}
+
+/// Add a sample \f$(s, a, r, s', a')\f$ to \f$B = A^{-1}\f$.
+void StateActionFeatures::AddSampleInverse(Matrix& B, Vector& b, const Vector& f, int a, real reward,
+                                           const Vector& f_next, int a_next, real gamma)
+{
+    assert(a >= 0 && a < n_actions);
+    assert(a_next >= 0 && a_next < n_actions);
+    setBlock(u, f);
+    setBlock(v, f_next);
+    int r = a * block_size;
+    if (a_next == a) {
+        for (int k=0; k<block_size; ++k) {
+            v[k] = u[k] - v[k] * gamma;
+        }
+        ShermanMorrison(B, r, u, v, 0, NULL);
+    } else {
+        for (int k=0; k<block_size; ++k) {
+            v[k] = - (v[k] * gamma);
+        }
+        ShermanMorrison(B, r, u, u, a_next * block_size, &v);
+    }
+    for (int k=0; k<block_size; ++k) {
+        b[r + k] += u[k] * reward;
+    }
+}
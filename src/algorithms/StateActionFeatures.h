@@ -0,0 +1,64 @@
+/* -*- Mode: C++; -*- */
+/***************************************************************************
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ ***************************************************************************/
+
+#ifndef STATE_ACTION_FEATURES_H
+#define STATE_ACTION_FEATURES_H
+
+#include "real.h"
+#include "Vector.h"
+#include "Matrix.h"
+
+/** Block-sparse state-action features for LSTDQ.
+
+    LSTDQ, LSPI and OnlineLSPI use the features
+    \f$\phi(s,a) = e_a \otimes [1, f(s)]\f$, where \f$f\f$ are the
+    basis function values: only the block of action \f$a\f$, with
+    block_size = |f| + 1 elements, is non-zero.
+
+    A sample \f$(s, a, r, s', a')\f$ adds \f$\phi (\phi - \gamma
+    \phi')'\f$ to \f$A\f$, which only touches the blocks \f$(a, a)\f$
+    and \f$(a, a')\f$. AddSample() updates just these blocks in place,
+    in \f$O(|f|^2)\f$ rather than \f$O(|\phi|^2)\f$ time and without
+    forming the outer product. It gives exactly the same result as the
+    dense update.
+
+    AddSampleInverse() instead keeps \f$B = A^{-1}\f$ up to date with
+    the Sherman-Morrison formula. Since \f$\phi\f$ is sparse, the
+    products with \f$B\f$ only need the block columns or rows of
+    \f$B\f$, so an update costs \f$O(|\phi|^2)\f$ rather than the
+    \f$O(|\phi|^3)\f$ of multiplying out \f$B \phi \phi' B\f$.
+ */
+class StateActionFeatures
+{
+protected:
+    int n_actions;
+    int block_size; ///< features per action, including the constant
+    Vector u; ///< the block of \f$\phi\f$
+    Vector v; ///< the block of \f$\phi - \gamma \phi'\f$ at \f$a'\f$
+    void setBlock(Vector& y, const Vector& f) const;
+    void ShermanMorrison(Matrix& B, int r, const Vector& p,
+                         const Vector& q, int r_next, const Vector* q_next) const;
+public:
+    StateActionFeatures(int n_actions_, int n_features);
+    /// Total number of features
+    int Size() const
+    {
+        return n_actions * block_size;
+    }
+    Vector Features(const Vector& f, int a) const;
+    void AddSample(Matrix& A, Vector& b, const Vector& f, int a, real reward);
+    void AddSample(Matrix& A, Vector& b, const Vector& f, int a, real reward,
+                   const Vector& f_next, int a_next, real gamma);
+    void AddSampleInverse(Matrix& B, Vector& b, const Vector& f, int a, real reward);
+    void AddSampleInverse(Matrix& B, Vector& b, const Vector& f, int a, real reward,
+                          const Vector& f_next, int a_next, real gamma);
+};
+
+#endif
@@ -89,11 +89,14 @@ int UCRL2::Act(real reward, int next_state)
 	  update_interval += 1; //n_states;
         next_update = total_steps + update_interval;
         //printf(" # next update: %d (interval %d)\n", next_update, update_interval);
+        // replan from the previous values, around what changed since the last update
+        const std::vector<DiscreteStateAction>& changed = model->getDirtyStateActions();
         if (known_rewards) {
-            value_iteration->ComputeStateValuesKnownRewards(confidence_interval, 1e-6, -1);
+            value_iteration->UpdateStateValuesKnownRewards(changed, confidence_interval, 1e-6, -1);
         } else {
-            value_iteration->ComputeStateValues(confidence_interval, 1e-6, -1);
+            value_iteration->UpdateStateValues(changed, confidence_interval, 1e-6, -1);
         }
+        model->ClearDirtyStateActions();
         //const DiscreteMDP* mdp = model->getMeanMDP();
         //ValueIteration mean_vi(mdp, gamma);
         //mean_vi.ComputeStateValues(1e-6, -1);
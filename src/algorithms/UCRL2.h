@@ -85,6 +85,7 @@ public:
 		model->ShowModel();
 #endif
 		value_iteration->ComputeStateValuesKnownRewards(confidence_interval, 1e-6, -1);
+		model->ClearDirtyStateActions();
     }
     
 };
@@ -14,8 +14,10 @@
 #include "real.h"
 #include "MathFunctions.h"
 #include "Vector.h"
+#include "ParallelFor.h"
 #include <cmath>
 #include <cassert>
+#include <algorithm>
 
 ValueIteration::ValueIteration(const DiscreteMDP* mdp, real gamma, real baseline)
 {
@@ -24,6 +26,7 @@ ValueIteration::ValueIteration(const DiscreteMDP* mdp, real gamma, real baseline
     this->mdp = mdp;
     this->gamma = gamma;
     this->baseline = baseline;
+    n_threads = 1;
     n_actions = mdp->getNActions();
     n_states = mdp->getNStates();
     Reset();
@@ -41,6 +44,7 @@ void ValueIteration::Reset()
     dQ.Resize(n_states, n_actions);
     pQ.Resize(n_states, n_actions);
 
+    has_predecessors = false;
     
     for (int s=0; s<n_states; s++) {
         V(s) = 0.0;
@@ -58,33 +62,41 @@ ValueIteration::~ValueIteration()
 {
 }
 
+/// Synchronous backup of states [begin, end) from pV into Q and V.
+void ValueIteration::SweepStandard(int begin, int end)
+{
+    for (int s=begin; s<end; s++) {
+        for (int a=0; a<n_actions; a++) {
+            real V_next_sa = ExpectedNextValue(s, a, pV);
+            Q(s, a) = mdp->getExpectedReward(s, a) - baseline 
+                + gamma * V_next_sa;
+        }
+        V(s) = Max(Q.getRow(s));
+    }
+}
+
 /** Compute state values using value iteration.
 
 	The process ends either when the error is below the given threshold,
 	or when the given number of max_iter iterations is reached. Setting
 	max_iter to -1 means there is no limit to the number of iterations.
+
+    Each sweep only reads pV, so blocks of states are backed up on
+    n_threads threads. Delta is summed afterwards in state order, so
+    the result does not depend on the number of threads.
 */
 void ValueIteration::ComputeStateValuesStandard(real threshold, int max_iter)
 {
+    has_predecessors = false; // priorities no longer bound the residuals
     int n_iter = 0;
     do {
         Delta = 0.0;
         pV = V;
+        ParallelFor(n_states, n_threads,
+                    [this](int begin, int end, int block) {
+                        SweepStandard(begin, end);
+                    });
         for (int s=0; s<n_states; s++) {
-            for (int a=0; a<n_actions; a++) {
-                real V_next_sa = 0.0;
-                const DiscreteStateSet& next = mdp->getNextStates(s, a);
-                for (DiscreteStateSet::iterator i=next.begin();
-                     i!=next.end();
-                     ++i) {
-                    int s2 = *i;
-                    real P = mdp->getTransitionProbability(s, a, s2);
-                    V_next_sa += P * pV(s2);
-                }
-                Q(s, a) = mdp->getExpectedReward(s, a) - baseline 
-					+ gamma * V_next_sa;
-            }
-            V(s) = Max(Q.getRow(s));
             Delta += fabs(V(s) - pV(s));
         }
         
@@ -101,19 +113,12 @@ void ValueIteration::ComputeStateValuesStandard(real threshold, int max_iter)
 */
 void ValueIteration::PartialUpdate(real step_size)
 {
+    has_predecessors = false; // priorities no longer bound the residuals
     pV = V;
     for (int s=0; s<n_states; s++) {
         for (int a=0; a<n_actions; a++) {
-            real Q_sa = 0.0;
-            const DiscreteStateSet& next = mdp->getNextStates(s, a);
-            for (DiscreteStateSet::iterator i=next.begin();
-                 i!=next.end();
-                 ++i) {
-                int s2 = *i;
-                real P = mdp->getTransitionProbability(s, a, s2);
-                real R = mdp->getExpectedReward(s, a) - baseline;
-                Q_sa += P * (R + gamma * pV(s2));
-            }
+            real R = mdp->getExpectedReward(s, a) - baseline;
+            real Q_sa = Backup(s, a, R, pV);
             Q(s, a) = (1.0 - step_size) * Q(s,a) + step_size * Q_sa;
         }
         V(s) = Max(Q.getRow(s));
@@ -124,20 +129,13 @@ void ValueIteration::PartialUpdate(real step_size)
 */
 void ValueIteration::PartialUpdateOnPolicy(real step_size)
 {
+    has_predecessors = false; // priorities no longer bound the residuals
     pV = V;
     for (int s=0; s<n_states; s++) {
         int a_policy = ArgMax(Q.getRow(s));
         for (int a=0; a<n_actions; a++) {
-            real Q_sa = 0.0;
-            const DiscreteStateSet& next = mdp->getNextStates(s, a);
-            for (DiscreteStateSet::iterator i=next.begin();
-                 i!=next.end();
-                 ++i) {
-                int s2 = *i;
-                real P = mdp->getTransitionProbability(s, a, s2);
-                real R = mdp->getExpectedReward(s, a) - baseline;
-                Q_sa += P * (R + gamma * pV(s2));
-            }
+            real R = mdp->getExpectedReward(s, a) - baseline;
+            real Q_sa = Backup(s, a, R, pV);
             Q(s, a) = (1.0 - step_size) * Q(s,a) + step_size * Q_sa;
         }
         V(s) = Q(s, a_policy);
@@ -146,6 +144,21 @@ void ValueIteration::PartialUpdateOnPolicy(real step_size)
 
 
 
+/// Synchronous backup of the non-eliminated actions of states [begin, end).
+void ValueIteration::SweepElimination(int begin, int end)
+{
+    for (int s=begin; s<end; s++) {
+        for (int a=0; a<n_actions; a++) {
+            if (dQ(s,a) < 0) continue;
+            real R = mdp->getExpectedReward(s, a) - baseline;
+            real Q_sa = Backup(s, a, R, pV);
+            Q(s, a) = Q_sa;
+        }
+        V(s) = Max(Q.getRow(s));
+        dV(s) = V(s) - pV(s);
+    }
+}
+
 /** Compute state values using value iteration with action elimination.
 
 	The process ends either when the error is below the given threshold,
@@ -166,32 +179,24 @@ void ValueIteration::PartialUpdateOnPolicy(real step_size)
     V'(s) - Q(s,a)
     \f]
     then action \f$a\f$ is sub-optimal for state \f$s\f$.
+
+    As in ComputeStateValuesStandard(), the backups of each iteration
+    are split over n_threads threads.
 */
 void ValueIteration::ComputeStateValuesElimination(real threshold, int max_iter)
 {
+    has_predecessors = false; // priorities no longer bound the residuals
     int n_iter = 0;
     dQ.Clear();
     do {
         Delta = 0.0;
         pV = V;
         pQ = Q;
+        ParallelFor(n_states, n_threads,
+                    [this](int begin, int end, int block) {
+                        SweepElimination(begin, end);
+                    });
         for (int s=0; s<n_states; s++) {
-            for (int a=0; a<n_actions; a++) {
-                if (dQ(s,a) < 0) continue;
-                real Q_sa = 0.0;
-                const DiscreteStateSet& next = mdp->getNextStates(s, a);
-                for (DiscreteStateSet::iterator i=next.begin();
-                     i!=next.end();
-                     ++i) {
-                    int s2 = *i;
-                    real P = mdp->getTransitionProbability(s, a, s2);
-                    real R = mdp->getExpectedReward(s, a) - baseline;
-                    Q_sa += P * (R + gamma * pV(s2));
-                }
-                Q(s, a) = Q_sa;
-            }
-            V(s) = Max(Q.getRow(s));
-            dV(s) = V(s) - pV(s);
             Delta += fabs(dV(s));
         }
         
@@ -224,21 +229,14 @@ void ValueIteration::ComputeStateValuesElimination(real threshold, int max_iter)
 */
 void ValueIteration::ComputeStateValuesAsynchronous(real threshold, int max_iter)
 {
+    has_predecessors = false; // priorities no longer bound the residuals
     int n_iter = 0;
     do {
         Delta = 0.0;
         for (int s=0; s<n_states; s++) {
             for (int a=0; a<n_actions; a++) {
-                real Q_sa = 0.0;
-                const DiscreteStateSet& next = mdp->getNextStates(s, a);
-                for (DiscreteStateSet::iterator i=next.begin();
-                     i!=next.end();
-                     ++i) {
-                    int s2 = *i;
-                    real P = mdp->getTransitionProbability(s, a, s2);
-                    real R = mdp->getExpectedReward(s, a) - baseline;
-                    Q_sa += P * (R + gamma * V(s2));
-                }
+                real R = mdp->getExpectedReward(s, a) - baseline;
+                real Q_sa = Backup(s, a, R, V);
                 Q(s, a) = Q_sa;
             }
             V(s) = Max(Q.getRow(s));
@@ -255,6 +253,183 @@ void ValueIteration::ComputeStateValuesAsynchronous(real threshold, int max_iter
 }
 
 
+/// Bellman residual of state s with respect to the current values.
+real ValueIteration::Residual(int s) const
+{
+    real V_s = -RAND_MAX;
+    for (int a=0; a<n_actions; a++) {
+        real R = mdp->getExpectedReward(s, a) - baseline;
+        V_s = std::max(V_s, Backup(s, a, R, V));
+    }
+    return fabs(V_s - V(s));
+}
+
+/// Set the priority of a state and queue it if needed.
+void ValueIteration::SetPriority(int s, real p)
+{
+    priority[s] = p;
+    if (p > 0) {
+        residual_queue.push(std::make_pair(p, s));
+    }
+}
+
+/** Record s as a predecessor of all the successors of (s, a).
+
+    The stored weight of each predecessor is the largest transition
+    probability seen so far. It only ever grows, so it remains an
+    upper bound when the model changes.
+*/
+void ValueIteration::AddPredecessors(int s, int a)
+{
+    const DiscreteTransitionDistribution& T = mdp->transition_distribution;
+    std::vector<std::pair<int, real> > next;
+    if (T.isFrozen()) {
+        int end = T.getRowEnd(s, a);
+        real mass = T.getMass(s, a);
+        for (int k=T.getRowBegin(s, a); k<end; ++k) {
+            next.push_back(std::make_pair(T.row_next_state[k], T.row_weight[k] / mass));
+        }
+    } else {
+        const DiscreteStateSet& next_set = mdp->getNextStates(s, a);
+        for (DiscreteStateSet::const_iterator i=next_set.begin();
+             i!=next_set.end();
+             ++i) {
+            next.push_back(std::make_pair(*i, mdp->getTransitionProbability(s, a, *i)));
+        }
+    }
+    for (unsigned int i=0; i<next.size(); ++i) {
+        std::vector<std::pair<int, real> >& pred = predecessors[next[i].first];
+        std::vector<std::pair<int, real> >::iterator got
+            = std::lower_bound(pred.begin(), pred.end(), std::make_pair(s, (real) -1.0));
+        if (got == pred.end() || got->first != s) {
+            pred.insert(got, std::make_pair(s, next[i].second));
+        } else {
+            got->second = std::max(got->second, next[i].second);
+        }
+    }
+}
+
+/// Build the reverse transition index and seed every state with its exact residual.
+void ValueIteration::BuildPredecessors()
+{
+    predecessors.assign(n_states, std::vector<std::pair<int, real> >());
+    for (int s=0; s<n_states; s++) {
+        for (int a=0; a<n_actions; a++) {
+            AddPredecessors(s, a);
+        }
+    }
+    residual_queue = std::priority_queue<std::pair<real, int> >();
+    priority.assign(n_states, 0.0);
+    for (int s=0; s<n_states; s++) {
+        SetPriority(s, Residual(s));
+    }
+    has_predecessors = true;
+}
+
+/** Compute state values using prioritised sweeping.
+
+    States are backed up in place, one at a time, in order of their
+    Bellman residual. After a backup that changes \f$V(s)\f$ by
+    \f$\delta\f$, the priority of each predecessor \f$p\f$ of \f$s\f$
+    is increased by \f$\gamma \max_a P(s|p,a) \delta\f$ (or an upper
+    bound of it, see AddPredecessors()), which keeps
+    the priorities upper bounds on the residuals. The process ends
+    when no state has priority at least threshold, or after max_backups
+    backups (-1 means no limit).
+
+    The reverse index and the priorities are kept between calls. The
+    first call (or the first after Reset() or setMDP()) seeds all
+    states; later calls only process the states queued since, e.g.
+    through UpdateStateAction(), so replanning after a small change
+    in the model only touches the affected neighbourhood.
+*/
+void ValueIteration::ComputeStateValuesPrioritised(real threshold, int max_backups)
+{
+    if (!has_predecessors) {
+        BuildPredecessors();
+    }
+    Delta = 0.0;
+    while (!residual_queue.empty() && max_backups != 0) {
+        std::pair<real, int> top = residual_queue.top();
+        int s = top.second;
+        if (top.first != priority[s]) {
+            residual_queue.pop();
+            continue;
+        }
+        if (top.first < threshold) {
+            break;
+        }
+        residual_queue.pop();
+        priority[s] = 0.0;
+        for (int a=0; a<n_actions; a++) {
+            real R = mdp->getExpectedReward(s, a) - baseline;
+            Q(s, a) = Backup(s, a, R, V);
+        }
+        real V_s = Max(Q.getRow(s));
+        real delta = fabs(V_s - V(s));
+        V(s) = V_s;
+        pV(s) = V_s;
+        if (delta > 0) {
+            const std::vector<std::pair<int, real> >& pred = predecessors[s];
+            for (unsigned int i=0; i<pred.size(); ++i) {
+                int p = pred[i].first;
+                SetPriority(p, priority[p] + gamma * pred[i].second * delta);
+            }
+        }
+        if (max_backups > 0) {
+            max_backups--;
+        }
+    }
+    // the largest remaining priority bounds the residual
+    while (!residual_queue.empty()
+           && residual_queue.top().first != priority[residual_queue.top().second]) {
+        residual_queue.pop();
+    }
+    if (!residual_queue.empty()) {
+        Delta = residual_queue.top().first;
+    }
+}
+
+/** Notify the solver that the model of (s, a) has changed.
+
+    New successors of (s, a) are added to the reverse index and s is
+    queued with its exact residual, to be processed by the next call
+    to ComputeStateValuesPrioritised().
+*/
+void ValueIteration::UpdateStateAction(int s, int a)
+{
+    if (!has_predecessors) {
+        return;
+    }
+    AddPredecessors(s, a);
+    SetPriority(s, Residual(s));
+}
+
+/** Replan after the given state-action pairs of the MDP have changed.
+
+    The current values are used as a warm start, and only states
+    reachable backwards from the changed pairs are backed up. See
+    ComputeStateValuesPrioritised().
+*/
+void ValueIteration::ComputeStateValuesIncremental(const std::vector<DiscreteStateAction>& changed,
+                                                   real threshold,
+                                                   int max_backups)
+{
+    if (has_predecessors) {
+        std::vector<int> states;
+        for (unsigned int i=0; i<changed.size(); ++i) {
+            AddPredecessors(changed[i].state, changed[i].action);
+            states.push_back(changed[i].state);
+        }
+        std::sort(states.begin(), states.end());
+        states.erase(std::unique(states.begin(), states.end()), states.end());
+        for (unsigned int i=0; i<states.size(); ++i) {
+            SetPriority(states[i], Residual(states[i]));
+        }
+    }
+    ComputeStateValuesPrioritised(threshold, max_backups);
+}
+
 
 
 /** Compute state-action values using value iteration.
@@ -19,12 +19,68 @@
 #include "Vector.h"
 #include "real.h"
 #include <vector>
+#include <queue>
+#include <utility>
 
 /** A value iteration algorithm for discrete MDPs */
 class ValueIteration
 {
 protected:
     const DiscreteMDP* mdp; ///< pointer to the MDP
+    /// \f$\sum_{s'} P(s'|s,a) U(s')\f$
+    inline real ExpectedNextValue(int s, int a, const Vector& U) const
+    {
+        real EU = 0.0;
+        const DiscreteTransitionDistribution& T = mdp->transition_distribution;
+        if (T.isFrozen()) {
+            int end = T.getRowEnd(s, a);
+            for (int k=T.getRowBegin(s, a); k<end; ++k) {
+                EU += T.row_weight[k] * U(T.row_next_state[k]);
+            }
+            return EU / T.getMass(s, a);
+        }
+        const DiscreteStateSet& next = mdp->getNextStates(s, a);
+        for (DiscreteStateSet::const_iterator i=next.begin();
+             i!=next.end();
+             ++i) {
+            int s2 = *i;
+            EU += mdp->getTransitionProbability(s, a, s2) * U(s2);
+        }
+        return EU;
+    }
+    /// \f$\sum_{s'} P(s'|s,a) [R + \gamma U(s')]\f$
+    inline real Backup(int s, int a, real R, const Vector& U) const
+    {
+        real Q_sa = 0.0;
+        const DiscreteTransitionDistribution& T = mdp->transition_distribution;
+        if (T.isFrozen()) {
+            int end = T.getRowEnd(s, a);
+            for (int k=T.getRowBegin(s, a); k<end; ++k) {
+                Q_sa += T.row_weight[k] * (R + gamma * U(T.row_next_state[k]));
+            }
+            return Q_sa / T.getMass(s, a);
+        }
+        const DiscreteStateSet& next = mdp->getNextStates(s, a);
+        for (DiscreteStateSet::const_iterator i=next.begin();
+             i!=next.end();
+             ++i) {
+            int s2 = *i;
+            Q_sa += mdp->getTransitionProbability(s, a, s2) * (R + gamma * U(s2));
+        }
+        return Q_sa;
+    }
+    void SweepStandard(int begin, int end);
+    void SweepElimination(int begin, int end);
+    /// Reverse transition index: for each state, the states that can
+    /// reach it, with an upper bound on \f$\max_a P(s|p,a)\f$.
+    std::vector<std::vector<std::pair<int, real> > > predecessors;
+    std::vector<real> priority; ///< upper bound on the Bellman residual of each state
+    std::priority_queue<std::pair<real, int> > residual_queue; ///< max-heap of (priority, state), possibly stale
+    bool has_predecessors; ///< whether predecessors and priority are up to date
+    void BuildPredecessors();
+    void AddPredecessors(int s, int a);
+    real Residual(int s) const;
+    void SetPriority(int s, real p);
 public:
     real gamma; ///< discount factor
     int n_states; ///< number of states
@@ -37,6 +93,7 @@ public:
     Matrix pQ; ///< previous state-action values
     real Delta;
     real baseline;
+    int n_threads; ///< number of threads for synchronous sweeps (<= 0: all cores)
     ValueIteration(const DiscreteMDP* mdp, real gamma, real baseline=0.0);
     ~ValueIteration();
     void Reset();
@@ -50,12 +107,26 @@ public:
     void PartialUpdateOnPolicy(real stepsize);
     void ComputeStateValuesAsynchronous(real threshold, int max_iter=-1);
     void ComputeStateValuesElimination(real threshold, int max_iter=-1);
+    void ComputeStateValuesPrioritised(real threshold, int max_backups=-1);
+    void UpdateStateAction(int s, int a);
+    void ComputeStateValuesIncremental(const std::vector<DiscreteStateAction>& changed,
+                                       real threshold,
+                                       int max_backups=-1);
     void ComputeStateActionValues(real threshold, int max_iter=-1);
-    /// Set the MDP to something else
+    /// Set the MDP to something else.
+    /// Changes within the same MDP should be signalled with UpdateStateAction().
     inline void setMDP(const DiscreteMDP* mdp_)
     {
+        if (mdp_ != mdp) {
+            has_predecessors = false;
+        }
         mdp = mdp_;
     }
+    /// Use n_threads_ threads for the synchronous sweeps
+    inline void setNThreads(int n_threads_)
+    {
+        n_threads = n_threads_;
+    }
     inline void setDiscount(real gamma_) {
         assert(gamma >= 0.0 && gamma <= 1.0);
         gamma = gamma_;
@@ -69,11 +140,11 @@ public:
         return V(state);
     }
     FixedDiscretePolicy* getPolicy();
-    inline Matrix getValues() const
+    inline const Matrix& getValues() const
     {
         return Q;
     }
-    inline Vector getStateValues() const
+    inline const Vector& getStateValues() const
     {
         return V;
     }
@@ -37,6 +37,8 @@ int horizon; ///< Maximum horizon for the rollouts
 int grids; ///< Number of grids per state space dimension
 int n_episodes; ///< number of episodes
 int n_evaluations; ///< number of evaluations
+int n_threads; ///< number of search threads
+bool tree_parallel; ///< share one tree between the threads
 Options(RandomNumberGenerator& rng_) :
   gamma(0.999),
   environment_name(NULL),
@@ -45,7 +47,9 @@ Options(RandomNumberGenerator& rng_) :
   horizon(1000),
     grids(100),
   n_episodes(1000),
-  n_evaluations(10)
+  n_evaluations(10),
+  n_threads(1),
+  tree_parallel(false)
 {
 }
 
@@ -60,6 +64,7 @@ logmsg("Episode horizon: %d\n", horizon);
 //logmsg("Grids: %d\n", grids);
 logmsg("n_episodes: %d\n", n_episodes);
 logmsg("n_evaluations: %d\n", n_evaluations);
+logmsg("n_threads: %d (%s)\n", n_threads, tree_parallel ? "tree" : "root");
 logmsg("------------------------\n");
 }
     };
@@ -75,6 +80,25 @@ EpisodeStatistics() : total_reward(0.0),
 {}
   };
 
+ContinuousStateEnvironment* MakeEnvironment(const char* environment_name)
+{
+ if (!strcmp(environment_name, "MountainCar")) {
+   return new MountainCar(0.0);
+ } else if (!strcmp(environment_name, "Pendulum")) {
+   return new Pendulum();
+ } else if (!strcmp(environment_name, "PuddleWorld")) {
+   return new PuddleWorld();
+ } else if (!strcmp(environment_name, "Bike")) {
+   return new Bike();
+ } else if (!strcmp(environment_name, "Acrobot")) {
+   return new Acrobot();
+ } else if (!strcmp(environment_name, "CartPole")) {
+   return new CartPole();
+ }
+ fprintf(stderr, "Unknown environment %s \n", environment_name);
+ return NULL;
+}
+
 /** Run a test */
 template <class S, class A>
 std::vector<EpisodeStatistics> RunTest(ContinuousStateEnvironment* environment, Options& options)
@@ -91,6 +115,22 @@ RandomPolicy random_policy(environment->getNActions(), &options.rng);
 AbstractPolicy<Vector, int>& policy = random_policy;
 
 MonteCarloTreeSearch<S,A> mcts(options.gamma, environment, &options.rng,policy, options.depth);
+
+// Every extra thread needs its own environment, policy and RNG.
+std::vector<ContinuousStateEnvironment*> thread_environments;
+std::vector<RandomNumberGenerator*> thread_rngs;
+std::vector<RandomPolicy*> thread_policies;
+for (int t=1; t<options.n_threads; ++t) {
+  MersenneTwisterRNG* thread_rng = new MersenneTwisterRNG();
+  thread_rng->manualSeed(options.rng.random());
+  thread_rngs.push_back(thread_rng);
+  thread_environments.push_back(MakeEnvironment(options.environment_name));
+  thread_policies.push_back(new RandomPolicy(environment->getNActions(), thread_rng));
+  mcts.AddThread(thread_environments.back(), thread_policies.back(), thread_rng);
+}
+if (options.tree_parallel) {
+  mcts.setParallelMode(MonteCarloTreeSearch<S,A>::TREE_PARALLEL);
+}
 int state_dimension = environment->getNStates();
 Vector S_L = environment->StateLowerBound();
 Vector S_U = environment->StateUpperBound();
@@ -136,6 +176,11 @@ statistics[episode].steps = step;
 //printf("Steps = %d\n",step);
 }
 
+for (unsigned int t=0; t<thread_environments.size(); ++t) {
+  delete thread_policies[t];
+  delete thread_environments[t];
+  delete thread_rngs[t];
+}
 return statistics;
 
 }
@@ -152,6 +197,8 @@ static const char* const help_text = "Usage: test [options]\n\
     --seed:                  seed all the RNGs with this\n\
     --seed_file:             select a binary file to choose seeds from (use in conjunction with --seed to select the n-th seed in the file)\n\
     --Rmax:                  maximum reward value\n\
+    --threads:               number of search threads\n\
+    --tree_parallel:         let all threads share one tree\n\
 \n";
 int main(int argc, char* argv[])
 {
@@ -176,6 +223,8 @@ static struct option long_options[] = {
 	{"seed", required_argument, 0, 0}, //5
 	{"n_evaluations",required_argument, 0, 0}, //6
 	{"seed_file", required_argument, 0, 0}, //7
+	{"threads", required_argument, 0, 0}, //8
+	{"tree_parallel", no_argument, 0, 0}, //9
 	{0, 0, 0, 0}
 };
  c = getopt_long(argc, argv, "", long_options, &option_index);
@@ -199,6 +248,8 @@ static struct option long_options[] = {
    case 5: seed = atoi(optarg); break;
    case 6: options.n_evaluations = atoi(optarg); break;
    case 7: seed_filename = optarg; break;
+   case 8: options.n_threads = atoi(optarg); break;
+   case 9: options.tree_parallel = true; break;
    default:
      fprintf (stderr, "Invalid options\n");
      exit(0);
@@ -255,26 +306,14 @@ static struct option long_options[] = {
    Serror("depth must be >= 1\n");
    exit(-1);
  }
+ if (options.n_threads < 1) {
+   Serror("threads must be >= 1\n");
+   exit(-1);
+ }
  logmsg("Starting environment %s\n", options.environment_name);
  options.ShowOptions();
 
- ContinuousStateEnvironment* environment = NULL;
-  
- if (!strcmp(options.environment_name, "MountainCar")) {
-   environment =  new MountainCar(0.0);
- } else if (!strcmp(options.environment_name, "Pendulum")) {
-   environment = new Pendulum();
- } else if (!strcmp(options.environment_name, "PuddleWorld")) {
-   environment = new PuddleWorld();
- } else if (!strcmp(options.environment_name, "Bike")) {
-   environment = new Bike();
- } else if (!strcmp(options.environment_name, "Acrobot")) {
-   environment = new Acrobot();
- } else if (!strcmp(options.environment_name, "CartPole")) {
-   environment = new CartPole();
- } else {
-   fprintf(stderr, "Unknown environment %s \n", options.environment_name);
- }
+ ContinuousStateEnvironment* environment = MakeEnvironment(options.environment_name);
     
  Matrix StatDR(options.n_evaluations, options.n_episodes);
  Matrix StatTR(options.n_evaluations, options.n_episodes);
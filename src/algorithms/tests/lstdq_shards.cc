@@ -0,0 +1,124 @@
+/* -*- Mode: C++; -*- */
+/***************************************************************************
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ ***************************************************************************/
+
+#ifdef MAKE_MAIN
+
+#include "LSTDQ.h"
+#include "BasisSet.h"
+#include "Demonstrations.h"
+#include "Random.h"
+#include <cmath>
+
+/// Count the elements of A and B that differ by more than tolerance.
+int CountDifferences(const Matrix& A, const Matrix& B, real tolerance)
+{
+    int n_differences = 0;
+    for (int i=0; i<A.Rows(); ++i) {
+        for (int j=0; j<A.Columns(); ++j) {
+            if (fabs(A(i, j) - B(i, j)) > tolerance) {
+                n_differences++;
+            }
+        }
+    }
+    return n_differences;
+}
+
+/// Count the elements of x and y that differ by more than tolerance.
+int CountDifferences(const Vector& x, const Vector& y, real tolerance)
+{
+    int n_differences = 0;
+    for (int i=0; i<x.Size(); ++i) {
+        if (fabs(x(i) - y(i)) > tolerance) {
+            n_differences++;
+        }
+    }
+    return n_differences;
+}
+
+/** Check that Calculate() does not depend on the number of threads.
+
+    For a fixed number of shards, A, b and the weights must be exactly
+    the same with any number of threads. With a different number of
+    shards, they may only differ by rounding.
+ */
+int shard_test(RBFBasisSet& basis, Demonstrations<Vector, int>& samples,
+               int n_actions, int n_shards)
+{
+    printf ("# Testing LSTDQ with %d shards\n", n_shards);
+    int n_errors = 0;
+    real gamma = 0.9;
+    LSTDQ serial(gamma, 2, n_actions, basis, samples);
+    serial.Calculate();
+    LSTDQ reference(gamma, 2, n_actions, basis, samples);
+    reference.setNShards(n_shards);
+    reference.Calculate();
+    if (CountDifferences(reference.getMatrix(), serial.getMatrix(), 1e-9)
+        || CountDifferences(reference.getVector(), serial.getVector(), 1e-9)) {
+        printf ("ERROR: %d shards do not add up to the sequential sum\n", n_shards);
+        n_errors++;
+    }
+    int thread_counts[] = {2, 4};
+    for (int i=0; i<2; ++i) {
+        LSTDQ parallel(gamma, 2, n_actions, basis, samples);
+        parallel.setNShards(n_shards);
+        parallel.setNThreads(thread_counts[i]);
+        parallel.Calculate();
+        int n_A = CountDifferences(parallel.getMatrix(), reference.getMatrix(), 0);
+        int n_b = CountDifferences(parallel.getVector(), reference.getVector(), 0);
+        int n_w = CountDifferences(parallel.getWeights(), reference.getWeights(), 0);
+        if (n_A || n_b || n_w) {
+            printf ("ERROR: %d threads: %d, %d and %d elements of A, b and w differ from 1 thread\n",
+                    thread_counts[i], n_A, n_b, n_w);
+            n_errors++;
+        }
+    }
+    return n_errors;
+}
+
+int main(void)
+{
+    setRandomSeed(1);
+    int n_actions = 3;
+    Vector lower(2);
+    Vector upper(2);
+    for (int d=0; d<2; ++d) {
+        lower(d) = -1;
+        upper(d) = 1;
+    }
+    EvenGrid grid(lower, upper, 4);
+    RBFBasisSet basis(grid, 0.5);
+
+    Demonstrations<Vector, int> samples;
+    for (int i=0; i<24; ++i) {
+        int T = 5 + urandom(0, 20);
+        for (int t=0; t<T; ++t) {
+            Vector s(2);
+            s(0) = urandom(-1, 1);
+            s(1) = urandom(-1, 1);
+            samples.Observe(s, urandom(0, n_actions), urandom(-1, 1));
+        }
+        if (i % 3 == 0) {
+            samples.Terminate();
+        }
+        samples.NewEpisode();
+    }
+
+    int n_errors = 0;
+    n_errors += shard_test(basis, samples, n_actions, 4);
+    n_errors += shard_test(basis, samples, n_actions, 7);
+    if (n_errors) {
+        printf ("# %d ERRORS found\n", n_errors);
+    } else {
+        printf ("# All tests OK\n");
+    }
+    return n_errors;
+}
+
+#endif
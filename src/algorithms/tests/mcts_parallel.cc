@@ -0,0 +1,186 @@
+/* -*- Mode: C++; -*- */
+/***************************************************************************
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ ***************************************************************************/
+
+#ifdef MAKE_MAIN
+
+#include "MonteCarloTreeSearch.h"
+#include "RandomPolicy.h"
+#include "MersenneTwister.h"
+#include "ParallelFor.h"
+#include "Random.h"
+#include <cmath>
+#include <vector>
+
+/** A short deterministic chain.
+
+    Action 1 moves right and action 0 moves left. Every step that ends
+    at the right end gives a reward of 1. The chain never terminates
+    and its transitions are deterministic, so that the tree statistics
+    do not depend on which successors each tree happened to sample.
+ */
+class Chain : public ContinuousStateEnvironment
+{
+protected:
+    int length;
+public:
+    Chain(int length_)
+        : ContinuousStateEnvironment(1, 2),
+          length(length_)
+    {
+        state = Vector(1);
+        Reset();
+    }
+    virtual void Reset()
+    {
+        state(0) = 0;
+        reward = 0;
+        endsim = false;
+    }
+    virtual bool Act(const int& action)
+    {
+        int x = (int) state(0);
+        x = (action == 1) ? std::min(length - 1, x + 1) : std::max(0, x - 1);
+        state(0) = x;
+        reward = (x == length - 1) ? 1.0 : 0.0;
+        return true;
+    }
+    virtual const char* Name() const
+    {
+        return "Chain";
+    }
+};
+
+typedef MonteCarloTreeSearch<Vector, int> MCTS;
+
+/// Per-thread environment, policy and generator.
+struct SearchThread
+{
+    Chain environment;
+    MersenneTwisterRNG rng;
+    RandomPolicy policy;
+    SearchThread(unsigned long seed)
+        : environment(4),
+          policy(2, &rng)
+    {
+        rng.manualSeed(seed);
+    }
+};
+
+/// Search from the start state and return the root statistics.
+int Search(int n_threads, bool tree_parallel, int n_rollouts,
+           Vector& values, std::vector<int>& visits)
+{
+    real gamma = 0.9;
+    std::vector<SearchThread*> threads;
+    for (int t=0; t<n_threads; ++t) {
+        threads.push_back(new SearchThread(1000 + t));
+    }
+    MCTS mcts(gamma, &threads[0]->environment, &threads[0]->rng,
+              threads[0]->policy, 100, n_rollouts);
+    for (int t=1; t<n_threads; ++t) {
+        mcts.AddThread(&threads[t]->environment, &threads[t]->policy, &threads[t]->rng);
+    }
+    if (tree_parallel) {
+        mcts.setParallelMode(MCTS::TREE_PARALLEL);
+    }
+    Vector start(1);
+    int action = mcts.SelectAction(start);
+    values = Vector(2);
+    visits.resize(2);
+    for (int a=0; a<2; ++a) {
+        values(a) = mcts.getRootValue(a);
+        visits[a] = mcts.getRootVisits(a);
+    }
+    for (int t=0; t<n_threads; ++t) {
+        delete threads[t];
+    }
+    return action;
+}
+
+/// Check that a parallel search agrees with the serial one.
+int parallel_search_test(int n_threads, bool tree_parallel,
+                         int serial_action, const Vector& serial_values)
+{
+    printf ("# Testing %s search with %d threads\n",
+            tree_parallel ? "tree-parallel" : "root-parallel", n_threads);
+    int n_errors = 0;
+    int n_rollouts = 4000;
+    Vector values;
+    std::vector<int> visits;
+    int action = Search(n_threads, tree_parallel, n_rollouts, values, visits);
+    if (action != serial_action) {
+        printf ("ERROR: action %d, serial action %d\n", action, serial_action);
+        n_errors++;
+    }
+    if (visits[0] + visits[1] != n_rollouts) {
+        printf ("ERROR: %d + %d root visits for %d rollouts\n",
+                visits[0], visits[1], n_rollouts);
+        n_errors++;
+    }
+    for (int a=0; a<2; ++a) {
+        if (fabs(values(a) - serial_values(a)) > 0.05) {
+            printf ("ERROR: action %d value %f, serial value %f\n",
+                    a, values(a), serial_values(a));
+            n_errors++;
+        }
+    }
+    return n_errors;
+}
+
+/// Check that worker threads that were never seeded get different streams.
+int thread_seed_test(int n_threads)
+{
+    printf ("# Testing default seeds of %d threads\n", n_threads);
+    int n_errors = 0;
+    std::vector<real> first(n_threads);
+    ParallelFor(n_threads, n_threads, [&](int begin, int end, int block) {
+            for (int t=begin; t<end; ++t) {
+                first[t] = urandom();
+            }
+        });
+    for (int t=0; t<n_threads; ++t) {
+        for (int k=0; k<t; ++k) {
+            if (first[t] == first[k]) {
+                printf ("ERROR: blocks %d and %d drew the same number\n", k, t);
+                n_errors++;
+            }
+        }
+    }
+    return n_errors;
+}
+
+int main(void)
+{
+    setRandomSeed(1);
+    int n_errors = 0;
+    n_errors += thread_seed_test(4);
+
+    Vector serial_values;
+    std::vector<int> serial_visits;
+    int serial_action = Search(1, false, 4000, serial_values, serial_visits);
+    printf ("# Serial search: action %d, values %f %f\n",
+            serial_action, serial_values(0), serial_values(1));
+    if (serial_action != 1) {
+        printf ("ERROR: serial search chose action %d\n", serial_action);
+        n_errors++;
+    }
+    n_errors += parallel_search_test(4, false, serial_action, serial_values);
+    n_errors += parallel_search_test(4, true, serial_action, serial_values);
+    n_errors += parallel_search_test(3, true, serial_action, serial_values);
+
+    if (n_errors) {
+        printf ("# %d ERRORS found\n", n_errors);
+    } else {
+        printf ("# All tests OK\n");
+    }
+    return n_errors;
+}
+
+#endif
@@ -0,0 +1,107 @@
+/* -*- Mode: C++; -*- */
+/***************************************************************************
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ ***************************************************************************/
+
+#ifdef MAKE_MAIN
+
+#include "StateActionFeatures.h"
+#include "Random.h"
+#include <cmath>
+
+/// Return the largest absolute difference between A and B.
+real MaxDifference(const Matrix& A, const Matrix& B)
+{
+    real max_diff = 0;
+    for (int i=0; i<A.Rows(); ++i) {
+        for (int j=0; j<A.Columns(); ++j) {
+            max_diff = std::max(max_diff, (real) fabs(A(i, j) - B(i, j)));
+        }
+    }
+    return max_diff;
+}
+
+/** Check the block-sparse updates against the dense accumulation.
+
+    AddSample() must give the same A and b as adding the dense
+    \f$\phi (\phi - \gamma \phi')'\f$, and AddSampleInverse() must
+    keep B equal to the inverse of that A.
+ */
+int sample_test(int n_actions, int n_features, int n_samples, real gamma)
+{
+    printf ("# Testing %d samples with %d actions and %d features\n",
+            n_samples, n_actions, n_features);
+    int n_errors = 0;
+    StateActionFeatures features(n_actions, n_features);
+    int n = features.Size();
+    Matrix A_dense = Matrix::Unity(n, n);
+    Vector b_dense(n);
+    Matrix A = Matrix::Unity(n, n);
+    Vector b(n);
+    Matrix B = Matrix::Unity(n, n);
+    Vector b_inverse(n);
+    for (int t=0; t<n_samples; ++t) {
+        Vector f(n_features);
+        Vector f_next(n_features);
+        for (int k=0; k<n_features; ++k) {
+            f(k) = urandom(-1, 1);
+            f_next(k) = urandom(-1, 1);
+        }
+        int a = urandom(0, n_actions);
+        int a_next = urandom(0, n_actions);
+        real reward = urandom(-1, 1);
+        Vector phi = features.Features(f, a);
+        if (t % 5 == 4) {
+            // terminal sample
+            A_dense += OuterProduct(phi, phi);
+            features.AddSample(A, b, f, a, reward);
+            features.AddSampleInverse(B, b_inverse, f, a, reward);
+        } else {
+            Vector phi_next = features.Features(f_next, a_next);
+            A_dense += OuterProduct(phi, phi - phi_next * gamma);
+            features.AddSample(A, b, f, a, reward, f_next, a_next, gamma);
+            features.AddSampleInverse(B, b_inverse, f, a, reward, f_next, a_next, gamma);
+        }
+        b_dense += phi * reward;
+    }
+
+    real A_diff = MaxDifference(A, A_dense);
+    if (A_diff > 1e-12) {
+        printf ("ERROR: A differs from the dense A by %g\n", A_diff);
+        n_errors++;
+    }
+    Matrix A_inverse = A_dense.Inverse();
+    real B_diff = MaxDifference(B, A_inverse);
+    if (B_diff > 1e-8) {
+        printf ("ERROR: B differs from the inverse of A by %g\n", B_diff);
+        n_errors++;
+    }
+    for (int i=0; i<n; ++i) {
+        if (fabs(b(i) - b_dense(i)) > 1e-12 || fabs(b_inverse(i) - b_dense(i)) > 1e-12) {
+            printf ("ERROR: b(%d): %f %f %f\n", i, b(i), b_inverse(i), b_dense(i));
+            n_errors++;
+        }
+    }
+    return n_errors;
+}
+
+int main(void)
+{
+    setRandomSeed(1);
+    int n_errors = 0;
+    n_errors += sample_test(1, 3, 50, 0.9);
+    n_errors += sample_test(3, 4, 200, 0.95);
+    if (n_errors) {
+        printf ("# %d ERRORS found\n", n_errors);
+    } else {
+        printf ("# All tests OK\n");
+    }
+    return n_errors;
+}
+
+#endif
@@ -75,7 +75,9 @@ int main (int argc, char** argv)
     bool test_synchronous = true;
     bool test_asynchronous = true;
     bool test_elimination = true;
+    bool test_prioritised = true;
     bool test_gradient = true;
+    int n_errors = 0;
 
 
     if (test_synchronous)
@@ -143,6 +145,37 @@ int main (int argc, char** argv)
         delete policy;
     }
 
+    if (test_prioritised)
+    {
+        ValueIteration value_iteration(mdp, gamma);
+        double start_time = GetCPU();
+        value_iteration.ComputeStateValuesPrioritised(accuracy, n_iterations * n_states);
+        double end_time = GetCPU();
+        real U = 0;
+        for (int s=0; s<n_states; ++s) {
+            U += value_iteration.getValue(s);
+        }
+        printf ("%d %f %f # PSVI time util\n",
+				n_iterations,
+				end_time - start_time,
+				U / (real) n_states);
+
+        // Both solutions must be within their residual bounds of
+        // the fixed point, hence within the sum of the bounds of
+        // each other.
+        ValueIteration standard(mdp, gamma);
+        standard.ComputeStateValuesStandard(accuracy, n_iterations);
+        real tolerance = (value_iteration.Delta + gamma * standard.Delta) / (1 - gamma) + 1e-6;
+        for (int s=0; s<n_states; ++s) {
+            real error = fabs(value_iteration.getValue(s) - standard.getValue(s));
+            if (error > tolerance) {
+                printf ("ERROR: PSVI value of state %d differs by %f > %f\n",
+                        s, error, tolerance);
+                n_errors++;
+            }
+        }
+    }
+
     
     if (test_gradient)
     {
@@ -192,7 +225,10 @@ int main (int argc, char** argv)
 
     
     printf("\nDone\n");
-    return 0.0;
+    if (n_errors) {
+        printf ("# %d ERRORS found\n", n_errors);
+    }
+    return n_errors;
 }
 
 
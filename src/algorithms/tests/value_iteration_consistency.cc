@@ -0,0 +1,258 @@
+/* -*- Mode: C++; -*- */
+/***************************************************************************
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ ***************************************************************************/
+
+#ifdef MAKE_MAIN
+
+#include "ValueIteration.h"
+#include "OptimisticValueIteration.h"
+#include "MultiMDPValueIteration.h"
+#include "DiscreteMDPCounts.h"
+#include "RandomMDP.h"
+#include "DiscreteChain.h"
+#include "MersenneTwister.h"
+#include "Random.h"
+
+/// Check that parallel sweeps give exactly the serial values.
+int parallel_sweep_test(const DiscreteMDP* mdp, real gamma, int n_threads)
+{
+    printf ("# Testing parallel sweeps with %d threads\n", n_threads);
+    int n_errors = 0;
+    for (int method=0; method<2; ++method) {
+        ValueIteration serial(mdp, gamma);
+        ValueIteration parallel(mdp, gamma);
+        parallel.setNThreads(n_threads);
+        if (method == 0) {
+            serial.ComputeStateValuesStandard(1e-6, 1000);
+            parallel.ComputeStateValuesStandard(1e-6, 1000);
+        } else {
+            serial.ComputeStateValuesElimination(1e-6, 1000);
+            parallel.ComputeStateValuesElimination(1e-6, 1000);
+        }
+        for (int s=0; s<mdp->getNStates(); ++s) {
+            if (serial.getValue(s) != parallel.getValue(s)) {
+                printf ("ERROR: method %d, state %d: %f %f\n",
+                        method, s, serial.getValue(s), parallel.getValue(s));
+                n_errors++;
+            }
+            for (int a=0; a<mdp->getNActions(); ++a) {
+                if (serial.getValue(s, a) != parallel.getValue(s, a)) {
+                    printf ("ERROR: method %d, state %d, action %d: %f %f\n",
+                            method, s, a, serial.getValue(s, a), parallel.getValue(s, a));
+                    n_errors++;
+                }
+            }
+        }
+    }
+    return n_errors;
+}
+
+/** Check that prioritised sweeping converges to the standard values.
+
+    Prioritised sweeping stops when all residuals are below the
+    threshold, so its values are within threshold / (1 - gamma) of the
+    fixed point.
+ */
+int prioritised_test(const DiscreteMDP* mdp, real gamma, real threshold)
+{
+    printf ("# Testing prioritised sweeping with threshold %g\n", threshold);
+    int n_errors = 0;
+    ValueIteration standard(mdp, gamma);
+    ValueIteration prioritised(mdp, gamma);
+    standard.ComputeStateValuesStandard(1e-9, 100000);
+    prioritised.ComputeStateValuesPrioritised(threshold, -1);
+    if (prioritised.Delta >= threshold) {
+        printf ("ERROR: residual %g not below threshold\n", prioritised.Delta);
+        n_errors++;
+    }
+    real tolerance = (threshold + 1e-9) / (1 - gamma);
+    for (int s=0; s<mdp->getNStates(); ++s) {
+        if (fabs(standard.getValue(s) - prioritised.getValue(s)) > tolerance) {
+            printf ("ERROR: state %d: %f %f\n",
+                    s, standard.getValue(s), prioritised.getValue(s));
+            n_errors++;
+        }
+    }
+    return n_errors;
+}
+
+/** Check that optimistic replanning matches a full rebuild.
+
+    The augmented MDP of the incremental solver stays frozen and
+    only has the rows of the changed state-actions re-packed, so its
+    values must agree with a solver built from scratch on the same
+    counts.
+ */
+int optimistic_update_test(int n_states, int n_actions, real gamma)
+{
+    printf ("# Testing optimistic replanning on %d states\n", n_states);
+    int n_errors = 0;
+    real delta = 0.1;
+    real threshold = 1e-8;
+    DiscreteMDPCounts model(n_states, n_actions);
+    OptimisticValueIteration incremental(&model, gamma);
+    for (int t=0; t<10 * n_states; ++t) {
+        int s = urandom(0, n_states);
+        int a = urandom(0, n_actions);
+        model.AddTransition(s, a, urandom(), (s + a + urandom(0, 2)) % n_states);
+    }
+    model.ClearDirtyStateActions();
+    incremental.ComputeStateValues(delta, threshold);
+    for (int round=0; round<5; ++round) {
+        for (int t=0; t<n_states; ++t) {
+            int s = urandom(0, n_states);
+            int a = urandom(0, n_actions);
+            model.AddTransition(s, a, urandom(), urandom(0, n_states));
+        }
+        incremental.UpdateStateValues(model.getDirtyStateActions(), delta, threshold);
+        model.ClearDirtyStateActions();
+        OptimisticValueIteration full(&model, gamma);
+        full.ComputeStateValues(delta, threshold);
+        real tolerance = 2 * threshold / (1 - gamma);
+        // the full solve eliminates actions, so only compare state values
+        for (int s=0; s<n_states; ++s) {
+            if (fabs(incremental.getValue(s) - full.getValue(s)) > tolerance) {
+                printf ("ERROR: round %d, state %d: %f %f\n",
+                        round, s, incremental.getValue(s), full.getValue(s));
+                n_errors++;
+            }
+        }
+    }
+    return n_errors;
+}
+
+/** Check the packed multi-MDP solver against the individual MDPs.
+
+    Separate values must match a ValueIteration run on each MDP. With
+    a shared policy, each Q[mu] must be the one-step backup of V[mu]
+    in MDP mu itself, which checks the union sparsity pattern.
+ */
+int multi_mdp_test(int n_mdps, int n_states, int n_actions, real gamma,
+                   RandomNumberGenerator* rng)
+{
+    printf ("# Testing multi-MDP value iteration on %d MDPs\n", n_mdps);
+    int n_errors = 0;
+    real tolerance = 1e-6;
+    std::vector<const DiscreteMDP*> mdp_list(n_mdps);
+    for (int mu=0; mu<n_mdps; ++mu) {
+        RandomMDP random_mdp(n_states, n_actions, 0.2, -0.1, -1, 1, rng, false);
+        mdp_list[mu] = random_mdp.getMDP();
+    }
+    Vector w(n_mdps);
+    for (int mu=0; mu<n_mdps; ++mu) {
+        w(mu) = 1.0 / (real) n_mdps;
+    }
+
+    MultiMDPValueIteration separate(w, mdp_list, gamma);
+    separate.ComputeSeparateStateValues(1e-10, -1);
+    for (int mu=0; mu<n_mdps; ++mu) {
+        ValueIteration value_iteration(mdp_list[mu], gamma);
+        value_iteration.ComputeStateValuesStandard(1e-10, 100000);
+        for (int s=0; s<n_states; ++s) {
+            if (fabs(separate.V[mu](s) - value_iteration.getValue(s)) > tolerance) {
+                printf ("ERROR: MDP %d, state %d: %f %f\n",
+                        mu, s, separate.V[mu](s), value_iteration.getValue(s));
+                n_errors++;
+            }
+            for (int a=0; a<n_actions; ++a) {
+                if (fabs(separate.Q[mu](s, a) - value_iteration.getValue(s, a)) > tolerance) {
+                    printf ("ERROR: MDP %d, state %d, action %d: %f %f\n",
+                            mu, s, a, separate.Q[mu](s, a), value_iteration.getValue(s, a));
+                    n_errors++;
+                }
+            }
+        }
+    }
+
+    // Each MDP must meet the threshold a separate ValueIteration
+    // would, so it must be at least as close to its fixed point.
+    real threshold = 1e-2;
+    MultiMDPValueIteration coarse(w, mdp_list, gamma);
+    coarse.ComputeSeparateStateValues(threshold, -1);
+    for (int mu=0; mu<n_mdps; ++mu) {
+        ValueIteration value_iteration(mdp_list[mu], gamma);
+        value_iteration.ComputeStateValuesStandard(threshold, 100000);
+        real error = 0.0;
+        real coarse_error = 0.0;
+        for (int s=0; s<n_states; ++s) {
+            error = std::max(error, fabs(value_iteration.getValue(s) - separate.V[mu](s)));
+            coarse_error = std::max(coarse_error, fabs(coarse.V[mu](s) - separate.V[mu](s)));
+        }
+        if (coarse_error > error + tolerance) {
+            printf ("ERROR: threshold %g, MDP %d: error %g, separate error %g\n",
+                    threshold, mu, coarse_error, error);
+            n_errors++;
+        }
+    }
+
+    MultiMDPValueIteration shared(w, mdp_list, gamma);
+    shared.ComputeStateValues(1e-10, -1);
+    for (int mu=0; mu<n_mdps; ++mu) {
+        const DiscreteMDP* mdp = mdp_list[mu];
+        for (int s=0; s<n_states; ++s) {
+            for (int a=0; a<n_actions; ++a) {
+                real Q_sa = 0.0;
+                const DiscreteStateSet& next = mdp->getNextStates(s, a);
+                for (DiscreteStateSet::const_iterator i=next.begin(); i!=next.end(); ++i) {
+                    Q_sa += mdp->getTransitionProbability(s, a, *i) * shared.V[mu](*i);
+                }
+                Q_sa = mdp->getExpectedReward(s, a) + gamma * Q_sa;
+                if (fabs(shared.Q[mu](s, a) - Q_sa) > tolerance) {
+                    printf ("ERROR: shared policy, MDP %d, state %d, action %d: %f %f\n",
+                            mu, s, a, shared.Q[mu](s, a), Q_sa);
+                    n_errors++;
+                }
+            }
+        }
+    }
+
+    for (int mu=0; mu<n_mdps; ++mu) {
+        delete mdp_list[mu];
+    }
+    return n_errors;
+}
+
+int main(void)
+{
+    setRandomSeed(1);
+    MersenneTwisterRNG rng;
+    rng.manualSeed(1);
+    RandomMDP random_mdp(64, 4, 0.1, -0.1, -1, 1, &rng, false);
+    DiscreteChain chain(16);
+    DiscreteMDP* mdp = random_mdp.getMDP();
+    DiscreteMDP* chain_mdp = chain.getMDP();
+    DiscreteMDP* frozen_mdp = random_mdp.getMDP();
+    frozen_mdp->Freeze();
+
+    int n_errors = 0;
+    n_errors += parallel_sweep_test(mdp, 0.95, 4);
+    n_errors += parallel_sweep_test(mdp, 0.95, 3);
+    n_errors += parallel_sweep_test(frozen_mdp, 0.95, 4);
+    n_errors += parallel_sweep_test(chain_mdp, 0.99, 4);
+    n_errors += prioritised_test(mdp, 0.95, 1e-3);
+    n_errors += prioritised_test(mdp, 0.95, 1e-6);
+    n_errors += prioritised_test(frozen_mdp, 0.95, 1e-6);
+    n_errors += prioritised_test(chain_mdp, 0.99, 1e-6);
+    n_errors += optimistic_update_test(8, 2, 0.9);
+    n_errors += multi_mdp_test(1, 16, 3, 0.9, &rng);
+    n_errors += multi_mdp_test(8, 16, 3, 0.9, &rng);
+
+    delete mdp;
+    delete chain_mdp;
+    delete frozen_mdp;
+
+    if (n_errors) {
+        printf ("# %d ERRORS found\n", n_errors);
+    } else {
+        printf ("# All tests OK\n");
+    }
+    return n_errors;
+}
+
+#endif
@@ -12,6 +12,9 @@
 #include "BasisSet.h"
 
 RBFBasisSet::RBFBasisSet(const EvenGrid& grid, real scale)
+    : n_dimensions(0),
+      valid_features(false),
+      valid_log_features(false)
 {
     n_bases = 0;
     for (int i=0; i<grid.getNIntervals(); ++i) {
@@ -22,19 +25,26 @@ RBFBasisSet::RBFBasisSet(const EvenGrid& grid, real scale)
 
 RBFBasisSet::~RBFBasisSet()
 {
-    for (uint i=0;  i<centers.size(); ++i) {
-        delete centers[i];
-    }
 }
 
 void RBFBasisSet::AddCenter(const Vector& v, const Vector& b)
 {
-    RBF* rbf = new RBF(v, b);
-    centers.push_back(rbf);
+    if (n_bases == 0) {
+        n_dimensions = v.Size();
+        centers.resize(n_dimensions);
+        widths.resize(n_dimensions);
+    }
+    assert(v.Size() == n_dimensions);
+    assert(b.Size() == n_dimensions);
+    for (int d=0; d<n_dimensions; ++d) {
+        assert(b[d] > 0);
+        centers[d].push_back(v[d]);
+        widths[d].push_back(b[d]);
+    }
     n_bases++;
-    features.Resize(centers.size());
+    features.Resize(n_bases);
     features[n_bases-1] = 0.0;
-    log_features.Resize(centers.size());
+    log_features.Resize(n_bases);
     log_features[n_bases-1] = 0.0;
     valid_features = false;
     valid_log_features = false;
@@ -42,22 +52,42 @@ void RBFBasisSet::AddCenter(const Vector& v, const Vector& b)
 
 void RBFBasisSet::AddCenter(const Vector& v, real b)
 {
-    RBF* rbf = new RBF(v, b);
-    centers.push_back(rbf);
-    n_bases++;
-    features.Resize(centers.size());
-    features[n_bases-1] = 0.0;
-    log_features.Resize(centers.size());
-    log_features[n_bases-1] = 0.0;
-    valid_features = false;
-    valid_log_features = false;
+    assert(b > 0);
+    Vector beta(v.Size());
+    for (int d=0; d<v.Size(); ++d) {
+        beta[d] = b;
+    }
+    AddCenter(v, beta);
+}
+
+/** Compute the exponents \f$r_i = \sum_d ((x_d - c_{id}) / b_{id})^2\f$
+    of all bases at x.
+
+    The inner loop runs over the bases, which are independent, and is
+    vectorised by the compiler.
+ */
+void RBFBasisSet::Exponents(const real* x, real* r) const
+{
+    for (int i=0; i<n_bases; ++i) {
+        r[i] = 0.0;
+    }
+    for (int d=0; d<n_dimensions; ++d) {
+        const real x_d = x[d];
+        const real* c = &centers[d][0];
+        const real* b = &widths[d][0];
+        for (int i=0; i<n_bases; ++i) {
+            real z = (x_d - c[i]) / b[i];
+            r[i] += z * z;
+        }
+    }
 }
 
 void RBFBasisSet::logEvaluate(const Vector& x) const
 {
+    assert(x.Size() == n_dimensions);
+    Exponents(x.x, log_features.x);
     real log_sum = LOG_ZERO;
     for (int i=0; i<n_bases; ++i) {
-        log_features[i] = centers[i]->logEvaluate(x);
         log_sum = logAdd(log_features[i], log_sum);
     }
     for (int i=0; i<n_bases; ++i) {
@@ -78,10 +108,39 @@ void RBFBasisSet::logEvaluate(const Vector& x) const
 
 void RBFBasisSet::Evaluate(const Vector& x) const
 {
+    assert(x.Size() == n_dimensions);
+    real* f = features.x;
+    Exponents(x.x, f);
     for(int i = 0; i<n_bases; ++i){
-        features[i] = centers[i]->Evaluate(x);
+        f[i] = exp(-0.5 * f[i]);
     }
     valid_log_features = false;
     valid_features = true;
 }
 
+/** Evaluate the features of a batch of points.
+
+    Row t of Phi is set to the features at row t of X, as would be
+    returned by F() after Evaluate(). The features stored in the basis
+    set itself are not changed.
+ */
+void RBFBasisSet::Evaluate(const Matrix& X, Matrix& Phi) const
+{
+    assert(X.Columns() == n_dimensions);
+    int T = X.Rows();
+    if (Phi.Rows() != T || Phi.Columns() != n_bases) {
+        Phi.Resize(T, n_bases);
+    }
+    Vector x(n_dimensions);
+    Vector phi(n_bases);
+    for (int t=0; t<T; ++t) {
+        for (int d=0; d<n_dimensions; ++d) {
+            x.x[d] = X(t, d);
+        }
+        Exponents(x.x, phi.x);
+        for (int i=0; i<n_bases; ++i) {
+            phi.x[i] = exp(-0.5 * phi.x[i]);
+        }
+        Phi.setRow(t, phi);
+    }
+}
@@ -15,6 +15,8 @@
 #include <vector>
 #include <cassert>
 #include "Vector.h"
+#include "FixedVector.h"
+#include "Matrix.h"
 #include "Grid.h"
 
 /** A simple radial basis function */
@@ -41,32 +43,47 @@ public:
     /// Get the density at point x
     real Evaluate(const Vector& x)
     {
-        Vector d = pow((x - center)/beta, 2.0);
-        real r = d.Sum();
+        assert(x.Size() == center.Size());
+        real r = FixedScaledSquareNorm(x.x, center.x, beta.x, x.Size());
         return exp(-0.5*r);
     }
     /// Evaluate the log density
     real logEvaluate(const Vector& x)
     {
-        Vector d = pow((x - center)/beta, 2.0);
-
-        return d.Sum();
+        assert(x.Size() == center.Size());
+        return FixedScaledSquareNorm(x.x, center.x, beta.x, x.Size());
         //    return (-beta) * EuclideanNorm(&x, &center);		
     }
 };
 
+/** A set of radial basis functions.
+
+    The centers and widths are stored by dimension rather than by
+    basis, so that the exponents of all bases are computed together in
+    one loop over the bases per dimension. These loops have no
+    dependencies between bases, so the compiler vectorises them with
+    whatever instruction set is enabled (e.g. AVX2 with -march=native,
+    SSE2 by default). Each basis still sums its dimensions in order, so
+    the features agree with those of RBF to within 1e-12. They are not
+    guaranteed to be equal bit for bit, since the compiler may contract
+    the two loops into fused multiply-adds differently.
+ */
 class RBFBasisSet
 {
 protected:
-    std::vector<RBF*> centers;
+    int n_dimensions;
+    std::vector<std::vector<real> > centers; ///< centers[d][i]: dimension d of the center of basis i
+    std::vector<std::vector<real> > widths; ///< widths[d][i]: width of basis i along dimension d
 
     mutable Vector log_features;
     mutable Vector features;
     mutable bool valid_features;
     mutable bool valid_log_features;
     int n_bases;
+    void Exponents(const real* x, real* r) const;
 public:
     RBFBasisSet() :
+        n_dimensions(0),
         valid_features(false),
         valid_log_features(false),
         n_bases(0)
@@ -77,6 +94,7 @@ public:
     void AddCenter(const Vector& v, real b);
     void Evaluate(const Vector& x) const;
     void logEvaluate(const Vector& x) const;
+    void Evaluate(const Matrix& X, Matrix& Phi) const;
     int size()
     {
         return n_bases;
@@ -10,6 +10,7 @@
  ***************************************************************************/
 
 #include "CoverTree.h"
+#include "ParallelFor.h"
 
 /// Constructor needs a point and a level
 CoverTree::Node::Node (const CoverTree& tree_, 
@@ -365,8 +366,7 @@ const std::vector< std::pair<int,real> > CoverTree::ExternalBasisCreation(const
       //    printf("Index = %d  === Weight = %f\n",path_node->GetSamplingIndex(), path_data.second);
       path_data.first	 = path_node->GetBasisIndex();
       real beta = pow(2.0, (real)path_node->level);
-      Vector d = pow((state - path_node->point)/beta, 2.0);
-      real r = d.Sum();
+      real r = ((Lazy(state) - path_node->point)/beta).SquareNorm();
       //real d = EuclideanNorm(&x, &center);
       path_data.second = exp(-0.5*r);
       //			path_data.second = 1.0;
@@ -732,6 +732,31 @@ const CoverTree::Node* CoverTree::NearestNeighbour(const Vector& query_point) co
   //	printf("Min dist: %f\n", val.second);
   return val.first;
 }
+/** Find the nearest neighbour of each row of X.
+
+    The i-th entry of indices is the index of the node nearest to the
+    i-th query point, and that of distances its distance. The queries
+    are split among n_threads threads (<= 0: all cores), which only
+    read the tree. For an empty tree, all indices are -1.
+ */
+void CoverTree::NearestNeighbours(const Matrix& X, std::vector<int>& indices, std::vector<real>& distances, int n_threads) const
+{
+  int N = X.Rows();
+  indices.assign(N, -1);
+  distances.assign(N, INF);
+  if (!root) {
+    return;
+  }
+  ParallelFor(N, n_threads,
+              [&](int begin, int end, int block) {
+                for (int i=begin; i<end; ++i) {
+                  Vector x = X.getRow(i);
+                  std::pair<const CoverTree::Node*, real> val = root->NearestNeighbour(x, root->distanceTo(x));
+                  indices[i] = val.first->GetIndex();
+                  distances[i] = val.second;
+                }
+              });
+}
 CoverTree::Node* CoverTree::FindNearestNeighbour(const Vector& query_point) const
 {
 #ifdef DEBUG_COVER_TREE_NN
@@ -758,7 +783,7 @@ const CoverTree::Node* CoverTree::SelectedNearestNeighbour(const Vector& query_p
   }
   return found;
 }
-const Vector CoverTree::GenerateState(const Vector& query_point) const
+Vector CoverTree::GenerateState(const Vector& query_point) const
 {
   const Node* found	= SelectedNearestNeighbour(query_point);
   Vector phi = BasisCreation(query_point);
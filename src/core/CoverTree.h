@@ -285,8 +285,9 @@ class CoverTree
 		Node*		Insert(const Vector& new_point, const Vector& next_state, const real& reward, const bool& absorb = false, void* obj = NULL);
 		
 		const Node*  	NearestNeighbour(const Vector& query_point) const;
+		void		NearestNeighbours(const Matrix& X, std::vector<int>& indices, std::vector<real>& distances, int n_threads = 1) const;
 		const Node*  	SelectedNearestNeighbour(const Vector& query_point) const;
-		const Vector	GenerateState(const Vector& query_point) const;
+		Vector	GenerateState(const Vector& query_point) const;
 		const real   	GenerateReward(const Vector& query_point) const;
 		const real    GetValueFunction(const Vector& query_point) const;
 		const void    SetValueFunction(const Vector& query_point, const real& q);
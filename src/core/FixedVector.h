@@ -10,3 +10,420 @@
  *                                                                         *
  ***************************************************************************/
 
+#ifndef FIXED_VECTOR_H
+#define FIXED_VECTOR_H
+
+#include "real.h"
+#include "Vector.h"
+#include <cassert>
+#include <cmath>
+
+/**
+   \ingroup MathGroup
+*/
+/*@{*/
+
+/**
+    \file FixedVector.h
+
+    \brief Vectors and matrices with a compile-time dimension.
+
+    The state spaces of the continuous environments have between two
+    and six dimensions. For such small vectors, the loop overhead and
+    bounds checking of Vector cost more than the arithmetic itself.
+    FixedVector and FixedMatrix keep their elements inline, and all
+    their loops are unrolled at compile time through FixedLoop.
+
+    Code that only knows the dimension at run time, such as RBF or
+    void_KDTree, can still use the unrolled kernels on raw data through
+    FixedSquareNorm(), FixedL1Norm() and the like. These select the
+    unrolled version for 2 to FIXED_DIMENSION_MAX dimensions and fall
+    back to a plain loop otherwise. All kernels sum from the first
+    element to the last, exactly like the loops in MathFunctions.cc,
+    so they give identical results.
+*/
+
+/// Largest dimension for which the dispatching kernels are unrolled.
+#define FIXED_DIMENSION_MAX 6
+
+/// Loops over N elements, unrolled by recursion on N.
+template <int N>
+struct FixedLoop
+{
+    /// sum + \f$\sum_i a_i b_i\f$
+    static real Dot(const real* a, const real* b, real sum = 0)
+    {
+        return FixedLoop<N-1>::Dot(a + 1, b + 1, sum + a[0] * b[0]);
+    }
+    /// sum + \f$\sum_i (a_i - b_i)^2\f$
+    static real SquareNorm(const real* a, const real* b, real sum = 0)
+    {
+        real d = a[0] - b[0];
+        return FixedLoop<N-1>::SquareNorm(a + 1, b + 1, sum + d * d);
+    }
+    /// sum + \f$\sum_i |a_i - b_i|\f$
+    static real L1Norm(const real* a, const real* b, real sum = 0)
+    {
+        return FixedLoop<N-1>::L1Norm(a + 1, b + 1, sum + fabs(a[0] - b[0]));
+    }
+    /// sum + \f$\sum_i ((x_i - c_i) / s_i)^2\f$, the exponent of an RBF.
+    static real ScaledSquareNorm(const real* x, const real* c, const real* s,
+                                 real sum = 0)
+    {
+        real d = (x[0] - c[0]) / s[0];
+        return FixedLoop<N-1>::ScaledSquareNorm(x + 1, c + 1, s + 1, sum + d * d);
+    }
+};
+
+template <>
+struct FixedLoop<0>
+{
+    static real Dot(const real* a, const real* b, real sum = 0)
+    {
+        return sum;
+    }
+    static real SquareNorm(const real* a, const real* b, real sum = 0)
+    {
+        return sum;
+    }
+    static real L1Norm(const real* a, const real* b, real sum = 0)
+    {
+        return sum;
+    }
+    static real ScaledSquareNorm(const real* x, const real* c, const real* s,
+                                 real sum = 0)
+    {
+        return sum;
+    }
+};
+
+/// The cases of a switch on a dimension n, calling the unrolled kernel.
+#define FIXED_DIMENSION_CASES(KERNEL, ARGUMENTS)        \
+    case 2: return FixedLoop<2>::KERNEL ARGUMENTS;      \
+    case 3: return FixedLoop<3>::KERNEL ARGUMENTS;      \
+    case 4: return FixedLoop<4>::KERNEL ARGUMENTS;      \
+    case 5: return FixedLoop<5>::KERNEL ARGUMENTS;      \
+    case 6: return FixedLoop<6>::KERNEL ARGUMENTS;
+
+/// Return \f$\sum_i^n a_i b_i\f$
+inline real FixedDot(const real* a, const real* b, int n)
+{
+    switch (n) {
+        FIXED_DIMENSION_CASES(Dot, (a, b));
+    }
+    real sum = 0;
+    for (int i=0; i<n; ++i) {
+        sum += a[i] * b[i];
+    }
+    return sum;
+}
+
+/// Return \f$\sum_i^n (a_i - b_i)^2\f$
+inline real FixedSquareNorm(const real* a, const real* b, int n)
+{
+    switch (n) {
+        FIXED_DIMENSION_CASES(SquareNorm, (a, b));
+    }
+    real sum = 0;
+    for (int i=0; i<n; ++i) {
+        real d = a[i] - b[i];
+        sum += d * d;
+    }
+    return sum;
+}
+
+/// Return \f$\sum_i^n |a_i - b_i|\f$
+inline real FixedL1Norm(const real* a, const real* b, int n)
+{
+    switch (n) {
+        FIXED_DIMENSION_CASES(L1Norm, (a, b));
+    }
+    real sum = 0;
+    for (int i=0; i<n; ++i) {
+        sum += fabs(a[i] - b[i]);
+    }
+    return sum;
+}
+
+/// Return \f$\sum_i^n ((x_i - c_i) / s_i)^2\f$
+inline real FixedScaledSquareNorm(const real* x, const real* c, const real* s, int n)
+{
+    switch (n) {
+        FIXED_DIMENSION_CASES(ScaledSquareNorm, (x, c, s));
+    }
+    real sum = 0;
+    for (int i=0; i<n; ++i) {
+        real d = (x[i] - c[i]) / s[i];
+        sum += d * d;
+    }
+    return sum;
+}
+
+#undef FIXED_DIMENSION_CASES
+
+/** An N-dimensional vector, with N known at compile time.
+
+    The elements are stored inline, so a FixedVector never allocates,
+    and element access is only checked by assertions.
+ */
+template <int N>
+class FixedVector
+{
+public:
+    real x[N];
+    /// A zero vector
+    FixedVector()
+    {
+        for (int i=0; i<N; ++i) {
+            x[i] = 0;
+        }
+    }
+    /// Copy N elements from y
+    explicit FixedVector(const real* y)
+    {
+        for (int i=0; i<N; ++i) {
+            x[i] = y[i];
+        }
+    }
+    /// Copy a Vector, which must have N elements
+    explicit FixedVector(const Vector& v)
+    {
+        assert(v.Size() == N);
+        for (int i=0; i<N; ++i) {
+            x[i] = v.x[i];
+        }
+    }
+    static int Size()
+    {
+        return N;
+    }
+    real& operator[] (int i)
+    {
+        assert(i >= 0 && i < N);
+        return x[i];
+    }
+    const real& operator[] (int i) const
+    {
+        assert(i >= 0 && i < N);
+        return x[i];
+    }
+    real& operator() (int i)
+    {
+        return (*this)[i];
+    }
+    const real& operator() (int i) const
+    {
+        return (*this)[i];
+    }
+    /// Copy into a (dynamically sized) Vector
+    Vector getVector() const
+    {
+        Vector v(N);
+        for (int i=0; i<N; ++i) {
+            v.x[i] = x[i];
+        }
+        return v;
+    }
+    /// Copy into an existing Vector of size N
+    void CopyTo(Vector& v) const
+    {
+        assert(v.Size() == N);
+        for (int i=0; i<N; ++i) {
+            v.x[i] = x[i];
+        }
+    }
+    FixedVector& operator+= (const FixedVector& rhs)
+    {
+        for (int i=0; i<N; ++i) {
+            x[i] += rhs.x[i];
+        }
+        return *this;
+    }
+    FixedVector& operator-= (const FixedVector& rhs)
+    {
+        for (int i=0; i<N; ++i) {
+            x[i] -= rhs.x[i];
+        }
+        return *this;
+    }
+    FixedVector& operator*= (real rhs)
+    {
+        for (int i=0; i<N; ++i) {
+            x[i] *= rhs;
+        }
+        return *this;
+    }
+    FixedVector operator+ (const FixedVector& rhs) const
+    {
+        FixedVector lhs(*this);
+        return lhs += rhs;
+    }
+    FixedVector operator- (const FixedVector& rhs) const
+    {
+        FixedVector lhs(*this);
+        return lhs -= rhs;
+    }
+    FixedVector operator* (real rhs) const
+    {
+        FixedVector lhs(*this);
+        return lhs *= rhs;
+    }
+    real SquareNorm() const
+    {
+        return FixedLoop<N>::Dot(x, x);
+    }
+    real L2Norm() const
+    {
+        return sqrt(SquareNorm());
+    }
+};
+
+/// Return \f$a' b\f$
+template <int N>
+inline real Product(const FixedVector<N>& a, const FixedVector<N>& b)
+{
+    return FixedLoop<N>::Dot(a.x, b.x);
+}
+
+/// Return \f$\|a-b\|^2\f$
+template <int N>
+inline real SquareNorm(const FixedVector<N>& a, const FixedVector<N>& b)
+{
+    return FixedLoop<N>::SquareNorm(a.x, b.x);
+}
+
+/// Return \f$\|a-b\|\f$
+template <int N>
+inline real EuclideanNorm(const FixedVector<N>& a, const FixedVector<N>& b)
+{
+    return sqrt(FixedLoop<N>::SquareNorm(a.x, b.x));
+}
+
+/// Return \f$\|a-b\|_1\f$
+template <int N>
+inline real L1Norm(const FixedVector<N>& a, const FixedVector<N>& b)
+{
+    return FixedLoop<N>::L1Norm(a.x, b.x);
+}
+
+/** An R-by-C matrix, with the dimensions known at compile time.
+
+    The data is stored inline in row-major order.
+ */
+template <int R, int C>
+class FixedMatrix
+{
+public:
+    real x[R * C];
+    /// A zero matrix
+    FixedMatrix()
+    {
+        for (int i=0; i<R*C; ++i) {
+            x[i] = 0;
+        }
+    }
+    /// The identity matrix
+    static FixedMatrix Unity()
+    {
+        FixedMatrix A;
+        for (int i=0; i<R && i<C; ++i) {
+            A.x[i * C + i] = 1;
+        }
+        return A;
+    }
+    static int Rows()
+    {
+        return R;
+    }
+    static int Columns()
+    {
+        return C;
+    }
+    real& operator() (int i, int j)
+    {
+        assert(i >= 0 && i < R && j >= 0 && j < C);
+        return x[i * C + j];
+    }
+    const real& operator() (int i, int j) const
+    {
+        assert(i >= 0 && i < R && j >= 0 && j < C);
+        return x[i * C + j];
+    }
+    FixedVector<C> getRow(int i) const
+    {
+        assert(i >= 0 && i < R);
+        return FixedVector<C>(&x[i * C]);
+    }
+    void setRow(int i, const FixedVector<C>& v)
+    {
+        assert(i >= 0 && i < R);
+        for (int j=0; j<C; ++j) {
+            x[i * C + j] = v.x[j];
+        }
+    }
+    /// Matrix-vector product
+    FixedVector<R> operator* (const FixedVector<C>& v) const
+    {
+        FixedVector<R> y;
+        for (int i=0; i<R; ++i) {
+            y.x[i] = FixedLoop<C>::Dot(&x[i * C], v.x);
+        }
+        return y;
+    }
+    /// Matrix product
+    template <int K>
+    FixedMatrix<R, K> operator* (const FixedMatrix<C, K>& rhs) const
+    {
+        FixedMatrix<R, K> lhs;
+        for (int i=0; i<R; ++i) {
+            for (int k=0; k<C; ++k) {
+                real a = x[i * C + k];
+                for (int j=0; j<K; ++j) {
+                    lhs.x[i * K + j] += a * rhs.x[k * K + j];
+                }
+            }
+        }
+        return lhs;
+    }
+    FixedMatrix& operator+= (const FixedMatrix& rhs)
+    {
+        for (int i=0; i<R*C; ++i) {
+            x[i] += rhs.x[i];
+        }
+        return *this;
+    }
+    FixedMatrix& operator*= (real rhs)
+    {
+        for (int i=0; i<R*C; ++i) {
+            x[i] *= rhs;
+        }
+        return *this;
+    }
+    FixedMatrix operator+ (const FixedMatrix& rhs) const
+    {
+        FixedMatrix lhs(*this);
+        return lhs += rhs;
+    }
+    FixedMatrix operator* (real rhs) const
+    {
+        FixedMatrix lhs(*this);
+        return lhs *= rhs;
+    }
+};
+
+/// Return the transpose of A
+template <int R, int C>
+inline FixedMatrix<C, R> Transpose(const FixedMatrix<R, C>& A)
+{
+    FixedMatrix<C, R> B;
+    for (int i=0; i<R; ++i) {
+        for (int j=0; j<C; ++j) {
+            B.x[j * R + i] = A.x[i * C + j];
+        }
+    }
+    return B;
+}
+
+/*@}*/
+
+#endif
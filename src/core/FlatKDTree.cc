@@ -0,0 +1,683 @@
+/* -*- Mode: C++; -*- */
+/***************************************************************************
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ ***************************************************************************/
+
+#include "FlatKDTree.h"
+#include "FixedVector.h"
+#include "ParallelFor.h"
+#include <algorithm>
+#include <stdexcept>
+
+/// Keep (d2, i) if it is among the K closest points so far.
+void KNNHeap::AddPerhaps(real d2, int i)
+{
+    if (!Full()) {
+        heap.push_back(std::make_pair(d2, i));
+        std::push_heap(heap.begin(), heap.end());
+    } else if (d2 < heap.front().first) {
+        std::pop_heap(heap.begin(), heap.end());
+        heap.back() = std::make_pair(d2, i);
+        std::push_heap(heap.begin(), heap.end());
+    }
+}
+
+/// Copy the points kept into neighbours, sorted by increasing distance.
+void KNNHeap::Sorted(std::vector<std::pair<real, int> >& neighbours)
+{
+    neighbours = heap;
+    std::sort_heap(neighbours.begin(), neighbours.end());
+}
+
+/// Add a subtree, with distances offset to its cell, to the queue.
+void KNNBranchQueue::Push(real d2, int block, int node, const real* offset)
+{
+    Branch branch;
+    branch.d2 = d2;
+    branch.block = block;
+    branch.node = node;
+    branch.offset = offsets.size();
+    offsets.insert(offsets.end(), offset, offset + n_dimensions);
+    branches.push_back(branch);
+    std::push_heap(branches.begin(), branches.end());
+}
+
+/// Remove the closest subtree, copying its distances into offset.
+KNNBranchQueue::Branch KNNBranchQueue::Pop(real* offset)
+{
+    std::pop_heap(branches.begin(), branches.end());
+    Branch branch = branches.back();
+    branches.pop_back();
+    for (int j=0; j<n_dimensions; ++j) {
+        offset[j] = offsets[branch.offset + j];
+    }
+    if (branches.size() == 0) {
+        offsets.clear();
+    }
+    return branch;
+}
+
+/// Order point indices by a single coordinate
+class FlatKDTreeCompare
+{
+protected:
+    const real* data;
+    int n_dimensions;
+    int dimension;
+public:
+    FlatKDTreeCompare(const real* data_, int n_dimensions_, int dimension_)
+        : data(data_), n_dimensions(n_dimensions_), dimension(dimension_)
+    {
+    }
+    bool operator() (int i, int j) const
+    {
+        return data[i * n_dimensions + dimension] < data[j * n_dimensions + dimension];
+    }
+};
+
+/** Build the tree for a set of points.
+
+    \param data the coordinates of all points, n_dimensions per point.
+    \param points the indices of the points to put in this tree.
+    \param bucket_size the maximum number of points in a leaf.
+ */
+void FlatKDTreeBlock::Build(const std::vector<real>& data,
+                            const std::vector<int>& points,
+                            int bucket_size)
+{
+    assert(bucket_size > 0);
+    index = points;
+    nodes.clear();
+    nodes.reserve(4 * index.size() / bucket_size + 1);
+    if (index.size() > 0) {
+        BuildNode(data, 0, index.size(), bucket_size);
+    }
+    coords.resize(index.size() * n_dimensions);
+    for (uint i=0; i<index.size(); ++i) {
+        for (int j=0; j<n_dimensions; ++j) {
+            coords[i * n_dimensions + j] = data[index[i] * n_dimensions + j];
+        }
+    }
+}
+
+/** Build the subtree for points [begin, end) and return its node.
+
+    The points are split at the median of the dimension with the
+    largest spread, so the tree is balanced.
+ */
+int FlatKDTreeBlock::BuildNode(const std::vector<real>& data,
+                               int begin, int end, int bucket_size)
+{
+    int n = nodes.size();
+    Node node;
+    node.begin = begin;
+    node.end = end;
+    node.dimension = -1;
+    node.upper = -1;
+    node.split = 0;
+    nodes.push_back(node);
+    if (end - begin <= bucket_size) {
+        return n;
+    }
+
+    int dimension = 0;
+    real max_spread = 0;
+    for (int j=0; j<n_dimensions; ++j) {
+        real x_min = data[index[begin] * n_dimensions + j];
+        real x_max = x_min;
+        for (int i=begin + 1; i<end; ++i) {
+            real x_ij = data[index[i] * n_dimensions + j];
+            x_min = std::min(x_min, x_ij);
+            x_max = std::max(x_max, x_ij);
+        }
+        if (x_max - x_min > max_spread) {
+            max_spread = x_max - x_min;
+            dimension = j;
+        }
+    }
+    if (max_spread <= 0) {
+        return n; // all points are the same
+    }
+
+    int middle = (begin + end) / 2;
+    std::nth_element(index.begin() + begin,
+                     index.begin() + middle,
+                     index.begin() + end,
+                     FlatKDTreeCompare(&data[0], n_dimensions, dimension));
+    nodes[n].dimension = dimension;
+    nodes[n].split = data[index[middle] * n_dimensions + dimension];
+    BuildNode(data, begin, middle, bucket_size);
+    int upper = BuildNode(data, middle, end, bucket_size);
+    nodes[n].upper = upper;
+    return n;
+}
+
+/** Search node n for the K nearest neighbours of x.
+
+    offset holds, for each dimension, the distance from x to the cell
+    of the node along that dimension, and d2 is the sum of their
+    squares. This is a lower bound on the squared distance from x to
+    any point in the cell.
+ */
+void FlatKDTreeBlock::Search(int n, const real* x, real* offset, real d2,
+                             KNNHeap& heap) const
+{
+    const Node& node = nodes[n];
+    if (node.dimension < 0) {
+        for (int i=node.begin; i<node.end; ++i) {
+            heap.AddPerhaps(FixedSquareNorm(x, &coords[i * n_dimensions], n_dimensions),
+                            index[i]);
+        }
+        return;
+    }
+    int a = node.dimension;
+    real delta = x[a] - node.split;
+    int first = n + 1;
+    int second = node.upper;
+    if (delta >= 0) {
+        std::swap(first, second);
+    }
+    Search(first, x, offset, d2, heap);
+
+    real old_offset = offset[a];
+    real d2_second = d2 - old_offset * old_offset + delta * delta;
+    if (d2_second < heap.Bound()) {
+        offset[a] = delta;
+        Search(second, x, offset, d2_second, heap);
+        offset[a] = old_offset;
+    }
+}
+
+/// Search node n for all points within squared distance r2 of x.
+void FlatKDTreeBlock::SearchRadius(int n, const real* x, real* offset, real d2, real r2,
+                                   std::vector<std::pair<real, int> >& neighbours) const
+{
+    const Node& node = nodes[n];
+    if (node.dimension < 0) {
+        for (int i=node.begin; i<node.end; ++i) {
+            real d2_i = FixedSquareNorm(x, &coords[i * n_dimensions], n_dimensions);
+            if (d2_i <= r2) {
+                neighbours.push_back(std::make_pair(d2_i, index[i]));
+            }
+        }
+        return;
+    }
+    int a = node.dimension;
+    real delta = x[a] - node.split;
+    int first = n + 1;
+    int second = node.upper;
+    if (delta >= 0) {
+        std::swap(first, second);
+    }
+    SearchRadius(first, x, offset, d2, r2, neighbours);
+
+    real old_offset = offset[a];
+    real d2_second = d2 - old_offset * old_offset + delta * delta;
+    if (d2_second <= r2) {
+        offset[a] = delta;
+        SearchRadius(second, x, offset, d2_second, r2, neighbours);
+        offset[a] = old_offset;
+    }
+}
+
+/// Add the nearest neighbours of x in this tree to the heap.
+void FlatKDTreeBlock::KNearestNeighbours(const real* x, KNNHeap& heap, real* offset) const
+{
+    if (nodes.size() == 0) {
+        return;
+    }
+    for (int j=0; j<n_dimensions; ++j) {
+        offset[j] = 0;
+    }
+    Search(0, x, offset, 0, heap);
+}
+
+/** Go down from node n to the closest leaf, and search it.
+
+    At each node, the other child is added to the queue, unless its
+    distance bound times factor already exceeds that of the K-th
+    neighbour. The queue entries refer to this tree as block.
+ */
+void FlatKDTreeBlock::Descend(int block, int n, const real* x, real* offset, real d2,
+                              real factor, KNNHeap& heap, KNNBranchQueue& queue,
+                              KNNSearchStatistics& statistics) const
+{
+    while (nodes[n].dimension >= 0) {
+        const Node& node = nodes[n];
+        statistics.n_nodes++;
+        int a = node.dimension;
+        real delta = x[a] - node.split;
+        int first = n + 1;
+        int second = node.upper;
+        if (delta >= 0) {
+            std::swap(first, second);
+        }
+        real old_offset = offset[a];
+        real d2_second = d2 - old_offset * old_offset + delta * delta;
+        if (d2_second * factor < heap.Bound()) {
+            offset[a] = delta;
+            queue.Push(d2_second, block, second, offset);
+            offset[a] = old_offset;
+        }
+        n = first;
+    }
+    const Node& leaf = nodes[n];
+    statistics.n_nodes++;
+    statistics.n_leaves++;
+    statistics.n_points += leaf.end - leaf.begin;
+    for (int i=leaf.begin; i<leaf.end; ++i) {
+        heap.AddPerhaps(FixedSquareNorm(x, &coords[i * n_dimensions], n_dimensions),
+                        index[i]);
+    }
+}
+
+/// Append all points of the tree within squared distance r2 of x.
+void FlatKDTreeBlock::NeighboursWithinRadius(const real* x, real r2, real* offset,
+                                             std::vector<std::pair<real, int> >& neighbours) const
+{
+    if (nodes.size() == 0) {
+        return;
+    }
+    for (int j=0; j<n_dimensions; ++j) {
+        offset[j] = 0;
+    }
+    SearchRadius(0, x, offset, 0, r2, neighbours);
+}
+
+/// Create an empty tree
+void_FlatKDTree::void_FlatKDTree(int n_dimensions_, int bucket_size_)
+    : n_dimensions(n_dimensions_),
+      bucket_size(bucket_size_)
+{
+    assert(n_dimensions > 0);
+    assert(bucket_size > 0);
+}
+
+/// Remove all points
+void void_FlatKDTree::Clear()
+{
+    data.clear();
+    objects.clear();
+    blocks.clear();
+}
+
+/** Build the tree from scratch.
+
+    \param X the points, one per row.
+    \param objects_ the object associated with each point.
+
+    This replaces any existing points. Point i is row i of X.
+ */
+void void_FlatKDTree::Build(const Matrix& X, const std::vector<const void*>& objects_)
+{
+    if (X.Columns() != n_dimensions || X.Rows() != (int) objects_.size()) {
+        throw std::domain_error("void_FlatKDTree::Build: size mismatch");
+    }
+    Clear();
+    int N = X.Rows();
+    data.resize(N * n_dimensions);
+    std::vector<int> points(N);
+    for (int i=0; i<N; ++i) {
+        for (int j=0; j<n_dimensions; ++j) {
+            data[i * n_dimensions + j] = X(i, j);
+        }
+        points[i] = i;
+    }
+    objects = objects_;
+    blocks.push_back(FlatKDTreeBlock(n_dimensions));
+    blocks.back().Build(data, points, bucket_size);
+}
+
+/** Add a point, with an associated object.
+
+    The point goes into a new tree, which is merged with the existing
+    trees that are not larger than it. Tree sizes thus stay strictly
+    decreasing, like the bits of a binary counter.
+ */
+void void_FlatKDTree::AddVector(const Vector& x, const void* object)
+{
+    assert(x.Size() == n_dimensions);
+    std::vector<int> points(1, size());
+    for (int j=0; j<n_dimensions; ++j) {
+        data.push_back(x(j));
+    }
+    objects.push_back(object);
+    while (blocks.size() > 0 && blocks.back().size() <= (int) points.size()) {
+        const std::vector<int>& block_points = blocks.back().Points();
+        points.insert(points.end(), block_points.begin(), block_points.end());
+        blocks.pop_back();
+    }
+    blocks.push_back(FlatKDTreeBlock(n_dimensions));
+    blocks.back().Build(data, points, bucket_size);
+}
+
+/// Add the nearest neighbours of x in all trees to the heap.
+void void_FlatKDTree::Search(const real* x, KNNHeap& heap, real* offset) const
+{
+    for (uint k=0; k<blocks.size(); ++k) {
+        blocks[k].KNearestNeighbours(x, heap, offset);
+    }
+}
+
+/** Best-bin-first search of all trees.
+
+    The subtrees are visited in order of their distance bound, until
+    either the closest remaining one can not improve the K-th neighbour
+    by more than a factor of \f$1 + \epsilon\f$, or max_leaves
+    leaves have been searched.
+ */
+void void_FlatKDTree::Search(const real* x, const KNNSearchMode& mode, KNNHeap& heap,
+                             KNNBranchQueue& queue, real* offset,
+                             KNNSearchStatistics& statistics) const
+{
+    real factor = (1 + mode.epsilon) * (1 + mode.epsilon);
+    queue.Clear();
+    for (int j=0; j<n_dimensions; ++j) {
+        offset[j] = 0;
+    }
+    for (uint k=0; k<blocks.size(); ++k) {
+        if (blocks[k].size() > 0) {
+            queue.Push(0, k, 0, offset);
+        }
+    }
+    int n_leaves = 0;
+    while (!queue.Empty()
+           && queue.Bound() * factor < heap.Bound()
+           && (mode.max_leaves <= 0 || n_leaves < mode.max_leaves)) {
+        KNNBranchQueue::Branch branch = queue.Pop(offset);
+        blocks[branch.block].Descend(branch.block, branch.node, x, offset, branch.d2,
+                                     factor, heap, queue, statistics);
+        n_leaves++;
+    }
+    statistics.n_queries++;
+}
+
+/// Find the K nearest neighbours to x.
+void void_FlatKDTree::FindKNearestNeighbours(const Vector& x, int K,
+                                             std::vector<std::pair<real, int> >& neighbours) const
+{
+    assert(x.Size() == n_dimensions);
+    neighbours.clear();
+    if (K <= 0) {
+        return;
+    }
+    KNNHeap heap(K);
+    std::vector<real> offset(n_dimensions);
+    Search(x.x, heap, &offset[0]);
+    heap.Sorted(neighbours);
+}
+
+/** Find K neighbours of x, approximately.
+
+    \param x the query point.
+    \param K the number of neighbours.
+    \param mode the accuracy of the search.
+    \param neighbours the neighbours found, sorted by squared distance.
+    \param statistics if not NULL, the work done is added to it.
+ */
+void void_FlatKDTree::FindKNearestNeighbours(const Vector& x, int K, const KNNSearchMode& mode,
+                                             std::vector<std::pair<real, int> >& neighbours,
+                                             KNNSearchStatistics* statistics) const
+{
+    assert(x.Size() == n_dimensions);
+    neighbours.clear();
+    if (K <= 0) {
+        return;
+    }
+    KNNHeap heap(K);
+    KNNBranchQueue queue(n_dimensions);
+    std::vector<real> offset(n_dimensions);
+    KNNSearchStatistics query_statistics;
+    Search(x.x, mode, heap, queue, &offset[0], query_statistics);
+    heap.Sorted(neighbours);
+    if (statistics) {
+        *statistics += query_statistics;
+    }
+}
+
+/** Find the K nearest neighbours of each row of X.
+
+    \param X the query points, one per row.
+    \param K the number of neighbours.
+    \param indices the neighbours of the i-th query, at [i K, (i + 1) K).
+    \param distances the corresponding squared distances.
+    \param n_threads the number of threads to use (<= 0: all cores).
+    \param mode the accuracy of the search.
+    \param statistics if not NULL and the search is approximate, the
+    work done is added to it.
+
+    The queries are split among the threads, each of which uses its
+    own heap. If the tree has fewer than K points, the remaining
+    entries have index -1 and infinite distance.
+ */
+void void_FlatKDTree::FindKNearestNeighbours(const Matrix& X, int K,
+                                             std::vector<int>& indices,
+                                             std::vector<real>& distances,
+                                             int n_threads,
+                                             const KNNSearchMode& mode,
+                                             KNNSearchStatistics* statistics) const
+{
+    if (X.Columns() != n_dimensions) {
+        throw std::domain_error("void_FlatKDTree::FindKNearestNeighbours: dimension mismatch");
+    }
+    int N = X.Rows();
+    K = std::max(K, 0);
+    indices.assign(N * K, -1);
+    distances.assign(N * K, INF);
+    if (K == 0) {
+        return;
+    }
+    bool exact = mode.Exact();
+    std::vector<KNNSearchStatistics> block_statistics(ParallelForBlocks(N, n_threads));
+    ParallelFor(N, n_threads,
+                [&](int begin, int end, int block) {
+                    KNNHeap heap(K);
+                    KNNBranchQueue queue(n_dimensions);
+                    std::vector<real> x(n_dimensions);
+                    std::vector<real> offset(n_dimensions);
+                    std::vector<std::pair<real, int> > neighbours;
+                    for (int i=begin; i<end; ++i) {
+                        for (int j=0; j<n_dimensions; ++j) {
+                            x[j] = X(i, j);
+                        }
+                        heap.Clear();
+                        if (exact) {
+                            Search(&x[0], heap, &offset[0]);
+                        } else {
+                            Search(&x[0], mode, heap, queue, &offset[0],
+                                   block_statistics[block]);
+                        }
+                        heap.Sorted(neighbours);
+                        for (uint k=0; k<neighbours.size(); ++k) {
+                            distances[i * K + k] = neighbours[k].first;
+                            indices[i * K + k] = neighbours[k].second;
+                        }
+                    }
+                });
+    if (statistics) {
+        for (uint k=0; k<block_statistics.size(); ++k) {
+            *statistics += block_statistics[k];
+        }
+    }
+}
+
+/// Find the K nearest neighbours to x by linear search.
+void void_FlatKDTree::FindKNearestNeighboursLinear(const Vector& x, int K,
+                                                   std::vector<std::pair<real, int> >& neighbours) const
+{
+    assert(x.Size() == n_dimensions);
+    neighbours.clear();
+    if (K <= 0) {
+        return;
+    }
+    KNNHeap heap(K);
+    for (int i=0; i<size(); ++i) {
+        heap.AddPerhaps(FixedSquareNorm(x.x, &data[i * n_dimensions], n_dimensions), i);
+    }
+    heap.Sorted(neighbours);
+}
+
+/// Find the nearest neighbour to x, or -1 if the tree is empty.
+int void_FlatKDTree::FindNearestNeighbour(const Vector& x) const
+{
+    std::vector<std::pair<real, int> > neighbours;
+    FindKNearestNeighbours(x, 1, neighbours);
+    if (neighbours.size() == 0) {
+        return -1;
+    }
+    return neighbours[0].second;
+}
+
+/// Find all neighbours within distance r of x.
+void void_FlatKDTree::FindNeighboursWithinRadius(const Vector& x, real r,
+                                                 std::vector<std::pair<real, int> >& neighbours) const
+{
+    assert(x.Size() == n_dimensions);
+    neighbours.clear();
+    if (r < 0) {
+        return;
+    }
+    std::vector<real> offset(n_dimensions);
+    for (uint k=0; k<blocks.size(); ++k) {
+        blocks[k].NeighboursWithinRadius(x.x, r * r, &offset[0], neighbours);
+    }
+    std::sort(neighbours.begin(), neighbours.end());
+}
+
+/** Find the points that matter for a Gaussian kernel sum at x.
+
+    \param x the query point.
+    \param bandwidth the kernel bandwidth \f$b\f$.
+    \param tolerance the relative error allowed (0: all points).
+    \param neighbours the points found, in no particular order.
+    \param weights if not NULL, the weight of each point, by index.
+    \param total_weight the sum of the weights.
+
+    For the kernel \f$k_i = \exp(-d_i^2 / 2b^2)\f$, the sum over the
+    points returned is within a factor \f$1 - \textrm{tolerance}\f$
+    of the sum over all points. If the nearest point is at squared
+    distance \f$d^2\f$, the sum is at least \f$\exp(-d^2 / 2b^2)\f$,
+    so the \f$N\f$ points further away than
+    \f$d^2 + 2b^2 \log(N / \textrm{tolerance})\f$ contribute at most
+    tolerance times the sum, and can be left out. For weighted sums,
+    \f$N\f$ is replaced by the total weight divided by the weight of
+    the nearest point.
+ */
+void void_FlatKDTree::FindKernelNeighbours(const Vector& x, real bandwidth, real tolerance,
+                                           std::vector<std::pair<real, int> >& neighbours,
+                                           const real* weights, real total_weight) const
+{
+    assert(x.Size() == n_dimensions);
+    assert(bandwidth > 0);
+    assert(tolerance >= 0);
+    if (tolerance <= 0) {
+        neighbours.resize(size());
+        for (int i=0; i<size(); ++i) {
+            neighbours[i].first = FixedSquareNorm(x.x, &data[i * n_dimensions], n_dimensions);
+            neighbours[i].second = i;
+        }
+        return;
+    }
+    FindKNearestNeighbours(x, 1, neighbours);
+    if (neighbours.size() == 0) {
+        return;
+    }
+    real mass = (real) size();
+    if (weights) {
+        mass = total_weight / weights[neighbours[0].second];
+    }
+    real r2 = neighbours[0].first
+        + 2 * bandwidth * bandwidth * log(mass / tolerance);
+    neighbours.clear();
+    std::vector<real> offset(n_dimensions);
+    for (uint k=0; k<blocks.size(); ++k) {
+        blocks[k].NeighboursWithinRadius(x.x, r2, &offset[0], neighbours);
+    }
+}
+
+/** The log of a Gaussian kernel sum at x.
+
+    \return \f$\log \sum_i w_i \exp(-d_i^2 / 2b^2)\f$, over the
+    points found by FindKernelNeighbours(), or LOG_ZERO if there are
+    none. If weights is NULL, \f$w_i = 1\f$.
+ */
+real void_FlatKDTree::LogKernelSum(const Vector& x, real bandwidth, real tolerance,
+                                   const real* weights, real total_weight) const
+{
+    std::vector<std::pair<real, int> > neighbours;
+    FindKernelNeighbours(x, bandwidth, tolerance, neighbours, weights, total_weight);
+    if (neighbours.size() == 0) {
+        return LOG_ZERO;
+    }
+    real d2_min = neighbours[0].first;
+    for (uint i=1; i<neighbours.size(); ++i) {
+        d2_min = std::min(d2_min, neighbours[i].first);
+    }
+    real ib2 = 1.0 / (bandwidth * bandwidth);
+    real sum = 0;
+    for (uint i=0; i<neighbours.size(); ++i) {
+        real p_i = exp(-0.5 * (neighbours[i].first - d2_min) * ib2);
+        sum += weights ? weights[neighbours[i].second] * p_i : p_i;
+    }
+    return log(sum) - 0.5 * d2_min * ib2;
+}
+
+/** Greedily pair up close points.
+
+    \param n_pairs the number of pairs wanted.
+    \param pairs the pairs found, closest first.
+    \param K the number of neighbours of each point considered.
+
+    The candidate pairs are each point and its K nearest neighbours.
+    They are taken in order of increasing distance, skipping those with
+    an already paired point, until n_pairs pairs are found. Fewer
+    pairs may be found if K is small.
+ */
+void void_FlatKDTree::PairNearestNeighbours(int n_pairs, std::vector<std::pair<int, int> >& pairs,
+                                            int K) const
+{
+    pairs.clear();
+    int N = size();
+    K = std::min(K + 1, N);
+    if (n_pairs <= 0 || K < 2) {
+        return;
+    }
+    Matrix X(N, n_dimensions);
+    for (int i=0; i<N; ++i) {
+        for (int j=0; j<n_dimensions; ++j) {
+            X(i, j) = data[i * n_dimensions + j];
+        }
+    }
+    std::vector<int> indices;
+    std::vector<real> distances;
+    FindKNearestNeighbours(X, K, indices, distances);
+
+    std::vector<std::pair<real, std::pair<int, int> > > candidates;
+    candidates.reserve(N * (K - 1));
+    for (int i=0; i<N; ++i) {
+        for (int k=0; k<K; ++k) {
+            int j = indices[i * K + k];
+            if (i < j) {
+                candidates.push_back(std::make_pair(distances[i * K + k],
+                                                    std::make_pair(i, j)));
+            }
+        }
+    }
+    std::sort(candidates.begin(), candidates.end());
+
+    std::vector<bool> paired(N, false);
+    for (uint c=0; c<candidates.size() && (int) pairs.size() < n_pairs; ++c) {
+        int i = candidates[c].second.first;
+        int j = candidates[c].second.second;
+        if (!paired[i] && !paired[j]) {
+            paired[i] = true;
+            paired[j] = true;
+            pairs.push_back(candidates[c].second);
+        }
+    }
+}
@@ -0,0 +1,331 @@
+/* -*- Mode: C++; -*- */
+/***************************************************************************
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ ***************************************************************************/
+
+#ifndef FLAT_KD_TREE_H
+#define FLAT_KD_TREE_H
+
+#include "real.h"
+#include "Vector.h"
+#include "Matrix.h"
+#include <vector>
+#include <utility>
+
+/** A bounded max-heap of (squared distance, point) pairs.
+
+    This keeps the K closest points seen so far. The root of the heap
+    is the K-th closest point, so that checking whether a new point
+    should be kept is O(1), and replacing it is O(log K).
+ */
+class KNNHeap
+{
+protected:
+    int K; ///< maximum number of points
+    std::vector<std::pair<real, int> > heap; ///< the heap
+public:
+    KNNHeap(int K_) : K(K_)
+    {
+        heap.reserve(K);
+    }
+    /// Start a new search
+    void Clear()
+    {
+        heap.clear();
+    }
+    /// Whether the heap holds K points
+    bool Full() const
+    {
+        return (int) heap.size() >= K;
+    }
+    /// The largest squared distance kept, or infinity if not full.
+    real Bound() const
+    {
+        return Full() ? heap.front().first : INF;
+    }
+    void AddPerhaps(real d2, int i);
+    void Sorted(std::vector<std::pair<real, int> >& neighbours);
+};
+
+/** Parameters for approximate nearest neighbour search.
+
+    A subtree is skipped when \f$(1 + \epsilon)\f$ times its distance
+    bound exceeds the distance of the K-th neighbour found so far, so
+    the K-th neighbour returned is at most \f$(1 + \epsilon)\f$ times
+    further than the true one. In addition, the search stops after
+    max_leaves leaves, which bounds the time per query, but not the
+    error. The defaults give an exact search.
+ */
+struct KNNSearchMode
+{
+    real epsilon; ///< relative distance error allowed
+    int max_leaves; ///< maximum number of leaves to visit (<= 0: no limit)
+    KNNSearchMode(real epsilon_ = 0, int max_leaves_ = 0)
+        : epsilon(epsilon_), max_leaves(max_leaves_)
+    {
+        assert(epsilon >= 0);
+    }
+    /// Whether the search is exact
+    bool Exact() const
+    {
+        return epsilon <= 0 && max_leaves <= 0;
+    }
+};
+
+/// Counts of the work done by approximate nearest neighbour searches.
+struct KNNSearchStatistics
+{
+    long n_queries; ///< number of queries
+    long n_nodes; ///< number of nodes visited, including leaves
+    long n_leaves; ///< number of leaves visited
+    long n_points; ///< number of distances computed
+    KNNSearchStatistics()
+    {
+        Reset();
+    }
+    void Reset()
+    {
+        n_queries = 0;
+        n_nodes = 0;
+        n_leaves = 0;
+        n_points = 0;
+    }
+    KNNSearchStatistics& operator+= (const KNNSearchStatistics& rhs)
+    {
+        n_queries += rhs.n_queries;
+        n_nodes += rhs.n_nodes;
+        n_leaves += rhs.n_leaves;
+        n_points += rhs.n_points;
+        return *this;
+    }
+};
+
+/** A priority queue of subtrees, closest first.
+
+    This is used for best-bin-first search. Each entry holds a lower
+    bound on the squared distance to the subtree, and the distances to
+    its cell along each dimension, which are needed to bound the
+    distance to its own subtrees.
+ */
+class KNNBranchQueue
+{
+public:
+    /// A subtree still to be searched
+    struct Branch
+    {
+        real d2; ///< lower bound on the squared distance
+        int block; ///< the tree
+        int node; ///< the root of the subtree
+        int offset; ///< position of the distances in offsets
+        /// Order so that the heap has the smallest bound at the top.
+        bool operator< (const Branch& rhs) const
+        {
+            return d2 > rhs.d2;
+        }
+    };
+protected:
+    int n_dimensions; ///< dimensionality of space
+    std::vector<Branch> branches; ///< the heap
+    std::vector<real> offsets; ///< per-dimension distances, for all entries
+public:
+    KNNBranchQueue(int n_dimensions_) : n_dimensions(n_dimensions_)
+    {
+    }
+    void Clear()
+    {
+        branches.clear();
+        offsets.clear();
+    }
+    bool Empty() const
+    {
+        return branches.size() == 0;
+    }
+    /// The smallest distance bound in the queue
+    real Bound() const
+    {
+        return branches.front().d2;
+    }
+    void Push(real d2, int block, int node, const real* offset);
+    Branch Pop(real* offset);
+};
+
+/** A static KD-tree stored in a contiguous array.
+
+    The tree is built in one go from a set of points, by splitting at
+    the median of the widest dimension until at most bucket_size points
+    remain. The nodes are stored in pre-order, so that the lower child
+    of a node immediately follows it. Point coordinates are copied
+    into leaf order, so that a leaf is scanned with sequential memory
+    accesses.
+
+    Queries use the squared Euclidean distance. Subtrees are pruned
+    with the incremental distance bound of Arya and Mount: the squared
+    distance from the query to the cell of a node is kept up to date
+    one coordinate at a time, while descending.
+ */
+class FlatKDTreeBlock
+{
+protected:
+    /// A node covering points [begin, end) of the block
+    struct Node
+    {
+        int begin; ///< first point
+        int end; ///< one past the last point
+        int dimension; ///< split dimension, or -1 for leaves
+        int upper; ///< index of the upper child
+        real split; ///< split value
+    };
+    int n_dimensions; ///< dimensionality of space
+    std::vector<Node> nodes; ///< the nodes, in pre-order
+    std::vector<int> index; ///< point index, in leaf order
+    std::vector<real> coords; ///< point coordinates, in leaf order
+    int BuildNode(const std::vector<real>& data, int begin, int end, int bucket_size);
+    void Search(int n, const real* x, real* offset, real d2, KNNHeap& heap) const;
+    void SearchRadius(int n, const real* x, real* offset, real d2, real r2,
+                      std::vector<std::pair<real, int> >& neighbours) const;
+public:
+    FlatKDTreeBlock(int n_dimensions_) : n_dimensions(n_dimensions_)
+    {
+    }
+    void Build(const std::vector<real>& data, const std::vector<int>& points, int bucket_size);
+    /// Number of points
+    int size() const
+    {
+        return index.size();
+    }
+    /// The points of the block
+    const std::vector<int>& Points() const
+    {
+        return index;
+    }
+    void KNearestNeighbours(const real* x, KNNHeap& heap, real* offset) const;
+    void Descend(int block, int n, const real* x, real* offset, real d2, real factor,
+                 KNNHeap& heap, KNNBranchQueue& queue,
+                 KNNSearchStatistics& statistics) const;
+    void NeighboursWithinRadius(const real* x, real r2, real* offset,
+                                std::vector<std::pair<real, int> >& neighbours) const;
+};
+
+/** A flat KD-tree index with bulk build and incremental insertion.
+
+    Points can be either given all at once with Build(), or added one
+    at a time with AddVector(). In the latter case, the points are kept
+    in a logarithmic number of static trees (FlatKDTreeBlock) of
+    decreasing size: a new point creates a tree of size one, and trees
+    of similar size are merged and rebuilt. Insertion thus costs
+    \f$O(\log^2 n)\f$ amortised time, and queries search \f$O(\log
+    n)\f$ trees.
+
+    Points are identified by their index, in order of insertion. The
+    query results are (squared Euclidean distance, index) pairs,
+    sorted by increasing distance.
+
+    Queries do not modify the tree, so any number of threads may
+    query it at the same time, as long as no points are added.
+
+    Queries with a KNNSearchMode instead visit the subtrees of all
+    trees in order of their distance bound (best-bin-first). This
+    allows approximate searches that trade accuracy for time.
+ */
+class void_FlatKDTree
+{
+protected:
+    int n_dimensions; ///< dimensionality of space
+    int bucket_size; ///< maximum number of points in a leaf
+    std::vector<real> data; ///< point coordinates, by index
+    std::vector<const void*> objects; ///< associated objects, by index
+    std::vector<FlatKDTreeBlock> blocks; ///< trees of decreasing size
+    void Search(const real* x, KNNHeap& heap, real* offset) const;
+    void Search(const real* x, const KNNSearchMode& mode, KNNHeap& heap,
+                KNNBranchQueue& queue, real* offset,
+                KNNSearchStatistics& statistics) const;
+public:
+    void_FlatKDTree(int n_dimensions_, int bucket_size_ = 8);
+    void Build(const Matrix& X, const std::vector<const void*>& objects_);
+    void AddVector(const Vector& x, const void* object);
+    void Clear();
+    int FindNearestNeighbour(const Vector& x) const;
+    void FindKNearestNeighbours(const Vector& x, int K,
+                                std::vector<std::pair<real, int> >& neighbours) const;
+    void FindKNearestNeighbours(const Vector& x, int K, const KNNSearchMode& mode,
+                                std::vector<std::pair<real, int> >& neighbours,
+                                KNNSearchStatistics* statistics = NULL) const;
+    void FindKNearestNeighbours(const Matrix& X, int K,
+                                std::vector<int>& indices,
+                                std::vector<real>& distances,
+                                int n_threads = 1,
+                                const KNNSearchMode& mode = KNNSearchMode(),
+                                KNNSearchStatistics* statistics = NULL) const;
+    void FindKNearestNeighboursLinear(const Vector& x, int K,
+                                      std::vector<std::pair<real, int> >& neighbours) const;
+    void FindNeighboursWithinRadius(const Vector& x, real r,
+                                    std::vector<std::pair<real, int> >& neighbours) const;
+    void FindKernelNeighbours(const Vector& x, real bandwidth, real tolerance,
+                              std::vector<std::pair<real, int> >& neighbours,
+                              const real* weights = NULL, real total_weight = 0) const;
+    real LogKernelSum(const Vector& x, real bandwidth, real tolerance,
+                      const real* weights = NULL, real total_weight = 0) const;
+    void PairNearestNeighbours(int n_pairs, std::vector<std::pair<int, int> >& pairs,
+                               int K = 8) const;
+    /// Number of points
+    int size() const
+    {
+        return objects.size();
+    }
+    /// Number of static trees holding the points
+    int getNumberOfBlocks() const
+    {
+        return blocks.size();
+    }
+    /// Get the i-th point
+    Vector getPoint(int i) const
+    {
+        assert(i >= 0 && i < size());
+        Vector x(n_dimensions);
+        for (int j=0; j<n_dimensions; ++j) {
+            x(j) = data[i * n_dimensions + j];
+        }
+        return x;
+    }
+};
+
+/// This template makes the void* type safe.
+template <typename T>
+class FlatKDTree : public void_FlatKDTree
+{
+public:
+    /// Make a tree for n-dimensional points
+    FlatKDTree(int n, int bucket_size_ = 8) : void_FlatKDTree(n, bucket_size_)
+    {
+    }
+    /// Build the tree from the rows of X, associated with objects_
+    void Build(const Matrix& X, const std::vector<T*>& objects_)
+    {
+        std::vector<const void*> v(objects_.begin(), objects_.end());
+        void_FlatKDTree::Build(X, v);
+    }
+    /// Add a single point with an object
+    void AddVectorObject(const Vector& x, T* object)
+    {
+        AddVector(x, (const void*) object);
+    }
+    /// Get the object of the i-th point
+    T* getObject(int i) const
+    {
+        assert(i >= 0 && i < size());
+        return (T*) objects[i];
+    }
+    /// Find the nearest object, or NULL if the tree is empty
+    T* FindNearestObject(const Vector& x) const
+    {
+        int i = FindNearestNeighbour(x);
+        return (i < 0) ? NULL : getObject(i);
+    }
+};
+
+#endif
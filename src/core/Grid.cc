@@ -90,6 +90,34 @@ K(K_)
     n_intervals = (int) floor(pow(K, n_dimensions));	
 }
 
+/// The interval index of x along n dimensions, on raw data.
+static inline int IntervalIndex(const real* x, const real* lower_bound,
+                                const real* delta, int K, int n)
+{
+    int d = 1;
+    int y = 0;
+    for (int i=0; i<n; ++i) {
+        real dx = (x[i] - lower_bound[i]) / delta[i];
+        int k = (int) floor(dx);
+        if (k >= K) {
+            k = K - 1;
+        } else if (k < 0) {
+            k = 0;
+        }
+        y += d * k;
+        d *= K;
+    }
+    return y;
+}
+
+/// IntervalIndex() for N dimensions, so that the loop is unrolled.
+template <int N>
+static int FixedIntervalIndex(const real* x, const real* lower_bound,
+                              const real* delta, int K)
+{
+    return IntervalIndex(x, lower_bound, delta, K, N);
+}
+
 /** Get the index of the interval containing x.
     
     For any \f$l, u \in R^n\f$ and \f$k \in \{1, 2, \ldots \}\f$, we define the function \f$f(\cdot | k, l, u) : R^n \to \{0, \ldots, k^{n} -1\}\f$:
@@ -105,19 +133,16 @@ K(K_)
  */
 int EvenGrid::getInterval(const Vector& x) const
 {
-    int d = 1;
-    int y = 0;
-
-    for (int i=0; i<n_dimensions; ++i) {
-        real dx = (x[i] - lower_bound[i]) / delta[i];
-        int n = (int) floor(dx);
-        if (n >= K) {
-            n = K - 1;
-        } else if (n < 0) {
-            n = 0;
-        }
-        y += d * n;
-        d *= K;
+    assert(x.Size() == n_dimensions);
+    const real* l = lower_bound.x;
+    int y;
+    switch (n_dimensions) {
+    case 2: y = FixedIntervalIndex<2>(x.x, l, delta.x, K); break;
+    case 3: y = FixedIntervalIndex<3>(x.x, l, delta.x, K); break;
+    case 4: y = FixedIntervalIndex<4>(x.x, l, delta.x, K); break;
+    case 5: y = FixedIntervalIndex<5>(x.x, l, delta.x, K); break;
+    case 6: y = FixedIntervalIndex<6>(x.x, l, delta.x, K); break;
+    default: y = IntervalIndex(x.x, l, delta.x, K, n_dimensions);
     }
     assert(y >= 0 && y < n_intervals);
     return y;
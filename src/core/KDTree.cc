@@ -1,7 +1,17 @@
 #include "KDTree.h"
 #include "Vector.h"
+#include "FixedVector.h"
+#include "ParallelFor.h"
+#include <stdexcept>
 
-#define MY_NORM L1Norm
+/// The distance used by the tree, unrolled for low dimensions
+static inline real KDNorm(const Vector* a, const Vector* b)
+{
+    assert(a->n == b->n);
+    return FixedL1Norm(a->x, b->x, a->n);
+}
+
+#define MY_NORM KDNorm
 
 /// Create a tree
 void_KDTree::void_KDTree(int n) : n_dimensions(n), box_sup(n), box_inf(n), root(NULL)
@@ -25,11 +35,13 @@ void void_KDTree::AddVector(const Vector& x, const void* object)
 {
     if (!root) {
         root = new KDNode(x, 0, box_inf, box_sup, object);
+        root->index = 0;
         node_list.push_back(root);
         return;
     }
     KDNode* node = root->AddVector(x, box_inf, box_sup, object);
     if (node) {
+        node->index = node_list.size();
         node_list.push_back(node);
     } else{
         fprintf(stderr, "Strange: node not added\n");
@@ -115,6 +127,46 @@ OrderedFixedList<KDNode> void_KDTree::FindKNearestNeighbours(const Vector& x, co
     return knn_list;
 }
 
+/** Find the K nearest neighbours of each row of X.
+
+    \param X the query points, one per row.
+    \param K the number of neighbours.
+    \param indices the neighbours of the i-th query, at [i K, (i + 1) K),
+    given as the order in which they were added (see getNode()).
+    \param distances the corresponding distances.
+    \param n_threads the number of threads to use (<= 0: all cores).
+
+    The tree is only read, and each thread keeps its own list of
+    neighbours. If the tree has fewer than K nodes, the remaining
+    entries have index -1 and infinite distance.
+ */
+void void_KDTree::FindKNearestNeighbours(const Matrix& X, const int K,
+                                         std::vector<int>& indices,
+                                         std::vector<real>& distances,
+                                         int n_threads) const
+{
+    if (X.Columns() != n_dimensions) {
+        throw std::domain_error("void_KDTree::FindKNearestNeighbours: dimension mismatch");
+    }
+    int N = X.Rows();
+    indices.assign(N * std::max(K, 0), -1);
+    distances.assign(N * std::max(K, 0), INF);
+    if (K <= 0) {
+        return;
+    }
+    ParallelFor(N, n_threads,
+                [&](int begin, int end, int block) {
+                    for (int i=begin; i<end; ++i) {
+                        OrderedFixedList<KDNode> knn_list = FindKNearestNeighbours(X.getRow(i), K);
+                        int k = 0;
+                        for (iterator it = knn_list.S.begin(); it != knn_list.S.end(); ++it, ++k) {
+                            distances[i * K + k] = it->first;
+                            indices[i * K + k] = it->second->index;
+                        }
+                    }
+                });
+}
+
 
 /// Add a point to the corresponding (upper or lower) half, creating it if necessary.
 KDNode* KDNode::AddVector(const Vector& x,  Vector& inf,  Vector& sup, const void* object)
@@ -13,6 +13,7 @@
 #define KD_TREE_H
 
 #include "Vector.h"
+#include "Matrix.h"
 #include "OrderedFixedList.h"
 
 #include <list>
@@ -28,9 +29,10 @@ class KDNode
     KDNode* lower; ///< lower child
     KDNode* upper; ///< upper child
     const void* object; ///< easiest way to associate an object
+    int index; ///< order in which the node was added
 	
 	/// Make a node
-    KDNode(const Vector& c_, int a_, Vector& inf, Vector& sup, const void* object_) : c(c_), a(a_), lower(NULL), upper(NULL), object(object_)
+    KDNode(const Vector& c_, int a_, Vector& inf, Vector& sup, const void* object_) : c(c_), a(a_), lower(NULL), upper(NULL), object(object_), index(-1)
     {
         assert(a >= 0 && a < c.Size());
         box_inf = inf;
@@ -77,6 +79,15 @@ public:
     KDNode* FindNearestNeighbour(const Vector& x);
     OrderedFixedList<KDNode> FindKNearestNeighboursLinear(const Vector& x, const int K) const;
     OrderedFixedList<KDNode> FindKNearestNeighbours(const Vector& x, const int K) const; 
+    void FindKNearestNeighbours(const Matrix& X, const int K,
+                                std::vector<int>& indices,
+                                std::vector<real>& distances,
+                                int n_threads = 1) const;
+    /// Get the i-th node added
+    KDNode* getNode(int i) const
+    {
+        return node_list[i];
+    }
     typedef std::list<std::pair<real, KDNode*> >::iterator iterator;
 	/// Get number of nodes
     int getNumberOfNodes() const
@@ -155,6 +166,19 @@ class KDTree : public void_KDTree
     {
         return void_KDTree::FindKNearestNeighbours(x, K);
     }
+    /// Find the K nearest neighbours of each row of X, in parallel
+    void FindKNearestNeighbours(const Matrix& X, const int K,
+                                std::vector<int>& indices,
+                                std::vector<real>& distances,
+                                int n_threads = 1) const
+    {
+        void_KDTree::FindKNearestNeighbours(X, K, indices, distances, n_threads);
+    }
+    /// Get the object of the i-th node added
+    T* getObject(int i) const
+    {
+        return (T*) getNode(i)->object;
+    }
 
 
     T* getObject(KDNode* node) const
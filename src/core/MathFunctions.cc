@@ -10,6 +10,7 @@
  *                                                                         *
  ***************************************************************************/
 #include "MathFunctions.h"
+#include "FixedVector.h"
 #include <cmath>
 #include <cassert>
 #include <cstdio>
@@ -86,23 +87,13 @@ void Normalise (const real* src, real* dst, const int n_elements)
 /// Return \f$\sum_i^n |a_i-b_i|^2\f$
 real SquareNorm (real* a, real* b, int n)
 {
-  real sum = 0;
-  for (int i=0; i<n; i++) {
-    real d = (*a++) - (*b++);
-    sum += d*d;
-  }
-  return sum;
+  return FixedSquareNorm(a, b, n);
 }
 
 /// Return \f$\left(\sum_i^n |a_i-b_i|^2\right)^{1/2}\f$
 real EuclideanNorm (real* a, real* b, int n)
 {
-  real sum = 0;
-  for (int i=0; i<n; i++) {
-    real d = (*a++) - (*b++);
-    sum += d*d;
-  }
-  return sqrt(sum);
+  return sqrt(FixedSquareNorm(a, b, n));
 }
 
 /// Return \f$\left(\sum_i^n |a_i-b_i|^p\right)^{1/p}\f$
@@ -119,12 +110,7 @@ real LNorm (real* a, real* b, int n, real p)
 /// Return \f$\sum_i^n |a_i-b_i|\f$
 real L1Norm (real* a, real* b, int n)
 {
-  real sum = 0;
-  for (int i=0; i<n; i++) {
-    real d = (*a++) - (*b++);
-    sum += fabs(d);
-  }
-  return sum;
+  return FixedL1Norm(a, b, n);
 }
 
 /// Return \f$\sum_i^n a_i\f$
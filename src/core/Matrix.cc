@@ -18,11 +18,12 @@
 #include <exception>
 #include <stdexcept>
 #include <cstring>
+#include <utility>
 
 #include <gsl/gsl_matrix.h>
 #include <gsl/gsl_linalg.h>
 #include <gsl/gsl_blas.h>
-//#include <gsl/gsl_cblas.h>
+#include <gsl/gsl_errno.h>
 
 Matrix Matrix::Unity(int rows, int columns, enum BoundsCheckingStatus check)
 {
@@ -84,6 +85,7 @@ Matrix::Matrix (int rows_, int columns_,  enum BoundsCheckingStatus check_)
 {
     int N = rows*columns;
     x = (real*) calloc(N, sizeof(real));
+    capacity = N;
 #ifdef REFERENCE_ACCESS
     MakeReferences();
 #endif
@@ -93,6 +95,7 @@ Matrix::Matrix (int rows_, int columns_, real* y, enum BoundsCheckingStatus chec
     : rows(rows_),
       columns(columns_),
       x(y),
+      capacity(rows_*columns_),
       checking_bounds(check_),
       transposed(false),
       clear_data(true)
@@ -113,6 +116,7 @@ Matrix::Matrix (const Vector& v, enum BoundsCheckingStatus check_)
     size_t  N = rows * sizeof(real);
     x = (real*) malloc(N);
     memcpy(x, v.x, N);
+    capacity = rows;
 #ifdef REFERENCE_ACCESS
     MakeReferences();
 #endif
@@ -121,8 +125,8 @@ Matrix::Matrix (const Vector& v, enum BoundsCheckingStatus check_)
 
 /// Copy constructor
 Matrix::Matrix (const Matrix& rhs, bool clone)
-    : rows(rhs.Rows()),
-      columns(rhs.Columns()),
+    : rows(rhs.rows),
+      columns(rhs.columns),
       checking_bounds(rhs.checking_bounds),
       transposed(rhs.transposed)
 {
@@ -132,18 +136,17 @@ Matrix::Matrix (const Matrix& rhs, bool clone)
     const int K = M*N;
 
     if (clone) {
+        // same stored layout and transposition as rhs, so copy the raw data
         x = (real*) malloc (sizeof(real)*K);
+        capacity = K;
 #ifdef REFERENCE_ACCESS
         MakeReferences();
 #endif
-        for (int m=0; m<M; ++m) {
-            for (int n=0; n<N; ++n) {
-                (*this)(m,n) = rhs(m,n);
-            }
-        }
+        memcpy(x, rhs.x, sizeof(real)*K);
         clear_data = true;
     } else {
         x = rhs.x;
+        capacity = rhs.capacity;
 #ifdef REFERENCE_ACCESS
         x_list = rhs.x_list;
 #endif
@@ -152,6 +155,32 @@ Matrix::Matrix (const Matrix& rhs, bool clone)
 
 }
 
+/** Move constructor.
+
+    Takes over the data of rhs, which is left as an empty matrix. If
+    rhs was a view of another matrix, so is the result.
+ */
+Matrix::Matrix (Matrix&& rhs) noexcept
+    : rows(rhs.rows),
+      columns(rhs.columns),
+      x(rhs.x),
+      capacity(rhs.capacity),
+      checking_bounds(rhs.checking_bounds),
+      transposed(rhs.transposed),
+      clear_data(rhs.clear_data)
+{
+#ifdef REFERENCE_ACCESS
+    x_list = rhs.x_list;
+    rhs.x_list = NULL;
+#endif
+    rhs.rows = 0;
+    rhs.columns = 0;
+    rhs.x = NULL;
+    rhs.capacity = 0;
+    rhs.transposed = false;
+    rhs.clear_data = true;
+}
+
 Matrix::~Matrix()
 {
     if (clear_data) {
@@ -177,8 +206,11 @@ Matrix& Matrix::operator= (const Matrix& rhs)
     const int N = columns;
     const int K = M*N;
     
-    x = (real*) realloc (x, sizeof(real)*K);
-    assert(x);
+    if (K > capacity) {
+        x = (real*) realloc (x, sizeof(real)*K);
+        assert(x);
+        capacity = K;
+    }
 #ifdef REFERENCE_ACCESS
     x_list = (real**) realloc(x_list, rows * sizeof(real*));
     for (int i=0; i<rows; ++i) {
@@ -195,6 +227,36 @@ Matrix& Matrix::operator= (const Matrix& rhs)
     return *this;
 }
 
+/// Take over the data of another matrix, leaving it empty
+Matrix& Matrix::operator= (Matrix&& rhs) noexcept
+{
+    if (this == &rhs) return *this;
+    if (clear_data) {
+        free(x);
+#ifdef REFERENCE_ACCESS
+        free(x_list);
+#endif
+    }
+    rows = rhs.rows;
+    columns = rhs.columns;
+    x = rhs.x;
+    capacity = rhs.capacity;
+#ifdef REFERENCE_ACCESS
+    x_list = rhs.x_list;
+    rhs.x_list = NULL;
+#endif
+    checking_bounds = rhs.checking_bounds;
+    transposed = rhs.transposed;
+    clear_data = rhs.clear_data;
+    rhs.rows = 0;
+    rhs.columns = 0;
+    rhs.x = NULL;
+    rhs.capacity = 0;
+    rhs.transposed = false;
+    rhs.clear_data = true;
+    return *this;
+}
+
 void Matrix::Clear ()
 {
     for (int i=0; i<rows; ++i) {
@@ -215,8 +277,11 @@ void Matrix::Resize (int rows_, int columns_)
     const int N = columns;
     const int K = M*N;
     
-    x = (real*) realloc (x, sizeof(real)*K);
-    assert(x);
+    if (K > capacity) {
+        x = (real*) realloc (x, sizeof(real)*K);
+        assert(x);
+        capacity = K;
+    }
 
     for (int m=0; m<M; ++m) {
         for (int n=0; n<N; ++n) {
@@ -271,6 +336,141 @@ Matrix Matrix::AddColumn(const Vector& rhs)
 	return lhs;
 }
 
+/** Make room for a rows_ x columns_ matrix.
+
+    The contents and dimensions are left unchanged; only the storage
+    grows, so that later appends up to that size do not reallocate.
+ */
+void Matrix::Reserve(int rows_, int columns_)
+{
+    int K = rows_ * columns_;
+    if (K > capacity) {
+        if (!clear_data) {
+            throw std::logic_error("Cannot reserve storage for a matrix view");
+        }
+        x = (real*) realloc (x, sizeof(real)*K);
+        assert(x);
+        capacity = K;
+    }
+}
+
+/// Grow the storage to at least n_elements, at least doubling it.
+void Matrix::Grow(int n_elements)
+{
+    if (!clear_data) {
+        throw std::logic_error("Cannot append to a matrix view");
+    }
+    if (n_elements > capacity) {
+        Reserve(std::max(n_elements, 2 * capacity), 1);
+    }
+}
+
+/// Append a row to the stored (untransposed) data.
+void Matrix::AppendStoredRow(const Vector& rhs)
+{
+    if (rows > 0 && rhs.Size() != columns) {
+        throw std::domain_error("Matrix::AppendRow: size mismatch");
+    }
+    if (rows == 0) {
+        columns = rhs.Size();
+    }
+    Grow((rows + 1) * columns);
+    memcpy(x + rows * columns, rhs.x, sizeof(real) * columns);
+    rows++;
+}
+
+/** Append a column to the stored (untransposed) data.
+
+    The rows are moved apart in place, starting from the last one, so
+    there is no reallocation unless the capacity is exceeded.
+ */
+void Matrix::AppendStoredColumn(const Vector& rhs)
+{
+    if (columns > 0 && rhs.Size() != rows) {
+        throw std::domain_error("Matrix::AppendColumn: size mismatch");
+    }
+    if (columns == 0) {
+        rows = rhs.Size();
+    }
+    const int N = columns + 1;
+    Grow(rows * N);
+    for (int m=rows-1; m>=0; --m) {
+        memmove(x + m * N, x + m * columns, sizeof(real) * columns);
+        x[m * N + columns] = rhs(m);
+    }
+    columns = N;
+}
+
+/** Append a row in place.
+
+    Unlike AddRow(), this does not copy the matrix: the storage grows
+    geometrically, so appending n rows costs O(n) amortised time. An
+    empty matrix takes its number of columns from rhs.
+ */
+void Matrix::AppendRow(const Vector& rhs)
+{
+    if (transposed) {
+        AppendStoredColumn(rhs);
+    } else {
+        AppendStoredRow(rhs);
+    }
+#ifdef REFERENCE_ACCESS
+    free(x_list);
+    MakeReferences();
+#endif
+}
+
+/** Append a column in place.
+
+    The existing rows must be moved apart, so this takes time linear in
+    the size of the matrix, but there is no reallocation as long as
+    the capacity suffices. On a transposed matrix this appends a
+    stored row instead, which is as cheap as AppendRow().
+ */
+void Matrix::AppendColumn(const Vector& rhs)
+{
+    if (transposed) {
+        AppendStoredRow(rhs);
+    } else {
+        AppendStoredColumn(rhs);
+    }
+#ifdef REFERENCE_ACCESS
+    free(x_list);
+    MakeReferences();
+#endif
+}
+
+/** Add \f$\alpha u v'\f$ to the block starting at (row, column).
+
+    This is a rank-one update in place, without forming the outer
+    product, and only touches the u.Size() x v.Size() block.
+ */
+void Matrix::AddOuterProduct(real alpha, const Vector& u, const Vector& v,
+                             int row, int column)
+{
+    const int M = u.Size();
+    const int N = v.Size();
+    if (row < 0 || column < 0
+        || row + M > Rows() || column + N > Columns()) {
+        throw std::domain_error("Matrix::AddOuterProduct: block out of range");
+    }
+    if (transposed) {
+        for (int i=0; i<M; ++i) {
+            for (int j=0; j<N; ++j) {
+                (*this)(row + i, column + j) += alpha * u.x[i] * v.x[j];
+            }
+        }
+        return;
+    }
+    for (int i=0; i<M; ++i) {
+        const real a = alpha * u.x[i];
+        real* y = &x[(row + i) * columns + column];
+        for (int j=0; j<N; ++j) {
+            y[j] += a * v.x[j];
+        }
+    }
+}
+
 /// Boolean equality operator
 bool Matrix::operator== (const Matrix& rhs) const
 {
@@ -304,7 +504,7 @@ bool Matrix::operator!= (const Matrix& rhs) const
 	4. \f$C = A^\top + B^\top\f$. Then \f$C^\top = A; C^\top = B\f$.
 
  */
-Matrix Matrix::operator+ (const Matrix& rhs)
+Matrix Matrix::operator+ (const Matrix& rhs) &
 {
     if (Columns() != rhs.Columns() 
         || Rows() != rhs.Rows()) {
@@ -322,13 +522,13 @@ Matrix Matrix::operator+ (const Matrix& rhs)
 	gsl_matrix_view C_view
 		= gsl_matrix_view_array(lhs.x, lhs.rows, lhs.columns);
 	
-	if (!transposed && !lhs.transposed) {
+	if (!transposed && !rhs.transposed) {
 		gsl_matrix_memcpy(&C_view.matrix, &A_view.matrix);
 		gsl_matrix_add(&C_view.matrix, &B_view.matrix);
-	} else if (transposed && !lhs.transposed) {
+	} else if (transposed && !rhs.transposed) {
 		gsl_matrix_transpose_memcpy(&C_view.matrix, &A_view.matrix);
 		gsl_matrix_add(&C_view.matrix, &B_view.matrix);
-	} else if (!transposed && lhs.transposed) {
+	} else if (!transposed && rhs.transposed) {
 		gsl_matrix_transpose_memcpy(&C_view.matrix, &B_view.matrix);
 		gsl_matrix_add(&C_view.matrix, &A_view.matrix);
 	} else {
@@ -346,6 +546,16 @@ Matrix Matrix::operator+ (const Matrix& rhs)
     return lhs;
 }
 
+/// Add another matrix to a temporary, reusing its storage
+Matrix Matrix::operator+ (const Matrix& rhs) &&
+{
+    if (!clear_data) {
+        return static_cast<Matrix&>(*this) + rhs;
+    }
+    (*this) += rhs;
+    return std::move(*this);
+}
+
 /// Add another matrix to this
 Matrix& Matrix::operator+= (const Matrix& rhs)
 {
@@ -365,7 +575,7 @@ Matrix& Matrix::operator+= (const Matrix& rhs)
 }
 
 /// Create a matrix through the subtraction of two other matrices.
-Matrix Matrix::operator- (const Matrix& rhs)
+Matrix Matrix::operator- (const Matrix& rhs) &
 {
     if (Columns() != rhs.Columns() 
         || Rows() != rhs.Rows()) {
@@ -384,6 +594,16 @@ Matrix Matrix::operator- (const Matrix& rhs)
     return lhs;
 }
 
+/// Subtract another matrix from a temporary, reusing its storage
+Matrix Matrix::operator- (const Matrix& rhs) &&
+{
+    if (!clear_data) {
+        return static_cast<Matrix&>(*this) - rhs;
+    }
+    (*this) -= rhs;
+    return std::move(*this);
+}
+
 /// Subtract another matrix from this
 Matrix& Matrix::operator-= (const Matrix& rhs)
 {
@@ -411,7 +631,24 @@ Matrix Matrix::operator* (const Matrix& rhs)
     int M = Rows();
     int N = rhs.Columns();
     
+    int K = Columns();
+    
     Matrix C(M, N);
+
+    if (M < MATRIX_BLAS_THRESHOLD
+        && N < MATRIX_BLAS_THRESHOLD
+        && K < MATRIX_BLAS_THRESHOLD) {
+        for (int m=0; m<M; ++m) {
+            for (int n=0; n<N; ++n) {
+                real sum = 0.0;
+                for (int k=0; k<K; ++k) {
+                    sum += (*this)(m, k)*rhs(k, n);
+                }
+                C(m, n) = sum;
+            }
+        }
+        return C;
+    }
 	
 	CBLAS_TRANSPOSE Trans_A = transposed ? CblasTrans : CblasNoTrans;
 	CBLAS_TRANSPOSE Trans_B = rhs.transposed ? CblasTrans : CblasNoTrans;
@@ -426,20 +663,6 @@ Matrix Matrix::operator* (const Matrix& rhs)
 				   1.0, &A_view.matrix, &B_view.matrix,
 				   0.0, &C_view.matrix);
 	return C;
-
-#if 0    
-    //int K = Columns();
-    for (int m=0; m<M; ++m) {
-        for (int n=0; n<N; ++n) {
-            real sum = 0.0;
-            for (int k=0; k<K; ++k) {
-                sum += (*this)(m, k)*rhs(k, n);
-            }
-            lhs(m, n) = sum;
-        }
-    }
-    return lhs;
-#endif
 }
 
 /// Multiply a matrix with a scalar
@@ -454,7 +677,7 @@ Matrix& Matrix::operator*= (const real& rhs)
 }
 
 /// Multiply a matrix with a scalar, creating a new matrix
-Matrix Matrix::operator* (const real& rhs)
+Matrix Matrix::operator* (const real& rhs) &
 {
     Matrix lhs(rows, columns);
     if (transposed) {
@@ -470,14 +693,14 @@ Matrix Matrix::operator* (const real& rhs)
 }
 
 /// Divide a matrix by a scalar, creating a new matrix
-Matrix Matrix::operator/ (const real& rhs)
+Matrix Matrix::operator/ (const real& rhs) &
 {
 	real inv = 1.0 / rhs;
 	return (*this) * inv;
 }
 
 /// Add a matrix to a scalar, creating a new matrix
-Matrix Matrix::operator+ (const real& rhs)
+Matrix Matrix::operator+ (const real& rhs) &
 {
     Matrix lhs(rows, columns);
     if (transposed) {
@@ -493,7 +716,7 @@ Matrix Matrix::operator+ (const real& rhs)
 }
 
 /// Subtract a scalar from a matrix, creating a new matrix
-Matrix Matrix::operator- (const real& rhs)
+Matrix Matrix::operator- (const real& rhs) &
 {
     Matrix lhs(rows, columns);
     if (transposed) {
@@ -508,6 +731,49 @@ Matrix Matrix::operator- (const real& rhs)
     return lhs;
 }
 
+/// Multiply a temporary with a scalar, reusing its storage
+Matrix Matrix::operator* (const real& rhs) &&
+{
+    if (!clear_data) {
+        return static_cast<Matrix&>(*this) * rhs;
+    }
+    (*this) *= rhs;
+    return std::move(*this);
+}
+
+/// Divide a temporary by a scalar, reusing its storage
+Matrix Matrix::operator/ (const real& rhs) &&
+{
+	real inv = 1.0 / rhs;
+	return std::move(*this) * inv;
+}
+
+/// Add a scalar to a temporary, reusing its storage
+Matrix Matrix::operator+ (const real& rhs) &&
+{
+    if (!clear_data) {
+        return static_cast<Matrix&>(*this) + rhs;
+    }
+    int N = rows * columns;
+    for (int n=0; n<N; ++n) {
+        x[n] += rhs;
+    }
+    return std::move(*this);
+}
+
+/// Subtract a scalar from a temporary, reusing its storage
+Matrix Matrix::operator- (const real& rhs) &&
+{
+    if (!clear_data) {
+        return static_cast<Matrix&>(*this) - rhs;
+    }
+    int N = rows * columns;
+    for (int n=0; n<N; ++n) {
+        x[n] -= rhs;
+    }
+    return std::move(*this);
+}
+
 void Matrix::print(FILE* f) const
 {
     for (int i=0; i<Rows(); ++i) {
@@ -534,6 +800,11 @@ Matrix operator* (const real& lhs, const Matrix& rhs)
     return v;
 }
 
+/// Multiply a temporary matrix with a scalar, reusing its storage
+Matrix operator* (const real& lhs, Matrix&& rhs)
+{
+    return std::move(rhs) * lhs;
+}
 
 /// Multiply a vector with a matrix, creating a new matrix
 ///
@@ -572,6 +843,16 @@ Vector operator* (const Matrix& lhs, const Vector& rhs)
 
     Vector v(K);
 
+    if (K >= MATRIX_BLAS_THRESHOLD) {
+        CBLAS_TRANSPOSE Trans_A = lhs.transposed ? CblasTrans : CblasNoTrans;
+        cblas_dgemv(CblasRowMajor, Trans_A,
+                    lhs.rows, lhs.columns,
+                    1.0, lhs.x, lhs.columns,
+                    rhs.x, 1,
+                    0.0, v.x, 1);
+        return v;
+    }
+
     for (int i=0; i<K; ++i) {
         real vi = 0;
         for (int j=0; j<N; ++j) {
@@ -937,11 +1218,38 @@ Matrix Matrix::Cholesky(real epsilon) const
 
     Can be safely called with chol = *this; however then the lower triangular
     part of the matrix must be cleared by the user. (TODO?).
+
+    Large matrices are factorised by GSL instead, in which case the
+    lower triangular part of chol is always cleared.
 */
 void Matrix::Cholesky(Matrix& chol, real epsilon) const
 {
     int n = Rows();
     assert (n == Columns());
+    if (n >= MATRIX_BLAS_THRESHOLD && !chol.transposed) {
+        assert(chol.Rows() == n && chol.Columns() == n);
+        // GSL reads the lower triangle, so put our upper triangle there.
+        // This is safe when chol is *this, as the two do not overlap.
+        for (int i=0; i<n; ++i) {
+            chol.x[i*n + i] = (*this)(i,i) + epsilon;
+            for (int j=i+1; j<n; ++j) {
+                chol.x[j*n + i] = (*this)(i,j);
+            }
+        }
+        gsl_matrix_view C_view = gsl_matrix_view_array(chol.x, n, n);
+        gsl_error_handler_t* handler = gsl_set_error_handler_off();
+        int status = gsl_linalg_cholesky_decomp(&C_view.matrix);
+        gsl_set_error_handler(handler);
+        if (status) {
+            fprintf(stderr,"\nERROR: non-positive definite matrix!\n");
+            throw std::runtime_error("Could not do Cholesky, matrix not positive definite");
+        }
+        // the upper triangle now holds L', which is what we want
+        for (int i=1; i<n; ++i) {
+            memset(&chol.x[i*n], 0, i*sizeof(real));
+        }
+        return;
+    }
     for (int i=0; i<n; i++) {
         // do diagonal first
         chol(i,i) = (*this)(i,i) + epsilon;
@@ -986,8 +1294,41 @@ Vector Matrix::SVD_Solve(const Vector& b) const
 	gsl_linalg_SV_solve (U, V, S, &b_view.vector, &output_view.vector);
 	return output;
 }
-/** Invert matrix using GSL LU Decomp */
-Matrix Matrix::GSL_Inverse() const
+/** Solve \f$A x = b\f$ using the GSL LU decomposition.
+
+    This is cheaper and more accurate than computing the inverse.
+    Throws if a pivot is not larger than epsilon in absolute value.
+ */
+Vector Matrix::LU_Solve(const Vector& b, real epsilon) const
+{
+	int N = Rows();
+	assert(N == Columns());
+	assert(N == b.Size());
+	Matrix A(N, N);
+	A = *this; // untransposed copy
+	gsl_matrix_view M_view = gsl_matrix_view_array(A.x, N, N);
+	gsl_vector_const_view b_view = gsl_vector_const_view_array(b.x, N);
+	Vector output(N);
+	gsl_vector_view output_view = gsl_vector_view_array(output.x, N);
+	gsl_permutation * perm = gsl_permutation_alloc (N);
+	int s;
+	gsl_linalg_LU_decomp (&M_view.matrix, perm, &s);
+	for (int i=0; i<N; ++i) {
+		if (fabs(A.x[i*N + i]) <= epsilon) {
+			gsl_permutation_free(perm);
+			throw std::runtime_error("Could not solve, matrix singular");
+		}
+	}
+	gsl_linalg_LU_solve (&M_view.matrix, perm, &b_view.vector, &output_view.vector);
+	gsl_permutation_free(perm);
+	return output;
+}
+
+/** Invert matrix using GSL LU Decomp.
+
+    Throws if a pivot is not larger than epsilon in absolute value.
+ */
+Matrix Matrix::GSL_Inverse(real epsilon) const
 {
 	int N = Rows();
 	assert(N==Columns());
@@ -999,6 +1340,12 @@ Matrix Matrix::GSL_Inverse() const
 	gsl_permutation * perm = gsl_permutation_alloc (N);
 	int s;
 	gsl_linalg_LU_decomp (&M_view.matrix, perm, &s);
+	for (int i=0; i<N; ++i) {
+		if (fabs(A.x[i*N + i]) <= epsilon) {
+			gsl_permutation_free(perm);
+			throw std::runtime_error("Could not invert, matrix singular");
+		}
+	}
 	gsl_linalg_LU_invert (&M_view.matrix, perm, &R_view.matrix);
 	gsl_permutation_free(perm);
 	return R;
@@ -1020,6 +1367,22 @@ Matrix Matrix::Inverse(const Matrix& L, const Matrix& U) const
     assert(U.Rows() == n);
     assert(U.Columns() == n);
     
+    if (n >= MATRIX_BLAS_THRESHOLD) {
+        // Solve LUX = I in place with two triangular solves. A
+        // transposed factor is passed as the opposite triangle of its
+        // underlying storage.
+        Matrix X = Unity(n,n);
+        cblas_dtrsm(CblasRowMajor, CblasLeft,
+                    L.transposed ? CblasUpper : CblasLower,
+                    L.transposed ? CblasTrans : CblasNoTrans,
+                    CblasNonUnit, n, n, 1.0, L.x, n, X.x, n);
+        cblas_dtrsm(CblasRowMajor, CblasLeft,
+                    U.transposed ? CblasLower : CblasUpper,
+                    U.transposed ? CblasTrans : CblasNoTrans,
+                    CblasNonUnit, n, n, 1.0, U.x, n, X.x, n);
+        return X;
+    }
+
     // Build this column by column
     Matrix B = Unity(n,n);
 
@@ -1189,8 +1552,8 @@ Vector Matrix::RowMin() const
 
 Vector Matrix::getColumn(int c) const
 {
-    Vector column(rows);
-    for (int i=0; i<rows; i++) {
+    Vector column(Rows());
+    for (int i=0; i<Rows(); i++) {
         column[i] = (*this)(i,c);
     }
     return column;
@@ -1198,8 +1561,17 @@ Vector Matrix::getColumn(int c) const
 
 Vector Matrix::getRow(int r) const
 {
-    Vector row(columns);
-    for (int i=0; i<columns; i++) {
+    if (checking_bounds && (r < 0 || r >= Rows())) {
+        fprintf(stderr, "bad access: row %d on a %d x %d matrix\n",
+                r, Rows(), Columns());
+        fflush (stderr);
+        throw std::out_of_range("matrix index out of range");
+    }
+    if (!transposed) {
+        return Vector(columns, &x[r*columns]);
+    }
+    Vector row(Columns());
+    for (int i=0; i<Columns(); i++) {
         row[i] = (*this)(r,i);
     }
     return row;
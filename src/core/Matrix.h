@@ -29,9 +29,21 @@
 
 #define ACCURACY_LIMIT 1e-12
 
+/// Matrices with fewer rows than this are handled by plain loops,
+/// larger ones are passed on to BLAS / GSL.
+#define MATRIX_BLAS_THRESHOLD 8
+
 /** \brief An n-by-m dimensional matrix.
 
-    TODO: Use the BLAS interface for some / most routines.
+    The data is stored contiguously in row-major order, with
+    transposition done lazily through a flag. Products, inversion and
+    the Cholesky factorisation use the BLAS / GSL routines once the
+    matrix has at least MATRIX_BLAS_THRESHOLD rows.
+
+    Like std::vector, the storage may be larger than the matrix, so
+    that AppendRow() and AppendColumn() can grow it in place with
+    amortised constant reallocation cost. Use Reserve() when the final
+    size is known in advance.
  */
 class Matrix
 {
@@ -54,23 +66,43 @@ public:
     explicit Matrix (const Vector& v, enum BoundsCheckingStatus check_ = CHECK_BOUNDS);
 #endif
     Matrix (const Matrix& rhs, bool clone = true);
+    Matrix (Matrix&& rhs) noexcept;
     ~Matrix();
     void Resize(int rows_, int columns_);
 	Matrix AddRow(const Vector& rhs);
 	Matrix AddColumn(const Vector& rhs);
+    void Reserve(int rows_, int columns_);
+    void AppendRow(const Vector& rhs);
+    void AppendColumn(const Vector& rhs);
+    void AddOuterProduct(real alpha, const Vector& u, const Vector& v,
+                         int row = 0, int column = 0);
+    /// Number of elements the matrix can hold without reallocation
+    int Capacity() const
+    {
+        return capacity;
+    }
     Matrix& operator= (const Matrix& rhs);
+    Matrix& operator= (Matrix&& rhs) noexcept;
     bool operator== (const Matrix& rhs) const;
     bool operator!= (const Matrix& rhs) const;
-    Matrix operator+ (const Matrix& rhs);
+    // The && versions reuse the storage of a temporary left operand,
+    // unless it is a view of another matrix.
+    Matrix operator+ (const Matrix& rhs) &;
+    Matrix operator+ (const Matrix& rhs) &&;
     Matrix& operator+= (const Matrix& rhs);
-    Matrix operator- (const Matrix& rhs);
+    Matrix operator- (const Matrix& rhs) &;
+    Matrix operator- (const Matrix& rhs) &&;
     Matrix& operator-= (const Matrix& rhs);
     Matrix& operator*= (const real& rhs);
     Matrix operator* (const Matrix& rhs);
-    Matrix operator* (const real& rhs);
-    Matrix operator+ (const real& rhs);
-    Matrix operator- (const real& rhs);
-    Matrix operator/ (const real& rhs);
+    Matrix operator* (const real& rhs) &;
+    Matrix operator* (const real& rhs) &&;
+    Matrix operator+ (const real& rhs) &;
+    Matrix operator+ (const real& rhs) &&;
+    Matrix operator- (const real& rhs) &;
+    Matrix operator- (const real& rhs) &&;
+    Matrix operator/ (const real& rhs) &;
+    Matrix operator/ (const real& rhs) &&;
     /// Matrix inversion (defaults to GSL with LU)
     Matrix Inverse(real epsilon = ACCURACY_LIMIT) const
     {
@@ -78,8 +110,9 @@ public:
 		//return Inverse_LU();
 	}
 	Vector SVD_Solve(const Vector& b) const;
+    Vector LU_Solve(const Vector& b, real epsilon = 0) const;
 
-	Matrix GSL_Inverse() const;
+	Matrix GSL_Inverse(real epsilon = 0) const;
 
     /** Matrix inversion using the Cholesky decomposition.
         
@@ -104,10 +137,14 @@ public:
         \f[
         LUX = I,
         \f]
-        by dynamic programming.
+        by dynamic programming. Large matrices are inverted with
+        GSL_Inverse() instead, which pivots partially.
     */
     Matrix Inverse_LU(real epsilon = ACCURACY_LIMIT) const
     {
+        if (rows >= MATRIX_BLAS_THRESHOLD && rows == columns) {
+            return GSL_Inverse(epsilon);
+        }
         real det;
         Matrix tmp(*this);
         std::vector<Matrix> A = tmp.LUDecomposition(det, epsilon);
@@ -153,24 +190,30 @@ public:
     const real& operator() (int i, int j) const;
     void print(FILE* f) const;
     friend Matrix operator* (const real& lhs, const Matrix& rhs);
+    friend Matrix operator* (const real& lhs, Matrix&& rhs);
     friend Matrix operator* (const Vector& lhs, const Matrix& rhs);
     friend Vector operator* (const Matrix& lhs, const Vector& rhs);
 protected:
     int rows; ///< number of rows in the matrix
     int columns; ///< number of columns in the matrix
     real* x; ///< data
+    int capacity; ///< number of elements allocated for x
 #ifdef REFERENCE_ACCESS
     real** x_list; ///< data pointers
     void MakeReferences();
 #endif
-    const enum BoundsCheckingStatus checking_bounds;
+    enum BoundsCheckingStatus checking_bounds;
     bool transposed;
     bool clear_data;
+    void Grow(int n_elements);
+    void AppendStoredRow(const Vector& rhs);
+    void AppendStoredColumn(const Vector& rhs);
     const real& qGet(int i, int j);
     void qSet(int i, int j, real v);
 };
 
 Matrix operator* (const real& lhs, const Matrix& rhs);
+Matrix operator* (const real& lhs, Matrix&& rhs);
 Matrix operator* (const Vector& lhs, const Matrix& rhs);
 Vector operator* (const Matrix& lhs, const Vector& rhs);
 real Mahalanobis2 (const Vector& x, const Matrix& A, const Vector& y);
@@ -0,0 +1,186 @@
+// -*- Mode: c++ -*-
+/***************************************************************************
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ ***************************************************************************/
+
+#ifndef PARALLEL_FOR_H
+#define PARALLEL_FOR_H
+
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <deque>
+#include <vector>
+#include <algorithm>
+
+/// Number of threads to use when the caller asks for "all of them".
+inline int DefaultNThreads()
+{
+	int n = std::thread::hardware_concurrency();
+	return (n > 0) ? n : 1;
+}
+
+/** A persistent pool of worker threads.
+
+	Workers are started the first time they are needed and then wait
+	for tasks until the program exits, so that repeated parallel loops
+	do not pay for creating and joining threads. A thread waiting for
+	its own tasks to finish runs queued tasks in the meantime, so that
+	parallel loops can be nested without deadlock.
+ */
+class ThreadPool
+{
+protected:
+	/// A queued task, and the counter of its caller.
+	struct Task
+	{
+		std::function<void()> run;
+		int* remaining;
+	};
+	std::mutex mutex; ///< guards everything below
+	std::condition_variable work_available; ///< signalled on Submit()
+	std::condition_variable finished; ///< signalled when a task is done
+	std::deque<Task> tasks; ///< tasks not yet started
+	std::vector<std::thread> workers; ///< the worker threads
+	bool stopping; ///< set when the pool is destroyed
+	ThreadPool() : stopping(false)
+	{
+	}
+	/// Run a task without holding the lock, then count it as done.
+	void Run(Task& task, std::unique_lock<std::mutex>& lock)
+	{
+		lock.unlock();
+		task.run();
+		lock.lock();
+		--*task.remaining;
+		finished.notify_all();
+	}
+	void Work()
+	{
+		std::unique_lock<std::mutex> lock(mutex);
+		while (true) {
+			work_available.wait(lock, [this] { return stopping || !tasks.empty(); });
+			if (tasks.empty()) {
+				return;
+			}
+			Task task = tasks.front();
+			tasks.pop_front();
+			Run(task, lock);
+		}
+	}
+public:
+	~ThreadPool()
+	{
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			stopping = true;
+		}
+		work_available.notify_all();
+		for (unsigned int t=0; t<workers.size(); ++t) {
+			workers[t].join();
+		}
+	}
+	/// The pool shared by all parallel loops
+	static ThreadPool& Instance()
+	{
+		static ThreadPool pool;
+		return pool;
+	}
+	/// Number of worker threads started so far
+	int getNWorkers()
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		return workers.size();
+	}
+	/// Make sure there are at least n_workers workers.
+	void Reserve(int n_workers)
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		while ((int) workers.size() < n_workers) {
+			workers.push_back(std::thread(&ThreadPool::Work, this));
+		}
+	}
+	/// Queue a task; remaining is decremented when it is done.
+	void Submit(const std::function<void()>& run, int* remaining)
+	{
+		Task task = {run, remaining};
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			tasks.push_back(task);
+		}
+		work_available.notify_one();
+	}
+	/// Wait until remaining is zero, running queued tasks meanwhile.
+	void Wait(int* remaining)
+	{
+		std::unique_lock<std::mutex> lock(mutex);
+		while (*remaining > 0) {
+			if (tasks.empty()) {
+				finished.wait(lock);
+			} else {
+				Task task = tasks.front();
+				tasks.pop_front();
+				Run(task, lock);
+			}
+		}
+	}
+};
+
+/** Split [0, n) into contiguous blocks and process them in parallel.
+
+	The body is called as body(begin, end, block) for each block, with
+	block in [0, n_blocks). Blocks are always the same for a given n
+	and n_threads, so that callers can reduce per-block results in a
+	fixed order and get reproducible answers. With n_threads <= 1 the
+	body is called once on the whole range in the current thread.
+	Otherwise the calling thread processes block 0, and the other
+	blocks are run by the workers of ThreadPool::Instance().
+ */
+template <typename F>
+void ParallelFor(int n, int n_threads, F body)
+{
+	if (n_threads <= 0) {
+		n_threads = DefaultNThreads();
+	}
+	n_threads = std::min(n_threads, n);
+	if (n_threads <= 1) {
+		if (n > 0) {
+			body(0, n, 0);
+		}
+		return;
+	}
+	int block_size = (n + n_threads - 1) / n_threads;
+	int n_blocks = (n + block_size - 1) / block_size;
+	ThreadPool& pool = ThreadPool::Instance();
+	pool.Reserve(n_blocks - 1);
+	int remaining = n_blocks - 1;
+	for (int t=1; t<n_blocks; ++t) {
+		int begin = t * block_size;
+		int end = std::min(n, begin + block_size);
+		pool.Submit([&body, begin, end, t] { body(begin, end, t); }, &remaining);
+	}
+	body(0, std::min(n, block_size), 0);
+	pool.Wait(&remaining);
+}
+
+/// The number of blocks ParallelFor() will use for n items.
+inline int ParallelForBlocks(int n, int n_threads)
+{
+	if (n_threads <= 0) {
+		n_threads = DefaultNThreads();
+	}
+	n_threads = std::min(n_threads, n);
+	if (n_threads <= 1) {
+		return 1;
+	}
+	int block_size = (n + n_threads - 1) / n_threads;
+	return (n + block_size - 1) / block_size;
+}
+
+#endif
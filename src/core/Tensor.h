@@ -14,7 +14,9 @@
 
 #include <vector>
 #include <cstdlib>
+#include <cstring>
 #include <cassert>
+#include <utility>
 
 #include "real.h"
 
@@ -40,6 +42,48 @@ public:
         data = (real*) calloc(K, sizeof(real));
     }
 
+    Tensor(const Tensor& rhs) : X(rhs.X), n(rhs.n), K(rhs.K)
+    {
+        data = (real*) malloc(K * sizeof(real));
+        memcpy(data, rhs.data, K * sizeof(real));
+    }
+
+    /// Take over the data of rhs, leaving it empty
+    Tensor(Tensor&& rhs) noexcept
+        : X(std::move(rhs.X)), data(rhs.data), n(rhs.n), K(rhs.K)
+    {
+        rhs.data = NULL;
+        rhs.n = 0;
+        rhs.K = 0;
+    }
+
+    Tensor& operator= (const Tensor& rhs)
+    {
+        if (this != &rhs) {
+            X = rhs.X;
+            n = rhs.n;
+            K = rhs.K;
+            data = (real*) realloc(data, K * sizeof(real));
+            memcpy(data, rhs.data, K * sizeof(real));
+        }
+        return *this;
+    }
+
+    Tensor& operator= (Tensor&& rhs) noexcept
+    {
+        if (this != &rhs) {
+            free(data);
+            X = std::move(rhs.X);
+            data = rhs.data;
+            n = rhs.n;
+            K = rhs.K;
+            rhs.data = NULL;
+            rhs.n = 0;
+            rhs.K = 0;
+        }
+        return *this;
+    }
+
     ~Tensor()
     {
         free(data);
@@ -9,6 +9,7 @@
 #include <cstdlib>
 #include <cstring>
 #include <cassert>
+#include <utility>
 
 
 Vector Vector::Unity(int N_, enum BoundsCheckingStatus check)
@@ -50,94 +51,91 @@ void CopyVector (Vector* const lhs, const Vector * const rhs)
 
 
 #if 1
+/** Point x at storage for N_ elements, without initialising them.
+
+    Small vectors use the inline buffer, larger ones the heap.
+*/
+void Vector::Allocate(int N_)
+{
+    n = N_;
+    if (n <= VECTOR_INLINE_SIZE) {
+        x = buffer;
+        maxN = VECTOR_INLINE_SIZE;
+    } else {
+        x = (real*) malloc(sizeof(real)*n);
+        maxN = n;
+    }
+}
+
 Vector::Vector()
 {
-    n = 0;
-    maxN = 0;
-    x = NULL;
+    Allocate(0);
     checking_bounds = NO_CHECK_BOUNDS;
 }
 
 /// Always create a zero vector
 Vector::Vector(int N_, enum BoundsCheckingStatus check)
 {
-    n = N_;
-    maxN = n;
-    if (n==0) {
-        x = NULL;
-    } else {
-        x = (real*) calloc(n, sizeof(real));
-    }
+    Allocate(N_);
+    memset(x, 0, sizeof(real)*n);
     checking_bounds = check;
 }
 
 Vector::Vector(uint N_, enum BoundsCheckingStatus check)
 {
-    n = N_;
-    maxN = n;
-    if (n==0) {
-        x = NULL;
-    } else {
-        x = (real*) calloc(n, sizeof(real));
-    }
+    Allocate(N_);
+    memset(x, 0, sizeof(real)*n);
     checking_bounds = check;
 }
 
 Vector::Vector(real z, enum BoundsCheckingStatus check)
 {
-    n = 1;
-    maxN = n;
-    x = (real*) calloc(n, sizeof(real));
+    Allocate(1);
     x[0] = z;
     checking_bounds = check;
 }
 
 
-/** Copy from an array.
-    TODO replace assignment with memcopy
-*/
+/// Copy from an array.
 Vector::Vector (int N_, real* y, enum BoundsCheckingStatus check)
 {
-    n = N_;
-    maxN = n;
-    if (n==0) {
-        x = NULL;
-    } else {
-        x = (real*) malloc(sizeof(real)*n);
-        memcpy(x, y, sizeof(real)*n);
-    }
+    Allocate(N_);
+    memcpy(x, y, sizeof(real)*n);
     checking_bounds = check;
 }
 
-/** Copy constructor
-    TODO replace assignment with memcopy
-*/
+/// Copy constructor
 Vector::Vector (const Vector& rhs)
 {
-    n = rhs.n;
-    maxN = n;
-    if (n==0) {
-        x = NULL;
+    Allocate(rhs.n);
+    memcpy(x, rhs.x, sizeof(real)*n);
+    checking_bounds = rhs.checking_bounds;
+}
+
+/** Move constructor.
+
+    Heap storage is taken over from rhs, which is left empty. Inline
+    storage has to be copied, but is small by definition.
+*/
+Vector::Vector (Vector&& rhs) noexcept
+{
+    checking_bounds = rhs.checking_bounds;
+    if (rhs.x == rhs.buffer) {
+        Allocate(rhs.n);
+        memcpy(x, rhs.x, sizeof(real)*n);
     } else {
-        x = (real*) malloc(sizeof(real)*n);
-        for (int i=0; i<n; i++) {
-            x[i] = rhs[i];
-        }
+        x = rhs.x;
+        n = rhs.n;
+        maxN = rhs.maxN;
+        rhs.Allocate(0);
     }
-    checking_bounds = rhs.checking_bounds;
 }
 
 Vector::Vector (const std::vector<real>& rhs)
 {
-    n = rhs.size();
-    maxN = n;
-    if (n==0) {
-        x = NULL;
-    } else {
-        x = (real*) malloc(sizeof(real)*n);
-        for (int i=0; i<n; i++) {
-            x[i] = rhs[i];
-        }
+    Allocate(rhs.size());
+    for (int i=0; i<n; i++) {
+        x[i] = rhs[i];
     }
     checking_bounds = NO_CHECK_BOUNDS;
 }
@@ -146,7 +144,7 @@ Vector::Vector (const std::vector<real>& rhs)
 /// Destructor
 Vector::~Vector()
 {
-    if (x) {
+    if (x != buffer) {
         free(x);
     }
 }
@@ -242,9 +240,27 @@ Vector& Vector::operator= (const Vector& rhs)
 {
     if (this == &rhs) return *this;
     Resize(rhs.n);
-    for (int i=0; i<n; i++) {
-        x[i] = rhs[i];
+    memcpy(x, rhs.x, sizeof(real)*n);
+    return *this;
+}
+
+/// Move assignment: take over the heap storage of rhs, if it has any.
+Vector& Vector::operator= (Vector&& rhs) noexcept
+{
+    if (this == &rhs) return *this;
+    checking_bounds = rhs.checking_bounds;
+    if (rhs.x == rhs.buffer) {
+        Resize(rhs.n);
+        memcpy(x, rhs.x, sizeof(real)*n);
+        return *this;
     }
+    if (x != buffer) {
+        free(x);
+    }
+    x = rhs.x;
+    n = rhs.n;
+    maxN = rhs.maxN;
+    rhs.Allocate(0);
     return *this;
 }
 
@@ -329,7 +345,7 @@ real Vector::Sum(const int start, const int end) const
 }
 
 /// Addition
-const Vector Vector::operator+ (const Vector& rhs) const
+Vector Vector::operator+ (const Vector& rhs) const &
 {
     assert (rhs.n==n);
     Vector lhs (n);
@@ -350,7 +366,7 @@ Vector& Vector::operator+= (const Vector& rhs)
 }
 
 /// Subtraction
-const Vector Vector::operator- (const Vector& rhs) const
+Vector Vector::operator- (const Vector& rhs) const &
 {
     assert (rhs.n==n);
     Vector lhs (n);
@@ -372,7 +388,7 @@ Vector& Vector::operator-= (const Vector& rhs)
 
 
 /// Per-element multiplication
-const Vector Vector::operator* (const Vector& rhs) const
+Vector Vector::operator* (const Vector& rhs) const &
 {
     assert (rhs.n==n);
     Vector lhs (n);
@@ -393,7 +409,7 @@ Vector& Vector::operator*= (const Vector& rhs)
 }
 
 /// Per-element division
-const Vector Vector::operator/ (const Vector& rhs) const
+Vector Vector::operator/ (const Vector& rhs) const &
 {
     assert (rhs.n==n);
     Vector lhs (n);
@@ -416,7 +432,7 @@ Vector& Vector::operator/= (const Vector& rhs)
 
 /* ----------- SCALAR OPERATORS -------------------------*/
 /// Scalar addition
-const Vector Vector::operator+ (const real& rhs) const
+Vector Vector::operator+ (const real& rhs) const &
 {
     Vector lhs (n);
     for (int i=0; i<n; i++) {
@@ -425,7 +441,7 @@ const Vector Vector::operator+ (const real& rhs) const
     return lhs;
 }
 /// Scalar subtraction
-const Vector Vector::operator- (const real& rhs) const
+Vector Vector::operator- (const real& rhs) const &
 {
     Vector lhs (n);
     for (int i=0; i<n; i++) {
@@ -435,7 +451,7 @@ const Vector Vector::operator- (const real& rhs) const
 }
 
 /// Scalar multiplication by -1
-const Vector Vector:: operator- () const
+Vector Vector::operator- () const &
 {
 	Vector lhs(n);
 	for (int i=0; i<n; i++) {
@@ -445,7 +461,7 @@ const Vector Vector:: operator- () const
 }
 
 /// Scalar multiplication
-const Vector Vector::operator* (const real& rhs) const
+Vector Vector::operator* (const real& rhs) const &
 {
     Vector lhs (n);
     for (int i=0; i<n; i++) {
@@ -454,7 +470,7 @@ const Vector Vector::operator* (const real& rhs) const
     return lhs;
 }
 /// Scalar division
-const Vector Vector::operator/ (const real& rhs) const
+Vector Vector::operator/ (const real& rhs) const &
 {
     Vector lhs (n);
     real inv = 1.0 / rhs;
@@ -505,6 +521,71 @@ Vector& Vector::operator/= (const real& rhs)
     return *this;
 }
 
+/// Add to a temporary, reusing its storage
+Vector Vector::operator+ (const Vector& rhs) &&
+{
+    (*this) += rhs;
+    return std::move(*this);
+}
+
+/// Subtract from a temporary, reusing its storage
+Vector Vector::operator- (const Vector& rhs) &&
+{
+    (*this) -= rhs;
+    return std::move(*this);
+}
+
+/// Multiply a temporary, reusing its storage
+Vector Vector::operator* (const Vector& rhs) &&
+{
+    (*this) *= rhs;
+    return std::move(*this);
+}
+
+/// Divide a temporary, reusing its storage
+Vector Vector::operator/ (const Vector& rhs) &&
+{
+    (*this) /= rhs;
+    return std::move(*this);
+}
+
+/// Add a scalar to a temporary, reusing its storage
+Vector Vector::operator+ (const real& rhs) &&
+{
+    (*this) += rhs;
+    return std::move(*this);
+}
+
+/// Subtract a scalar from a temporary, reusing its storage
+Vector Vector::operator- (const real& rhs) &&
+{
+    (*this) -= rhs;
+    return std::move(*this);
+}
+
+/// Negate a temporary, reusing its storage
+Vector Vector::operator- () &&
+{
+    for (int i=0; i<n; i++) {
+        x[i] = -x[i];
+    }
+    return std::move(*this);
+}
+
+/// Multiply a temporary by a scalar, reusing its storage
+Vector Vector::operator* (const real& rhs) &&
+{
+    (*this) *= rhs;
+    return std::move(*this);
+}
+
+/// Divide a temporary by a scalar, reusing its storage
+Vector Vector::operator/ (const real& rhs) &&
+{
+    (*this) /= rhs;
+    return std::move(*this);
+}
+
 /// Exponentiation
 
 
@@ -540,26 +621,21 @@ void Vector::Clear()
 /// Change size
 void Vector::Resize(int N_)
 { 
-    n = N_;
-    if (n > maxN) {
-        if (maxN == 0) {
-            x = (real*) malloc (sizeof(real)*n);
+    if (N_ > maxN) {
+        if (x == buffer) {
+            x = (real*) malloc (sizeof(real)*N_);
+            memcpy(x, buffer, sizeof(real)*n);
         } else {
-            x = (real*) realloc(x, sizeof(real)*n);
+            x = (real*) realloc(x, sizeof(real)*N_);
         }
-        maxN = n;
+        maxN = N_;
     }
+    n = N_;
 }
 
 void Vector::AddElement(const real& rhs)
 {
-	n = n + 1;
-	if (maxN == 0) {
-		x = (real*) malloc (sizeof(real)*(n));
-	} else {
-		x = (real*) realloc(x, sizeof(real)*(n));
-	}
-	maxN = n;
+	Resize(n + 1);
 	x[n-1] = rhs;
 }
 #endif
@@ -8,6 +8,7 @@
 #include "real.h"
 #include "MathFunctions.h"
 #include "Object.h"
+#include "VectorExpression.h"
 #include <cstdio>
 #include <cstdlib>
 #include <cassert>
@@ -24,6 +25,12 @@
     \brief Vector and matrix computations.
 */
 
+#ifndef VECTOR_INLINE_SIZE
+/// Vectors with up to this many elements are stored inside the object,
+/// so that they need no heap allocation.
+#define VECTOR_INLINE_SIZE 8
+#endif
+
 #ifdef NDEBUG
 #define DEFAULT_CHECK_BOUNDS NO_CHECK_BOUNDS
 #else
@@ -31,7 +38,7 @@
 #endif
 
 /// An n-dimensional vector.
-class Vector : public Object
+class Vector : public Object, public VectorExpression<Vector>
 {
 public:
     enum BoundsCheckingStatus {NO_CHECK_BOUNDS=0, CHECK_BOUNDS=1};
@@ -46,10 +53,35 @@ public:
     explicit Vector (real x, enum BoundsCheckingStatus check = DEFAULT_CHECK_BOUNDS);
 
     Vector (const Vector& rhs);
+    Vector (Vector&& rhs) noexcept;
     Vector (const std::vector<real>& rhs);
+    /// Evaluate an expression into a new vector
+    template <typename E>
+    Vector (const VectorExpression<E>& rhs,
+            enum BoundsCheckingStatus check = DEFAULT_CHECK_BOUNDS)
+        : checking_bounds(check)
+    {
+        Allocate(0);
+        (*this) = rhs;
+    }
     ~Vector ();
     Vector& operator= (const real& rhs);
     Vector& operator= (const Vector& rhs);
+    Vector& operator= (Vector&& rhs) noexcept;
+    /// Evaluate an expression in place, in a single pass.
+    ///
+    /// Each element of the result only depends on the same element of
+    /// the operands, so the expression may refer to this vector.
+    template <typename E>
+    Vector& operator= (const VectorExpression<E>& rhs)
+    {
+        const E& e = rhs.self();
+        Resize(e.Size());
+        for (int i=0; i<n; ++i) {
+            x[i] = e[i];
+        }
+        return *this;
+    }
     void Clear();
     void Resize(int N_);
 	void AddElement(const real& rhs);
@@ -82,19 +114,30 @@ public:
 	const bool operator> (const real& rhs) const;
     const bool operator> (const Vector& rhs) const;
     const bool operator== (const Vector& rhs) const;
-    const Vector operator+ (const Vector& rhs) const;
-    const Vector operator- (const Vector& rhs) const;
-    const Vector operator* (const Vector& rhs) const;
-    const Vector operator/ (const Vector& rhs) const;
+    // The && versions work in place on a temporary left operand, so
+    // that chains such as a + b + c only allocate once.
+    Vector operator+ (const Vector& rhs) const &;
+    Vector operator- (const Vector& rhs) const &;
+    Vector operator* (const Vector& rhs) const &;
+    Vector operator/ (const Vector& rhs) const &;
+    Vector operator+ (const Vector& rhs) &&;
+    Vector operator- (const Vector& rhs) &&;
+    Vector operator* (const Vector& rhs) &&;
+    Vector operator/ (const Vector& rhs) &&;
     Vector& operator+= (const Vector& rhs);
     Vector& operator-= (const Vector& rhs);
     Vector& operator*= (const Vector& rhs);
     Vector& operator/= (const Vector& rhs);
-    const Vector operator+ (const real& rhs) const;
-    const Vector operator- (const real& rhs) const;
-	const Vector operator- () const;
-    const Vector operator* (const real& rhs) const;
-    const Vector operator/ (const real& rhs) const;
+    Vector operator+ (const real& rhs) const &;
+    Vector operator- (const real& rhs) const &;
+	Vector operator- () const &;
+    Vector operator* (const real& rhs) const &;
+    Vector operator/ (const real& rhs) const &;
+    Vector operator+ (const real& rhs) &&;
+    Vector operator- (const real& rhs) &&;
+	Vector operator- () &&;
+    Vector operator* (const real& rhs) &&;
+    Vector operator/ (const real& rhs) &&;
     Vector& operator+= (const real& rhs);
     Vector& operator-= (const real& rhs);
     Vector& operator*= (const real& rhs);
@@ -103,8 +146,10 @@ public:
     void print(FILE* f) const;
     void printf(FILE* f) const;
 private:
-    int maxN;
+    void Allocate(int N_);
+    int maxN; ///< capacity of x
     enum BoundsCheckingStatus checking_bounds;
+    real buffer[VECTOR_INLINE_SIZE]; ///< inline storage for small vectors
 };
 
 
@@ -125,6 +170,12 @@ std::vector<T> convert(const Vector& x)
     return y;
 }
 
+/// Start a lazy expression from a vector; see VectorExpression.h
+inline VectorReference Lazy(const Vector& v)
+{
+    return VectorReference(v);
+}
+
 Vector* NewVector (int n);///< make a new vector of length n
 void CopyVector (Vector* const lhs, const Vector * const rhs); ///< Copy one vector to another.
 int DeleteVector (Vector* vector); ///< Delete vector
@@ -292,7 +343,7 @@ inline real Volume(const Vector& x)
 	return V;
 }
 /// Exponentiation
-inline const Vector exp (const Vector& rhs)
+inline Vector exp (const Vector& rhs)
 {
     int n = rhs.Size();
     Vector lhs (n);
@@ -303,7 +354,7 @@ inline const Vector exp (const Vector& rhs)
 }
 
 /// Power, by element
-inline const Vector pow (const Vector& rhs, const real p)
+inline Vector pow (const Vector& rhs, const real p)
 {
     int n = rhs.Size();
     Vector lhs (n);
@@ -315,7 +366,7 @@ inline const Vector pow (const Vector& rhs, const real p)
 
 
 /// Hypertangentification
-inline const Vector tanh (const Vector& rhs)
+inline Vector tanh (const Vector& rhs)
 {
     int n = rhs.Size();
     Vector lhs (n);
@@ -327,7 +378,7 @@ inline const Vector tanh (const Vector& rhs)
 
 
 /// Logarithmication
-inline const Vector log (const Vector& rhs)
+inline Vector log (const Vector& rhs)
 {
     int n = rhs.Size();
     Vector lhs (n);
@@ -338,7 +389,7 @@ inline const Vector log (const Vector& rhs)
 }
 
 /// Absolute value
-inline const Vector abs (const Vector& rhs)
+inline Vector abs (const Vector& rhs)
 {
     int n = rhs.Size();
     Vector lhs (n);
@@ -349,7 +400,7 @@ inline const Vector abs (const Vector& rhs)
 }
 
 /// logAdd
-inline const Vector logAdd (const Vector& x, const Vector& y)
+inline Vector logAdd (const Vector& x, const Vector& y)
 {
 	int n = x.Size();
 	assert (x.Size() == y.Size());
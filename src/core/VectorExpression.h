@@ -0,0 +1,314 @@
+// -*- Mode: c++ -*-
+/***************************************************************************
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ ***************************************************************************/
+
+#ifndef VECTOR_EXPRESSION_H
+#define VECTOR_EXPRESSION_H
+
+#include "real.h"
+#include <cassert>
+#include <cmath>
+
+/**
+   \ingroup MathGroup
+*/
+/*@{*/
+
+/**
+    \file VectorExpression.h
+
+    \brief Lazy element-wise vector arithmetic.
+
+    The usual Vector operators allocate a new Vector for every
+    intermediate result. Wrapping an operand with Lazy() instead
+    builds an expression object, which is only evaluated when it is
+    assigned to a Vector (or reduced with Sum()), in a single loop and
+    without temporaries. Vector is itself an expression, so once a
+    chain has been started plain Vectors can be mixed in. For example
+    \code
+    real r = pow((Lazy(x) - center) / beta, 2.0).Sum();
+    \endcode
+    does not allocate at all. Each element is computed as the Vector
+    operators would compute it, so that a chain gives the same result
+    with or without Lazy(). Expressions refer to their Vector
+    operands, so they must not outlive them: do not store them.
+*/
+
+/// Base class of all vector expressions; E is the derived class.
+template <typename E>
+class VectorExpression
+{
+public:
+    const E& self() const
+    {
+        return static_cast<const E&>(*this);
+    }
+    /// Element i of the result
+    real operator[] (int i) const
+    {
+        return self()[i];
+    }
+    int Size() const
+    {
+        return self().Size();
+    }
+    /// Sum of all elements, without storing the result.
+    real Sum() const
+    {
+        const E& e = self();
+        int n = e.Size();
+        real sum = 0;
+        for (int i=0; i<n; ++i) {
+            sum += e[i];
+        }
+        return sum;
+    }
+    /// Sum of the squares of all elements, as Vector::SquareNorm()
+    real SquareNorm() const
+    {
+        const E& e = self();
+        int n = e.Size();
+        real sum = 0;
+        for (int i=0; i<n; ++i) {
+            real e_i = e[i];
+            sum += e_i * e_i;
+        }
+        return sum;
+    }
+};
+
+class Vector;
+
+/// A leaf expression: a reference to existing data.
+class VectorReference : public VectorExpression<VectorReference>
+{
+protected:
+    const real* x;
+    int n;
+public:
+    VectorReference(const real* x_, int n_) : x(x_), n(n_)
+    {
+    }
+    /// Refer to the data of a Vector.
+    template <typename V>
+    VectorReference(const V& v) : x(v.x), n(v.n)
+    {
+    }
+    real operator[] (int i) const
+    {
+        return x[i];
+    }
+    int Size() const
+    {
+        return n;
+    }
+};
+
+/// How an operand is held inside an expression. Expressions are small
+/// and held by value, while Vector operands are replaced by a
+/// reference to their data, which also skips bounds checking.
+template <typename E>
+struct VectorExpressionStorage
+{
+    typedef const E type;
+};
+
+template <>
+struct VectorExpressionStorage<Vector>
+{
+    typedef const VectorReference type;
+};
+
+/// Element-wise combination of two expressions.
+template <typename L, typename R, typename Op>
+class VectorBinaryExpression
+    : public VectorExpression<VectorBinaryExpression<L, R, Op> >
+{
+protected:
+    typename VectorExpressionStorage<L>::type lhs;
+    typename VectorExpressionStorage<R>::type rhs;
+public:
+    VectorBinaryExpression(const L& lhs_, const R& rhs_)
+        : lhs(lhs_), rhs(rhs_)
+    {
+        assert(lhs.Size() == rhs.Size());
+    }
+    real operator[] (int i) const
+    {
+        return Op::apply(lhs[i], rhs[i]);
+    }
+    int Size() const
+    {
+        return lhs.Size();
+    }
+};
+
+/// Element-wise combination of an expression with a scalar.
+///
+/// If scalar_first is set, the scalar is the left operand.
+template <typename E, typename Op, bool scalar_first>
+class VectorScalarExpression
+    : public VectorExpression<VectorScalarExpression<E, Op, scalar_first> >
+{
+protected:
+    typename VectorExpressionStorage<E>::type expression;
+    const real scalar;
+public:
+    VectorScalarExpression(const E& expression_, real scalar_)
+        : expression(expression_), scalar(scalar_)
+    {
+    }
+    real operator[] (int i) const
+    {
+        return scalar_first
+            ? Op::apply(scalar, expression[i])
+            : Op::apply(expression[i], scalar);
+    }
+    int Size() const
+    {
+        return expression.Size();
+    }
+};
+
+/// A function applied to each element of an expression.
+template <typename E, typename F>
+class VectorUnaryExpression
+    : public VectorExpression<VectorUnaryExpression<E, F> >
+{
+protected:
+    typename VectorExpressionStorage<E>::type expression;
+public:
+    VectorUnaryExpression(const E& expression_) : expression(expression_)
+    {
+    }
+    real operator[] (int i) const
+    {
+        return F::apply(expression[i]);
+    }
+    int Size() const
+    {
+        return expression.Size();
+    }
+};
+
+/// Operations used by the expressions.
+namespace VectorOperation {
+    struct Add {
+        static real apply(real a, real b) { return a + b; }
+    };
+    struct Subtract {
+        static real apply(real a, real b) { return a - b; }
+    };
+    struct Multiply {
+        static real apply(real a, real b) { return a * b; }
+    };
+    struct Divide {
+        static real apply(real a, real b) { return a / b; }
+    };
+    struct Power {
+        static real apply(real a, real b) { return pow((double) a, (double) b); }
+    };
+    struct Negate {
+        static real apply(real a) { return -a; }
+    };
+    struct Exp {
+        static real apply(real a) { return exp(a); }
+    };
+    struct Log {
+        static real apply(real a) { return log(a); }
+    };
+    struct Abs {
+        static real apply(real a) { return fabs(a); }
+    };
+}
+
+#define VECTOR_EXPRESSION_SCALAR_OPERATOR(OP, NAME)                     \
+    template <typename E>                                               \
+    inline VectorScalarExpression<E, VectorOperation::NAME, false>      \
+    operator OP (const VectorExpression<E>& lhs, const real rhs)        \
+    {                                                                   \
+        return VectorScalarExpression<E, VectorOperation::NAME, false>(lhs.self(), rhs); \
+    }
+
+#define VECTOR_EXPRESSION_OPERATOR(OP, NAME)                            \
+    template <typename L, typename R>                                   \
+    inline VectorBinaryExpression<L, R, VectorOperation::NAME>          \
+    operator OP (const VectorExpression<L>& lhs, const VectorExpression<R>& rhs) \
+    {                                                                   \
+        return VectorBinaryExpression<L, R, VectorOperation::NAME>(lhs.self(), rhs.self()); \
+    }                                                                   \
+    template <typename E>                                               \
+    inline VectorScalarExpression<E, VectorOperation::NAME, true>       \
+    operator OP (const real lhs, const VectorExpression<E>& rhs)        \
+    {                                                                   \
+        return VectorScalarExpression<E, VectorOperation::NAME, true>(rhs.self(), lhs); \
+    }
+
+VECTOR_EXPRESSION_OPERATOR(+, Add)
+VECTOR_EXPRESSION_OPERATOR(-, Subtract)
+VECTOR_EXPRESSION_OPERATOR(*, Multiply)
+VECTOR_EXPRESSION_OPERATOR(/, Divide)
+VECTOR_EXPRESSION_SCALAR_OPERATOR(+, Add)
+VECTOR_EXPRESSION_SCALAR_OPERATOR(-, Subtract)
+VECTOR_EXPRESSION_SCALAR_OPERATOR(*, Multiply)
+
+#undef VECTOR_EXPRESSION_OPERATOR
+#undef VECTOR_EXPRESSION_SCALAR_OPERATOR
+
+/// Division by a scalar multiplies by its inverse, as Vector does.
+template <typename E>
+inline VectorScalarExpression<E, VectorOperation::Multiply, false>
+operator/ (const VectorExpression<E>& lhs, const real rhs)
+{
+    return VectorScalarExpression<E, VectorOperation::Multiply, false>(lhs.self(), 1.0 / rhs);
+}
+
+/// Negation, by element
+template <typename E>
+inline VectorUnaryExpression<E, VectorOperation::Negate>
+operator- (const VectorExpression<E>& rhs)
+{
+    return VectorUnaryExpression<E, VectorOperation::Negate>(rhs.self());
+}
+
+/// Power, by element
+template <typename E>
+inline VectorScalarExpression<E, VectorOperation::Power, false>
+pow (const VectorExpression<E>& rhs, const real p)
+{
+    return VectorScalarExpression<E, VectorOperation::Power, false>(rhs.self(), p);
+}
+
+/// Exponentiation, by element
+template <typename E>
+inline VectorUnaryExpression<E, VectorOperation::Exp>
+exp (const VectorExpression<E>& rhs)
+{
+    return VectorUnaryExpression<E, VectorOperation::Exp>(rhs.self());
+}
+
+/// Logarithm, by element
+template <typename E>
+inline VectorUnaryExpression<E, VectorOperation::Log>
+log (const VectorExpression<E>& rhs)
+{
+    return VectorUnaryExpression<E, VectorOperation::Log>(rhs.self());
+}
+
+/// Absolute value, by element
+template <typename E>
+inline VectorUnaryExpression<E, VectorOperation::Abs>
+abs (const VectorExpression<E>& rhs)
+{
+    return VectorUnaryExpression<E, VectorOperation::Abs>(rhs.self());
+}
+
+/*@}*/
+
+#endif
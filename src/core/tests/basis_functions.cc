@@ -18,6 +18,7 @@
 #include <exception>
 #include <stdexcept>
 #include <vector>
+#include <cmath>
 
 int main(int argc, char** argv)
 {
@@ -43,6 +44,49 @@ int main(int argc, char** argv)
         }
         printf("\n");
     }
+
+    // compare the packed evaluation with single RBFs, and the batch form
+    int n_errors = 0;
+    {
+        int n_dimensions = 3;
+        Vector lower(n_dimensions);
+        Vector upper(n_dimensions);
+        for (int d=0; d<n_dimensions; ++d) {
+            lower[d] = -1;
+            upper[d] = d + 1;
+        }
+        EvenGrid grid(lower, upper, 5);
+        RBFBasisSet grid_basis(grid, 0.5);
+        int T = 10;
+        Matrix S(T, n_dimensions);
+        for (int t=0; t<T; ++t) {
+            for (int d=0; d<n_dimensions; ++d) {
+                S(t, d) = urandom(-1, 3);
+            }
+        }
+        Matrix Phi(1, 1);
+        grid_basis.Evaluate(S, Phi);
+        for (int t=0; t<T; ++t) {
+            Vector s = S.getRow(t);
+            grid_basis.Evaluate(s);
+            for (int i=0; i<grid_basis.size(); ++i) {
+                RBF rbf(grid.getCenter(i), grid.delta * 0.5);
+                real f = rbf.Evaluate(s);
+                if (fabs(grid_basis.F(i) - f) > 1e-12
+                    || fabs(Phi(t, i) - f) > 1e-12) {
+                    printf ("ERROR: point %d, basis %d: %g %g %g\n",
+                            t, i, f, grid_basis.F(i), Phi(t, i));
+                    n_errors++;
+                }
+            }
+        }
+    }
+    if (n_errors) {
+        printf ("# %d ERRORS found\n", n_errors);
+    } else {
+        printf ("# All tests OK\n");
+    }
+    return n_errors;
 }
 
 #endif
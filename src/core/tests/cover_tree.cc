@@ -45,6 +45,72 @@ int test_cover_tree_query(CoverTree& tree, std::vector<Vector>& Q)
     return n_errors;
 }
 
+/// Check that a parallel batch query finds the same nodes
+int test_cover_tree_batch_query(CoverTree& tree, std::vector<Vector>& Q)
+{
+    int n_points = Q.size();
+    Matrix X(n_points, Q[0].Size());
+    for (int i=0; i<n_points; ++i) {
+        X.setRow(i, Q[i]);
+    }
+    std::vector<int> indices;
+    std::vector<real> distances;
+    tree.NearestNeighbours(X, indices, distances, 4);
+    int n_errors = 0;
+    for (int i=0; i<n_points; ++i) {
+        const CoverTree::Node* node = tree.NearestNeighbour(Q[i]);
+        if (node->GetIndex() != indices[i]
+            || node->distanceTo(Q[i]) != distances[i]) {
+            n_errors++;
+            printf ("Batch query mismatch!\n");
+        }
+    }
+    return n_errors;
+}
+
+/// Check the basis weights along the path to the nearest node
+int test_cover_tree_basis(std::vector<Vector>& X, std::vector<Vector>& Q, real c)
+{
+    int n_points = X.size();
+    CoverTree tree(c);
+    for (int i=0; i<n_points; ++i) {
+        tree.Insert(X[i], X[(i + 1) % n_points], 0.0);
+    }
+    tree.SamplingTree();
+    int n_errors = 0;
+    int n_basis = 0;
+    for (uint i=0; i<Q.size(); ++i) {
+        std::vector<std::pair<int, real> > phi = tree.ExternalBasisCreation(Q[i]);
+        uint k = 0;
+        for (const CoverTree::Node* node = tree.NearestNeighbour(Q[i]);
+             node != NULL;
+             node = node->father) {
+            if (!node->GetActiveBasis()) {
+                continue;
+            }
+            real beta = pow(2.0, (real) node->level);
+            Vector d = pow((Q[i] - node->point)/beta, 2.0);
+            if (k >= phi.size()
+                || phi[k].first != node->GetBasisIndex()
+                || phi[k].second != exp(-0.5*d.Sum())) {
+                n_errors++;
+                printf ("Basis weight mismatch!\n");
+            }
+            k++;
+        }
+        if (k != phi.size()) {
+            n_errors++;
+            printf ("Basis path length mismatch!\n");
+        }
+        n_basis += k;
+    }
+    if (!n_basis) {
+        n_errors++;
+        printf ("No basis functions!\n");
+    }
+    return n_errors;
+}
+
 void test_kd_tree_insertion(KDTree<void>& tree, std::vector<Vector>& X)
 {
     int n_points = X.size();
@@ -167,6 +233,8 @@ int main(int argc, char** argv)
                 timer_mid - timer_start,
                 timer_end - timer_mid,
                 timer_end - timer_start);
+        n_cover_tree_failures += test_cover_tree_batch_query(cover_tree, Q);
+        n_cover_tree_failures += test_cover_tree_basis(X, Q, c);
         //n_cover_tree_failures += check_cover_tree_query(cover_tree, X, Q);
         printf ("Errors: %d\n", n_cover_tree_failures);
     }
@@ -0,0 +1,129 @@
+/* -*- Mode: C++; -*- */
+/***************************************************************************
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ ***************************************************************************/
+
+#ifdef MAKE_MAIN
+
+#include "FixedVector.h"
+#include "Vector.h"
+#include "Matrix.h"
+#include "Random.h"
+#include "EasyClock.h"
+
+/// Compare the unrolled kernels with the Vector versions in dimension N.
+template <int N>
+int TestDimension()
+{
+    int n_errors = 0;
+    Vector a(N);
+    Vector b(N);
+    Vector s(N);
+    for (int i=0; i<N; ++i) {
+        a(i) = urandom() - 0.5;
+        b(i) = urandom() - 0.5;
+        s(i) = urandom() + 0.1;
+    }
+    FixedVector<N> fa(a);
+    FixedVector<N> fb(b);
+
+    if (Product(fa, fb) != Product(a, b)
+        || FixedDot(a.x, b.x, N) != Product(a, b)) {
+        fprintf(stderr, "Dot product differs in %d dimensions\n", N);
+        n_errors++;
+    }
+    if (EuclideanNorm(fa, fb) != (a - b).L2Norm()
+        || L1Norm(fa, fb) != (a - b).L1Norm()
+        || FixedL1Norm(a.x, b.x, N) != (a - b).L1Norm()) {
+        fprintf(stderr, "Norms differ in %d dimensions\n", N);
+        n_errors++;
+    }
+    real r = 0;
+    for (int i=0; i<N; ++i) {
+        real d = (a(i) - b(i)) / s(i);
+        r += d * d;
+    }
+    if (FixedScaledSquareNorm(a.x, b.x, s.x, N) != r) {
+        fprintf(stderr, "Scaled norm differs in %d dimensions\n", N);
+        n_errors++;
+    }
+
+    FixedMatrix<N, N> A;
+    Matrix B(N, N);
+    for (int i=0; i<N; ++i) {
+        for (int j=0; j<N; ++j) {
+            A(i, j) = B(i, j) = urandom();
+        }
+    }
+    Vector Ba = B * a;
+    Matrix BB = Transpose(B) * B;
+    FixedVector<N> Aa = A * fa;
+    FixedMatrix<N, N> AA = Transpose(A) * A;
+    real error = 0;
+    for (int i=0; i<N; ++i) {
+        error += fabs(Aa(i) - Ba(i));
+        for (int j=0; j<N; ++j) {
+            error += fabs(AA(i, j) - BB(i, j));
+        }
+    }
+    if (error > 1e-12) {
+        fprintf(stderr, "Matrix products differ by %g in %d dimensions\n",
+                error, N);
+        n_errors++;
+    }
+    return n_errors;
+}
+
+int main()
+{
+    int n_errors = 0;
+    n_errors += TestDimension<1>();
+    n_errors += TestDimension<2>();
+    n_errors += TestDimension<3>();
+    n_errors += TestDimension<4>();
+    n_errors += TestDimension<5>();
+    n_errors += TestDimension<6>();
+    n_errors += TestDimension<9>();
+
+    {
+        int T = 10000000;
+        Vector a(4);
+        Vector b(4);
+        for (int i=0; i<4; ++i) {
+            a(i) = urandom();
+            b(i) = urandom();
+        }
+        Vector a0 = a;
+        real sum = 0;
+        double start_time = GetCPU();
+        for (int t=0; t<T; ++t) {
+            a(t & 3) += 1e-9;
+            sum += FixedSquareNorm(a.x, b.x, 4);
+        }
+        double end_time = GetCPU();
+        printf("Fixed: %f s (%f)\n", end_time - start_time, sum);
+        a = a0;
+        sum = 0;
+        start_time = GetCPU();
+        for (int t=0; t<T; ++t) {
+            a(t & 3) += 1e-9;
+            sum += pow(Lazy(a) - b, 2.0).Sum();
+        }
+        end_time = GetCPU();
+        printf("Vector: %f s (%f)\n", end_time - start_time, sum);
+    }
+
+    if (n_errors) {
+        printf ("# %d ERRORS found\n", n_errors);
+    } else {
+        printf ("# All tests OK\n");
+    }
+    return n_errors;
+}
+
+#endif
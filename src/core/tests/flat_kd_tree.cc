@@ -0,0 +1,391 @@
+/* -*- Mode: C++; -*- */
+/***************************************************************************
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ ***************************************************************************/
+
+#ifdef MAKE_MAIN
+
+#include "FlatKDTree.h"
+#include "KDTree.h"
+#include "Random.h"
+#include "EasyClock.h"
+#include <vector>
+#include <algorithm>
+
+typedef std::vector<std::pair<real, int> > NeighbourList;
+
+/// Check that the tree search gives the same distances as linear search.
+int CompareWithLinear(const FlatKDTree<int>& tree, const Vector& x, int K)
+{
+    NeighbourList knn;
+    NeighbourList knn_linear;
+    tree.FindKNearestNeighbours(x, K, knn);
+    tree.FindKNearestNeighboursLinear(x, K, knn_linear);
+    if (knn.size() != knn_linear.size()) {
+        printf ("MISMATCH: %d vs %d neighbours\n",
+                (int) knn.size(), (int) knn_linear.size());
+        return 1;
+    }
+    for (uint k=0; k<knn.size(); ++k) {
+        if (knn[k].first != knn_linear[k].first) {
+            printf ("MISMATCH (%d): %f %f\n", k, knn[k].first, knn_linear[k].first);
+            return 1;
+        }
+    }
+    return 0;
+}
+
+int flat_kd_tree_test(int n_points, int n_dimensions)
+{
+    printf ("# Testing with %d points and %d dimensions\n", n_points, n_dimensions);
+    Matrix X(n_points, n_dimensions);
+    std::vector<int> number(n_points);
+    std::vector<int*> objects(n_points);
+    for (int i=0; i<n_points; i++) {
+        for (int j=0; j<n_dimensions; j++) {
+            X(i, j) = urandom();
+        }
+        number[i] = i;
+        objects[i] = &number[i];
+    }
+
+    FlatKDTree<int> tree(n_dimensions);
+    tree.Build(X, objects);
+    FlatKDTree<int> incremental_tree(n_dimensions);
+    for (int i=0; i<n_points; i++) {
+        incremental_tree.AddVectorObject(X.getRow(i), &number[i]);
+    }
+    printf ("# Blocks: %d\n", incremental_tree.getNumberOfBlocks());
+
+    int n_errors = 0;
+    for (int i=0; i<n_points; i++) {
+        Vector x = X.getRow(i);
+        if (*tree.FindNearestObject(x) != i
+            || *incremental_tree.FindNearestObject(x) != i) {
+            printf ("MISMATCH: point %d not found\n", i);
+            n_errors++;
+        }
+    }
+
+    for (int i=0; i<n_points; i++) {
+        Vector x(n_dimensions);
+        for (int j=0; j<n_dimensions; ++j) {
+            x[j] = urandom();
+        }
+        int K = (int) ceil(urandom(1,10));
+        n_errors += CompareWithLinear(tree, x, K);
+        n_errors += CompareWithLinear(incremental_tree, x, K);
+
+        real r = 0.5 * urandom();
+        NeighbourList in_radius;
+        tree.FindNeighboursWithinRadius(x, r, in_radius);
+        int n_in_radius = 0;
+        for (int k=0; k<n_points; ++k) {
+            Vector y = X.getRow(k);
+            if (SquareNorm(&x, &y) <= r * r) {
+                n_in_radius++;
+            }
+        }
+        if (n_in_radius != (int) in_radius.size()) {
+            printf ("MISMATCH: %d points within %f, found %d\n",
+                    n_in_radius, r, (int) in_radius.size());
+            n_errors++;
+        }
+    }
+    return n_errors;
+}
+
+/// Check that batch queries on both trees match single queries.
+int batch_query_test(int n_points, int n_dimensions, int K, int n_threads)
+{
+    printf ("# Testing batch queries with %d threads\n", n_threads);
+    Matrix X(n_points, n_dimensions);
+    std::vector<int> number(n_points);
+    std::vector<int*> objects(n_points);
+    KDTree<int> kd_tree(n_dimensions);
+    for (int i=0; i<n_points; i++) {
+        for (int j=0; j<n_dimensions; j++) {
+            X(i, j) = urandom();
+        }
+        number[i] = i;
+        objects[i] = &number[i];
+        kd_tree.AddVectorObject(X.getRow(i), &number[i]);
+    }
+    FlatKDTree<int> tree(n_dimensions);
+    tree.Build(X, objects);
+
+    int n_queries = 500;
+    Matrix Z(n_queries, n_dimensions);
+    for (int i=0; i<n_queries; ++i) {
+        for (int j=0; j<n_dimensions; ++j) {
+            Z(i, j) = urandom();
+        }
+    }
+    std::vector<int> indices;
+    std::vector<real> distances;
+    std::vector<int> kd_indices;
+    std::vector<real> kd_distances;
+    tree.FindKNearestNeighbours(Z, K, indices, distances, n_threads);
+    kd_tree.FindKNearestNeighbours(Z, K, kd_indices, kd_distances, n_threads);
+
+    int n_errors = 0;
+    for (int i=0; i<n_queries; ++i) {
+        NeighbourList knn;
+        tree.FindKNearestNeighbours(Z.getRow(i), K, knn);
+        OrderedFixedList<KDNode> knn_list = kd_tree.FindKNearestNeighbours(Z.getRow(i), K);
+        KDTree<int>::iterator it = knn_list.S.begin();
+        for (int k=0; k<K; ++k, ++it) {
+            if (indices[i * K + k] != knn[k].second
+                || distances[i * K + k] != knn[k].first
+                || *kd_tree.getObject(kd_indices[i * K + k]) != *kd_tree.getObject(it->second)
+                || kd_distances[i * K + k] != it->first) {
+                printf ("MISMATCH: query %d, neighbour %d\n", i, k);
+                n_errors++;
+            }
+        }
+    }
+    return n_errors;
+}
+
+/// Check the accuracy guarantee and the work done by approximate search.
+int approximate_search_test(int n_points, int n_dimensions, int K, real epsilon)
+{
+    printf ("# Testing approximate search with epsilon = %f\n", epsilon);
+    Matrix X(n_points, n_dimensions);
+    std::vector<int> number(n_points);
+    std::vector<int*> objects(n_points);
+    for (int i=0; i<n_points; i++) {
+        for (int j=0; j<n_dimensions; j++) {
+            X(i, j) = urandom();
+        }
+        number[i] = i;
+        objects[i] = &number[i];
+    }
+    FlatKDTree<int> tree(n_dimensions);
+    tree.Build(X, objects);
+
+    int n_queries = 500;
+    Matrix Z(n_queries, n_dimensions);
+    for (int i=0; i<n_queries; ++i) {
+        for (int j=0; j<n_dimensions; ++j) {
+            Z(i, j) = urandom();
+        }
+    }
+    KNNSearchStatistics exact_statistics;
+    KNNSearchStatistics approximate_statistics;
+    int n_errors = 0;
+    for (int i=0; i<n_queries; ++i) {
+        Vector z = Z.getRow(i);
+        NeighbourList knn;
+        NeighbourList knn_exact;
+        NeighbourList knn_approximate;
+        tree.FindKNearestNeighbours(z, K, knn);
+        tree.FindKNearestNeighbours(z, K, KNNSearchMode(), knn_exact, &exact_statistics);
+        tree.FindKNearestNeighbours(z, K, KNNSearchMode(epsilon), knn_approximate,
+                                    &approximate_statistics);
+        for (int k=0; k<K; ++k) {
+            if (knn_exact[k].first != knn[k].first) {
+                printf ("MISMATCH: query %d, neighbour %d: %f %f\n",
+                        i, k, knn_exact[k].first, knn[k].first);
+                n_errors++;
+            }
+        }
+        real bound = (1 + epsilon) * (1 + epsilon) * knn[K - 1].first;
+        if (knn_approximate[K - 1].first > bound) {
+            printf ("ERROR: query %d: %f > %f\n", i, knn_approximate[K - 1].first, bound);
+            n_errors++;
+        }
+    }
+
+    std::vector<int> indices;
+    std::vector<real> distances;
+    KNNSearchStatistics batch_statistics;
+    tree.FindKNearestNeighbours(Z, K, indices, distances, 4,
+                                KNNSearchMode(epsilon), &batch_statistics);
+    if (batch_statistics.n_nodes != approximate_statistics.n_nodes
+        || batch_statistics.n_queries != n_queries) {
+        printf ("ERROR: batch search visited %ld nodes, single queries %ld\n",
+                batch_statistics.n_nodes, approximate_statistics.n_nodes);
+        n_errors++;
+    }
+
+    printf ("# Nodes per query: exact %f, approximate %f\n",
+            (real) exact_statistics.n_nodes / (real) n_queries,
+            (real) approximate_statistics.n_nodes / (real) n_queries);
+    if (epsilon > 0 && approximate_statistics.n_nodes >= exact_statistics.n_nodes) {
+        printf ("ERROR: approximate search is not cheaper\n");
+        n_errors++;
+    }
+
+    KNNSearchStatistics budget_statistics;
+    NeighbourList knn_budget;
+    tree.FindKNearestNeighbours(Z.getRow(0), K, KNNSearchMode(0, 2), knn_budget,
+                                &budget_statistics);
+    if (budget_statistics.n_leaves > 2 || (int) knn_budget.size() != K) {
+        printf ("ERROR: %ld leaves visited with a budget of 2\n",
+                budget_statistics.n_leaves);
+        n_errors++;
+    }
+    return n_errors;
+}
+
+/// Check that pruned kernel sums are within the tolerance of the exact ones.
+int kernel_sum_test(int n_points, int n_dimensions, real bandwidth, real tolerance)
+{
+    printf ("# Testing kernel sums with bandwidth %f\n", bandwidth);
+    FlatKDTree<int> tree(n_dimensions);
+    for (int i=0; i<n_points; i++) {
+        Vector x(n_dimensions);
+        for (int j=0; j<n_dimensions; j++) {
+            x(j) = urandom();
+        }
+        tree.AddVectorObject(x, NULL);
+    }
+    int n_errors = 0;
+    int n_used = 0;
+    for (int i=0; i<100; ++i) {
+        Vector x(n_dimensions);
+        for (int j=0; j<n_dimensions; ++j) {
+            x(j) = 2 * urandom() - 0.5;
+        }
+        NeighbourList all;
+        NeighbourList pruned;
+        tree.FindKernelNeighbours(x, bandwidth, 0, all);
+        tree.FindKernelNeighbours(x, bandwidth, tolerance, pruned);
+        n_used += pruned.size();
+        real log_sum = LOG_ZERO;
+        for (uint k=0; k<all.size(); ++k) {
+            log_sum = logAdd(log_sum, -0.5 * all[k].first / (bandwidth * bandwidth));
+        }
+        real log_exact = tree.LogKernelSum(x, bandwidth, 0);
+        real log_pruned = tree.LogKernelSum(x, bandwidth, tolerance);
+        if ((int) all.size() != n_points
+            || fabs(log_exact - log_sum) > 1e-9
+            || log_pruned > log_exact + 1e-9
+            || log_pruned < log_exact + log(1 - tolerance) - 1e-9) {
+            printf ("ERROR: %d points, log sums %f %f %f\n",
+                    (int) all.size(), log_sum, log_exact, log_pruned);
+            n_errors++;
+        }
+    }
+    printf ("# Points used: %f\n", (real) n_used / 100.0);
+    return n_errors;
+}
+
+/// Check that pairs are disjoint and that the closest pair comes first.
+int pair_test(int n_points, int n_dimensions)
+{
+    printf ("# Testing nearest neighbour pairs\n");
+    Matrix X(n_points, n_dimensions);
+    FlatKDTree<int> tree(n_dimensions);
+    for (int i=0; i<n_points; i++) {
+        for (int j=0; j<n_dimensions; j++) {
+            X(i, j) = urandom();
+        }
+        tree.AddVectorObject(X.getRow(i), NULL);
+    }
+    int n_errors = 0;
+    std::vector<std::pair<int, int> > pairs;
+    tree.PairNearestNeighbours(n_points / 4, pairs);
+    if ((int) pairs.size() != n_points / 4) {
+        printf ("ERROR: %d pairs found, %d wanted\n", (int) pairs.size(), n_points / 4);
+        n_errors++;
+    }
+    std::vector<int> n_paired(n_points, 0);
+    for (uint k=0; k<pairs.size(); ++k) {
+        n_paired[pairs[k].first]++;
+        n_paired[pairs[k].second]++;
+    }
+    for (int i=0; i<n_points; ++i) {
+        if (n_paired[i] > 1) {
+            printf ("ERROR: point %d paired %d times\n", i, n_paired[i]);
+            n_errors++;
+        }
+    }
+    real d2_closest = INF;
+    for (int i=0; i<n_points; ++i) {
+        for (int j=i+1; j<n_points; ++j) {
+            Vector x = X.getRow(i);
+            Vector y = X.getRow(j);
+            d2_closest = std::min(d2_closest, SquareNorm(&x, &y));
+        }
+    }
+    Vector x = X.getRow(pairs[0].first);
+    Vector y = X.getRow(pairs[0].second);
+    if (SquareNorm(&x, &y) != d2_closest) {
+        printf ("ERROR: first pair at %f, closest at %f\n", SquareNorm(&x, &y), d2_closest);
+        n_errors++;
+    }
+    return n_errors;
+}
+
+/// Compare query times with the pointer-based KDTree
+void flat_kd_tree_timing(int n_points, int n_dimensions, int K)
+{
+    Matrix X(n_points, n_dimensions);
+    std::vector<int> number(n_points);
+    std::vector<int*> objects(n_points);
+    KDTree<int> kd_tree(n_dimensions);
+    for (int i=0; i<n_points; i++) {
+        for (int j=0; j<n_dimensions; j++) {
+            X(i, j) = urandom();
+        }
+        number[i] = i;
+        objects[i] = &number[i];
+        kd_tree.AddVectorObject(X.getRow(i), &number[i]);
+    }
+    FlatKDTree<int> tree(n_dimensions);
+    tree.Build(X, objects);
+
+    int n_queries = 10000;
+    std::vector<Vector> Z(n_queries);
+    for (int i=0; i<n_queries; ++i) {
+        Z[i].Resize(n_dimensions);
+        for (int j=0; j<n_dimensions; ++j) {
+            Z[i][j] = urandom();
+        }
+    }
+    double start_time = GetCPU();
+    for (int i=0; i<n_queries; ++i) {
+        OrderedFixedList<KDNode> knn_list = kd_tree.FindKNearestNeighbours(Z[i], K);
+    }
+    double end_time = GetCPU();
+    printf ("# KDTree: %f s\n", end_time - start_time);
+    start_time = GetCPU();
+    NeighbourList knn;
+    for (int i=0; i<n_queries; ++i) {
+        tree.FindKNearestNeighbours(Z[i], K, knn);
+    }
+    end_time = GetCPU();
+    printf ("# FlatKDTree: %f s\n", end_time - start_time);
+}
+
+int main(void)
+{
+    int n_errors = 0;
+    n_errors += flat_kd_tree_test(1000, 1);
+    n_errors += flat_kd_tree_test(1000, 3);
+    n_errors += flat_kd_tree_test(2000, 8);
+    n_errors += batch_query_test(1000, 3, 5, 1);
+    n_errors += batch_query_test(1000, 3, 5, 4);
+    n_errors += approximate_search_test(5000, 4, 5, 0.5);
+    n_errors += approximate_search_test(5000, 8, 10, 1.0);
+    n_errors += kernel_sum_test(5000, 2, 0.01, 1e-6);
+    n_errors += kernel_sum_test(5000, 3, 0.1, 1e-3);
+    n_errors += pair_test(1000, 3);
+    flat_kd_tree_timing(100000, 4, 10);
+
+    if (n_errors) {
+        printf ("# %d ERRORS found\n", n_errors);
+    } else {
+        printf ("# All tests OK\n");
+    }
+    return n_errors;
+}
+
+#endif
@@ -281,6 +281,268 @@ int main()
 		fprintf(stderr, "-------- ERROR END --------\n");
 	}
 
+    {
+        printf("Testing BLAS routines against loops.\n");
+        int K = 2 * MATRIX_BLAS_THRESHOLD;
+        Matrix X(K, K);
+        Vector v(K);
+        for (int i=0; i<K; ++i) {
+            v(i) = urandom();
+            for (int j=0; j<K; ++j) {
+                X(i,j) = urandom() - 0.5;
+            }
+        }
+        Matrix XX = Transpose(X) * X;
+        Vector Xv = Transpose(X) * v;
+        real product_error = 0;
+        for (int i=0; i<K; ++i) {
+            real s = 0;
+            for (int j=0; j<K; ++j) {
+                real sum = 0;
+                for (int k=0; k<K; ++k) {
+                    sum += X(k,i) * X(k,j);
+                }
+                product_error += fabs(sum - XX(i,j));
+                s += X(j,i) * v(j);
+            }
+            product_error += fabs(s - Xv(i));
+        }
+        if (product_error > 1e-6) {
+            fprintf(stderr, "BLAS products differ by %f\n", product_error);
+            n_errors++;
+        }
+
+        Matrix A = XX + Matrix::Unity(K, K);
+        Matrix U = A.Cholesky();
+        real chol_error = FrobeniusNorm(Transpose(U) * U - A);
+        for (int i=1; i<K; ++i) {
+            for (int j=0; j<i; ++j) {
+                chol_error += fabs(U(i,j));
+            }
+        }
+        if (chol_error > 1e-6) {
+            fprintf(stderr, "Cholesky factor is wrong by %f\n", chol_error);
+            n_errors++;
+        }
+        Matrix I = Matrix::Unity(K, K);
+        real lu_error = FrobeniusNorm(A * A.Inverse_LU() - I);
+        real ch_error = FrobeniusNorm(A * A.Inverse_Cholesky() - I);
+        if (lu_error > 1e-6 || ch_error > 1e-6) {
+            fprintf(stderr, "BLAS inverses are off by %f (LU), %f (Cholesky)\n",
+                    lu_error, ch_error);
+            n_errors++;
+        }
+    }
+
+    {
+        printf("Testing in-place appends against AddRow/AddColumn.\n");
+        int K = 20;
+        Matrix A(0, 3);
+        Matrix B(0, 3);
+        for (int i=0; i<K; ++i) {
+            Vector v(3);
+            for (int j=0; j<3; ++j) {
+                v(j) = urandom();
+            }
+            A.AppendRow(v);
+            B = B.AddRow(v);
+        }
+        if (A.Rows() != K || A.Capacity() >= 4 * K * 3) {
+            fprintf(stderr, "AppendRow: %d rows, capacity %d\n",
+                    A.Rows(), A.Capacity());
+            n_errors++;
+        }
+        for (int i=0; i<4; ++i) {
+            Vector c(K);
+            for (int j=0; j<K; ++j) {
+                c(j) = urandom();
+            }
+            A.AppendColumn(c);
+            B = B.AddColumn(c);
+        }
+        Matrix C = A;
+        C.Transpose();
+        C.AppendColumn(A.getRow(0));
+        real append_error = FrobeniusNorm(A - B)
+            + EuclideanNorm(C.getColumn(K), C.getColumn(0));
+        if (A.Columns() != 7 || C.Columns() != K + 1 || append_error > 0) {
+            fprintf(stderr, "Appends differ by %f\n", append_error);
+            n_errors++;
+        }
+    }
+
+    {
+        printf("Testing block outer products and LU_Solve.\n");
+        int N = 8;
+        Matrix A = Matrix::Unity(N, N) * 2.0;
+        Vector u(3);
+        Vector v(5);
+        for (int i=0; i<u.Size(); ++i) {
+            u(i) = urandom();
+        }
+        for (int i=0; i<v.Size(); ++i) {
+            v(i) = urandom();
+        }
+        Matrix B = A;
+        A.AddOuterProduct(0.5, u, v, 2, 3);
+        Matrix D = OuterProduct(u, v) * 0.5;
+        for (int i=0; i<u.Size(); ++i) {
+            for (int j=0; j<v.Size(); ++j) {
+                B(2 + i, 3 + j) += D(i, j);
+            }
+        }
+        Vector b(N);
+        for (int i=0; i<N; ++i) {
+            b(i) = urandom();
+        }
+        Vector x = A.LU_Solve(b);
+        real solve_error = FrobeniusNorm(A - B) + EuclideanNorm(A * x, b);
+        if (solve_error > 1e-12) {
+            fprintf(stderr, "Outer product and solve are off by %g\n", solve_error);
+            n_errors++;
+        }
+    }
+
+    {
+        printf("Testing moves and arithmetic on temporaries.\n");
+        int M = 3;
+        int N = 4;
+        real c = 2.5;
+        Matrix A(M, N);
+        Matrix B(M, N);
+        Matrix At(N, M);
+        for (int i=0; i<M; ++i) {
+            for (int j=0; j<N; ++j) {
+                A(i, j) = urandom() - 0.5;
+                B(i, j) = urandom() - 0.5;
+                At(j, i) = A(i, j);
+            }
+        }
+        Matrix A_copy = A;
+        Matrix At_copy = At;
+        Matrix sum(M, N), difference(M, N), scaled(M, N);
+        Matrix shifted(M, N), lowered(M, N), divided(M, N);
+        for (int i=0; i<M; ++i) {
+            for (int j=0; j<N; ++j) {
+                sum(i, j) = A(i, j) + B(i, j);
+                difference(i, j) = A(i, j) - B(i, j);
+                scaled(i, j) = A(i, j) * c;
+                shifted(i, j) = A(i, j) + c;
+                lowered(i, j) = A(i, j) - c;
+                divided(i, j) = A(i, j) * (1.0 / c); // as operator/ does
+            }
+        }
+        int n_wrong = 0;
+        n_wrong += (Matrix(A) + B) != sum;
+        n_wrong += (Matrix(A) - B) != difference;
+        n_wrong += (Matrix(A) * c) != scaled;
+        n_wrong += (c * Matrix(A)) != scaled;
+        n_wrong += (Matrix(A) + c) != shifted;
+        n_wrong += (Matrix(A) - c) != lowered;
+        n_wrong += (Matrix(A) / c) != divided;
+        n_wrong += (A + B) != sum;
+        n_wrong += (Transpose(At) + B) != sum;
+        n_wrong += (Transpose(At) * c) != scaled;
+        n_wrong += (A != A_copy) + (At != At_copy);
+        if (n_wrong) {
+            fprintf(stderr, "%d operators on temporaries are wrong\n", n_wrong);
+            n_errors++;
+        }
+
+        Matrix C = A;
+        Matrix D(std::move(C));
+        if (D != A || C.Rows() != 0 || C.Columns() != 0) {
+            fprintf(stderr, "Move constructor failed\n");
+            n_errors++;
+        }
+        C = B;
+        Matrix E(1, 1);
+        E = std::move(C);
+        if (E != B || C.Rows() != 0 || C.Columns() != 0) {
+            fprintf(stderr, "Move assignment failed\n");
+            n_errors++;
+        }
+        C = A;
+        if (C != A) {
+            fprintf(stderr, "Moved-from matrix cannot be reused\n");
+            n_errors++;
+        }
+
+        Matrix checked(M, N, Matrix::CHECK_BOUNDS);
+        Matrix unchecked(1, 1, Matrix::NO_CHECK_BOUNDS);
+        unchecked = std::move(checked);
+        bool thrown = false;
+        try {
+            unchecked(M, N) = 1.0;
+        } catch (std::out_of_range& e) {
+            thrown = true;
+        }
+        if (!thrown) {
+            fprintf(stderr, "Move assignment lost the bounds check\n");
+            n_errors++;
+        }
+    }
+
+    {
+        printf("Testing copies and rows of transposed matrices.\n");
+        int M = 2;
+        int N = 3;
+        Matrix A(M, N, Matrix::CHECK_BOUNDS);
+        for (int i=0; i<M; ++i) {
+            for (int j=0; j<N; ++j) {
+                A(i, j) = 10 * i + j;
+            }
+        }
+        Matrix At = Transpose(A);
+        Matrix copy(At);
+        if (copy.Rows() != N || copy.Columns() != M) {
+            fprintf(stderr, "Copy of the transpose is %d x %d\n",
+                    copy.Rows(), copy.Columns());
+            n_errors++;
+        } else {
+            int n_wrong = 0;
+            for (int i=0; i<N; ++i) {
+                for (int j=0; j<M; ++j) {
+                    n_wrong += copy(i, j) != A(j, i);
+                }
+                Vector row = copy.getRow(i);
+                if (row.Size() != M) {
+                    n_wrong++;
+                } else {
+                    for (int j=0; j<M; ++j) {
+                        n_wrong += row(j) != A(j, i);
+                    }
+                }
+            }
+            if (n_wrong) {
+                fprintf(stderr, "%d elements of the copied transpose are wrong\n", n_wrong);
+                n_errors++;
+            }
+        }
+        int n_unchecked = 0;
+        int bad_rows[] = {-1, N};
+        for (int k=0; k<2; ++k) {
+            bool thrown = false;
+            try {
+                copy.getRow(bad_rows[k]);
+            } catch (std::out_of_range& e) {
+                thrown = true;
+            }
+            n_unchecked += !thrown;
+            thrown = false;
+            try {
+                A.getRow(bad_rows[k] < 0 ? -1 : M);
+            } catch (std::out_of_range& e) {
+                thrown = true;
+            }
+            n_unchecked += !thrown;
+        }
+        if (n_unchecked) {
+            fprintf(stderr, "%d bad rows were read without an exception\n", n_unchecked);
+            n_errors++;
+        }
+    }
+
     if (n_errors) {
         printf ("# %d ERRORS found\n", n_errors);
     } else {
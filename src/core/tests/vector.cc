@@ -13,11 +13,164 @@
 
 #include "Vector.h"
 #include "EasyClock.h"
+#include <stdexcept>
 #include <gsl/gsl_blas.h>
 #include <gsl/gsl_vector.h>
 
+/// Check that v holds 0, 1, ..., n-1, times scale.
+int check_ramp(const Vector& v, int n, real scale, const char* what)
+{
+    int n_errors = 0;
+    if (v.Size() != n) {
+        printf ("ERROR: %s: size %d, expected %d\n", what, v.Size(), n);
+        return 1;
+    }
+    for (int i=0; i<n; ++i) {
+        if (v(i) != scale * (real) i) {
+            n_errors++;
+        }
+    }
+    if (n_errors) {
+        printf ("ERROR: %s: %d wrong elements\n", what, n_errors);
+    }
+    return n_errors;
+}
+
+Vector ramp(int n, real scale = 1.0)
+{
+    Vector v(n);
+    for (int i=0; i<n; ++i) {
+        v(i) = scale * (real) i;
+    }
+    return v;
+}
+
+/// Test growth, resizing, copying and moving between inline and heap storage.
+int storage_test()
+{
+    int n_errors = 0;
+    int small = VECTOR_INLINE_SIZE / 2;
+    int large = 4 * VECTOR_INLINE_SIZE;
+
+    // grow one element at a time past the inline size
+    Vector grown;
+    for (int i=0; i<large; ++i) {
+        grown.AddElement((real) i);
+        n_errors += check_ramp(grown, i + 1, 1.0, "AddElement");
+    }
+
+    // resizing keeps the leading elements, in both directions
+    Vector resized = ramp(small);
+    resized.Resize(VECTOR_INLINE_SIZE);
+    n_errors += check_ramp(Vector(small, resized.x), small, 1.0, "Resize to inline size");
+    resized.Resize(large);
+    n_errors += check_ramp(Vector(small, resized.x), small, 1.0, "Resize to heap");
+    for (int i=0; i<large; ++i) {
+        resized(i) = (real) i;
+    }
+    resized.Resize(small);
+    n_errors += check_ramp(resized, small, 1.0, "Resize back down");
+    resized.Resize(large);
+    n_errors += check_ramp(Vector(small, resized.x), small, 1.0, "Resize within capacity");
+
+    // copies between all combinations of inline and heap vectors
+    int sizes[] = {small, large};
+    for (int i=0; i<2; ++i) {
+        for (int j=0; j<2; ++j) {
+            Vector src = ramp(sizes[i]);
+            Vector copy(src);
+            n_errors += check_ramp(copy, sizes[i], 1.0, "copy constructor");
+            Vector dst = ramp(sizes[j], 2.0);
+            dst = src;
+            n_errors += check_ramp(dst, sizes[i], 1.0, "copy assignment");
+            src(0) = -1.0;
+            if (copy(0) != 0.0 || dst(0) != 0.0) {
+                printf ("ERROR: copies of a %d-vector share storage\n", sizes[i]);
+                n_errors++;
+            }
+        }
+    }
+
+    // moves between all combinations of inline and heap vectors
+    for (int i=0; i<2; ++i) {
+        for (int j=0; j<2; ++j) {
+            Vector src = ramp(sizes[i]);
+            Vector moved(std::move(src));
+            n_errors += check_ramp(moved, sizes[i], 1.0, "move constructor");
+            Vector other = ramp(sizes[i]);
+            Vector dst = ramp(sizes[j], 2.0);
+            dst = std::move(other);
+            n_errors += check_ramp(dst, sizes[i], 1.0, "move assignment");
+            // moved-from vectors must remain usable
+            src = ramp(sizes[j], 3.0);
+            n_errors += check_ramp(src, sizes[j], 3.0, "reuse after move");
+            other.Resize(large);
+            other(large - 1) = 1.0;
+            src(0) = -1.0;
+            n_errors += check_ramp(moved, sizes[i], 1.0, "move constructor after reuse");
+            n_errors += check_ramp(dst, sizes[i], 1.0, "move assignment after reuse");
+        }
+    }
+    return n_errors;
+}
+
+/// Test that the operators on temporaries agree with the ones on named vectors.
+int rvalue_test()
+{
+    int n_errors = 0;
+    int sizes[] = {VECTOR_INLINE_SIZE / 2, 4 * VECTOR_INLINE_SIZE};
+    for (int k=0; k<2; ++k) {
+        int n = sizes[k];
+        real c = 2.5;
+        Vector a = ramp(n, 0.5) + 1.0;
+        Vector b = ramp(n, 0.25) + 2.0;
+        Vector a_copy = a;
+        int n_wrong = 0;
+        n_wrong += !(Vector(a) + b == a + b);
+        n_wrong += !(Vector(a) - b == a - b);
+        n_wrong += !(Vector(a) * b == a * b);
+        n_wrong += !(Vector(a) / b == a / b);
+        n_wrong += !(Vector(a) + c == a + c);
+        n_wrong += !(Vector(a) - c == a - c);
+        n_wrong += !(Vector(a) * c == a * c);
+        n_wrong += !(Vector(a) / c == a / c);
+        n_wrong += !(-Vector(a) == -a);
+        Vector named_sum = a + b;
+        Vector named_product = named_sum * c;
+        n_wrong += !((a + b) * c == named_product);
+        n_wrong += !(a == a_copy);
+        for (int i=0; i<n; ++i) {
+            real sum = a(i) + b(i);
+            if ((Vector(a) + b)(i) != sum || (a + b + c)(i) != sum + c) {
+                n_wrong++;
+            }
+        }
+        if (n_wrong) {
+            printf ("ERROR: %d operators on temporary %d-vectors are wrong\n", n_wrong, n);
+            n_errors++;
+        }
+        // a moved vector keeps its bounds checking
+        Vector checked(n, Vector::CHECK_BOUNDS);
+        Vector unchecked(1, Vector::NO_CHECK_BOUNDS);
+        unchecked = std::move(checked);
+        bool thrown = false;
+        try {
+            unchecked(n) = 1.0;
+        } catch (std::out_of_range& e) {
+            thrown = true;
+        }
+        if (!thrown) {
+            printf ("ERROR: move assignment lost the bounds check\n");
+            n_errors++;
+        }
+    }
+    return n_errors;
+}
+
 int main(int argc, char** argv)
 {
+    int n_errors = storage_test();
+    n_errors += rvalue_test();
     
     int N = 100000;
     int iter=100;
@@ -45,6 +198,29 @@ int main(int argc, char** argv)
         logmsg("total time %f\n", total_time);
     }
 
+    {
+        double total_time = 0.0;
+        Vector z(N);
+        for (int k=0; k<10000; ++k) {
+            double start_time = GetCPU();
+            z = pow((Lazy(x) - y) / 2.0, 2.0) + x * 3.0;
+            double end_time = GetCPU();
+            total_time += end_time - start_time;
+        }
+        logmsg("lazy total time %f\n", total_time);
+        Vector w = pow((x - y) / 2.0, 2.0) + x * 3.0;
+        for (int i=0; i<N; ++i) {
+            if (w(i) != z(i)) {
+                n_errors++;
+            }
+        }
+        if (pow(Lazy(x) - y, 2.0).Sum() != pow(x - y, 2.0).Sum()) {
+            n_errors++;
+        }
+        if (((Lazy(x) - y) / 3.0).SquareNorm() != ((x - y) / 3.0).SquareNorm()) {
+            n_errors++;
+        }
+    }
 
 
     {
@@ -65,7 +241,12 @@ int main(int argc, char** argv)
 
     gsl_vector_free(gx);
     gsl_vector_free(gy);
-    return 0;
+    if (n_errors) {
+        printf ("# %d ERRORS found\n", n_errors);
+    } else {
+        printf ("# All tests OK\n");
+    }
+    return n_errors;
 }
 
 #endif
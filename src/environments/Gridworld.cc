@@ -287,6 +287,7 @@ DiscreteMDP* Gridworld::getMDP()  const
 
     //mdp->ShowModel();
     mdp->Check();
+    mdp->Freeze();
     return mdp;
 }
 
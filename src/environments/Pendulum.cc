@@ -92,7 +92,7 @@ void Pendulum::Reset()
   endsim = false;
 }
 
-void Pendulum::penddot(Vector& xdot, real u, Vector& x)
+void Pendulum::penddot(FixedVector<2>& xdot, real u, const FixedVector<2>& x)
 {
   // Nonlinear model 
      
@@ -124,7 +124,8 @@ bool Pendulum::Act(const int& action)
 
 void Pendulum::Simulate(const int action)
 {
-  Vector xdot(2);
+  FixedVector<2> xdot;
+  FixedVector<2> x(state);
   real input=0.0, noise, t;
 
   //printf ("# s: %f %f, a: %d\n", state[0], state[1], action);
@@ -140,12 +141,13 @@ void Pendulum::Simulate(const int action)
   // Simulate for 0.1 seconds
   for (t=0.0; t<=0.1; t+=parameters.Dt) {
 
-    penddot(xdot, input, state);
+    penddot(xdot, input, x);
     
-    state[0] += xdot[0] * parameters.Dt;
-    state[1] += xdot[1] * parameters.Dt;
+    x[0] += xdot[0] * parameters.Dt;
+    x[1] += xdot[1] * parameters.Dt;
 
   }
+  x.CopyTo(state);
   
   if (fabs(state[0]) > M_PI/2.0) {
     reward = -1.0;
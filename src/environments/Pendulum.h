@@ -16,6 +16,7 @@
 
 #include "Environment.h"
 #include "Vector.h"
+#include "FixedVector.h"
 #include "real.h"
 #include "AbstractPolicy.h"
 #include "Random.h"
@@ -39,7 +40,7 @@ protected:
     Vector action_upper_bound;
     Vector action_lower_bound;
     void Simulate();
-    void penddot(Vector& xdot, real u, Vector& x);
+    void penddot(FixedVector<2>& xdot, real u, const FixedVector<2>& x);
     void pendulum_simulate(int action);
 public:
     Pendulum(bool random_parameters = false);
@@ -151,21 +151,27 @@ void PuddleWorld::Simulate(const int action)
 
 real PuddleWorld::DistPointToPuddle(const int puddle) const 
 {
-	Vector P0	= parameters.U_POS_P.getRow(puddle);
-	Vector P1	= parameters.L_POS_P.getRow(puddle);
+	// the state is two-dimensional, so avoid allocating Vectors
+	FixedVector<2> P0;
+	FixedVector<2> P1;
+	for(int i=0;i<2;i++){
+		P0[i] = parameters.U_POS_P(puddle, i);
+		P1[i] = parameters.L_POS_P(puddle, i);
+	}
+	FixedVector<2> s(state);
 	
-	Vector v	= P1 - P0;
-	Vector w	= state - P0;
+	FixedVector<2> v	= P1 - P0;
+	FixedVector<2> w	= s - P0;
 	
 	real c1 = Product(w,v);
 	if(c1 <= 0){
-		return (state - P0).L2Norm();
+		return EuclideanNorm(s, P0);
 	}
 	real c2 = Product(v,v);
 	if(c2 <= c1){
-		return (state - P1).L2Norm();
+		return EuclideanNorm(s, P1);
 	}
 	
 	real c = c1 / c2;
-	return (state - (P0 + v*c)).L2Norm();	
+	return EuclideanNorm(s, P0 + v*c);	
 }
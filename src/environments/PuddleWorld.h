@@ -17,6 +17,7 @@
 #include "MultivariateNormal.h"
 #include "Matrix.h"
 #include "Vector.h"
+#include "FixedVector.h"
 #include "real.h"
 
 /**The Puddle world environment.*/
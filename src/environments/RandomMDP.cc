@@ -118,6 +118,7 @@ DiscreteMDP* RandomMDP::generateMDP() const
         }
     }
 
+    mdp->Freeze();
     return mdp;
 }
 
@@ -263,6 +263,52 @@ Vector ConditionalKDNNClassifier::Node::Output(const Vector& x, const Vector& P_
 }
 
 
+/** Recursively obtain \f$P(y | x)\f$ for the given rows of X.
+
+    Row i of P must hold the mixture of the previous nodes for row i
+    of X, and is replaced by the mixture including this node and its
+    descendants. The rows reaching this node are classified together
+    by the local estimator, and then split between the children.
+*/
+void ConditionalKDNNClassifier::Node::Output(const Matrix& X, const std::vector<int>& rows, Matrix& P, int n_threads)
+{
+    int T = rows.size();
+    if (T == 0) {
+        return;
+    }
+    Matrix X_local(T, X.Columns());
+    for (int t=0; t<T; ++t) {
+        X_local.setRow(t, X.getRow(rows[t]));
+    }
+    Matrix P_local;
+    local_probability->Output(X_local, P_local, n_threads);
+
+	// Mix the current one with all previous ones
+    w =  exp(log_w);
+    for (int t=0; t<T; ++t) {
+        Vector P_t = P_local.getRow(t) * (1 - FUDGE) + FUDGE / (real) tree.n_classes;
+        P.setRow(rows[t], P_t * w + P.getRow(rows[t]) * (1 - w));
+    }
+
+    // Which interval are the x lying at
+    if (splitting_dimension >= 0) {
+        std::vector<int> interval_rows[2];
+        for (int t=0; t<T; ++t) {
+            if (X(rows[t], splitting_dimension) < mid_point) {
+                interval_rows[0].push_back(rows[t]);
+            } else {
+                interval_rows[1].push_back(rows[t]);
+            }
+        }
+        // Do one more mixing step if required
+        for (int k=0; k<2; ++k) {
+            if (next[k]) {
+                next[k]->Output(X, interval_rows[k], P, n_threads);
+            }
+        }
+    }
+}
+
 
 void ConditionalKDNNClassifier::Node::Show()
 {
@@ -328,6 +374,24 @@ Vector& ConditionalKDNNClassifier::Output(const Vector& x)
     return output;
 }
 
+/** Obtain \f$\xi_t(y \mid x)\f$ for each row x of X.
+
+    Row i of P is the same as Output(x) for x the i-th row of X. The
+    rows reaching each node are classified with one batch call to its
+    local estimator, which splits them among n_threads threads.
+ */
+void ConditionalKDNNClassifier::Output(const Matrix& X, Matrix& P, int n_threads)
+{
+    int T = X.Rows();
+    P.Resize(T, n_classes);
+    P.Clear();
+    std::vector<int> rows(T);
+    for (int t=0; t<T; ++t) {
+        rows[t] = t;
+    }
+    root->Output(X, rows, P, n_threads);
+}
+
 void ConditionalKDNNClassifier::Show()
 {
     root->Show();
@@ -16,6 +16,7 @@
 #include <vector>
 #include "real.h"
 #include "Vector.h"
+#include "Matrix.h"
 #include "Ring.h"
 #include "ContextTreeKDTree.h"
 #include "NormalDistribution.h"
@@ -63,6 +64,7 @@ public:
         real Observe(const Vector& x, const int y, real probability);
         real pdf(const Vector& x, const int y, real probability);
         Vector Output(const Vector& x, const Vector& P_y);
+        void Output(const Matrix& X, const std::vector<int>& rows, Matrix& P, int n_threads);
         void Show();
         int NChildren();    
         int S;
@@ -80,6 +82,7 @@ public:
         return ArgMax(Output(x));
     }
     Vector& Output(const Vector& x);
+    void Output(const Matrix& X, Matrix& P, int n_threads = 1);
     real pdf(const Vector& x, const int y);
     void Show();
     int NChildren();
@@ -11,6 +11,9 @@
 
 #include "DirichletTransitions.h"
 #include "Distribution.h"
+#include "Random.h"
+#include "ranlib.h"
+#include <algorithm>
 
 DirichletTransitions::DirichletTransitions(int n_states_,
 										   int n_actions_,
@@ -43,8 +46,13 @@ real DirichletTransitions::Observe(int state, int action, int next_state)
 	auto got = P.find(SA);
 	if (got == P.end()) {
 		// arrgh C++
+		successors[SA].push_back(next_state);
 		return P.insert(std::make_pair(SA, DirichletDistribution(n_states, prior_mass))).first->second.Observe(next_state);
 	} else {
+		std::vector<int>& observed = successors[SA];
+		if (std::find(observed.begin(), observed.end(), next_state) == observed.end()) {
+			observed.push_back(next_state);
+		}
 		return got->second.Observe(next_state);
 	}
 }
@@ -74,6 +82,100 @@ Vector DirichletTransitions::generate(int state, int action) const
 	return got->second.generate();
 }
 
+/** Generate a sparse multinomial distribution parameter vector.
+
+	Observed next states get their own Gamma draw, exactly as in
+	generate(). By the aggregation property of the Dirichlet, the
+	total probability of the unobserved next states is also drawn
+	exactly, but it is then split among only tail_size of them, picked
+	uniformly at random. This is exact when tail_size covers all
+	unobserved states, and otherwise costs O(tail_size) instead of
+	O(n_states). An unvisited state-action pair puts equal mass on
+	tail_size random states if uniform_unknown is set.
+
+	The non-zero entries are returned in next_states and probabilities.
+ */
+void DirichletTransitions::generateSparse(int state, int action, int tail_size,
+										  std::vector<int>& next_states,
+										  std::vector<real>& probabilities) const
+{
+	next_states.clear();
+	probabilities.clear();
+	assert(tail_size > 0);
+	DiscreteStateAction SA(state, action);
+	auto got = P.find(SA);
+	if (got == P.end()) {
+		if (uniform_unknown) {
+			int k = std::min(tail_size, n_states);
+			while ((int) next_states.size() < k) {
+				int j = urandom(0, n_states);
+				if (std::find(next_states.begin(), next_states.end(), j) == next_states.end()) {
+					next_states.push_back(j);
+					probabilities.push_back(1.0 / (real) k);
+				}
+			}
+		} else {
+			next_states.push_back(state);
+			probabilities.push_back(1.0);
+		}
+		return;
+	}
+
+	const DirichletDistribution& dirichlet = got->second;
+	const std::vector<int>& observed = successors.find(SA)->second;
+	// sorted copy of the observed next states, for membership tests
+	std::vector<int> sorted_observed(observed);
+	std::sort(sorted_observed.begin(), sorted_observed.end());
+	real sum = 0.0;
+	for (unsigned int i=0; i<observed.size(); ++i) {
+		real y = gengam(1.0, dirichlet.Alpha(observed[i]));
+		next_states.push_back(observed[i]);
+		probabilities.push_back(y);
+		sum += y;
+	}
+
+	int n_unobserved = n_states - (int) observed.size();
+	if (n_unobserved > 0 && prior_mass > 0) {
+		int k = std::min(tail_size, n_unobserved);
+		real shape = prior_mass * (real) n_unobserved / (real) k;
+		if (2 * k > n_unobserved) {
+			// Most unobserved states are needed: list them all.
+			std::vector<int> unobserved;
+			unobserved.reserve(n_unobserved);
+			for (int j=0; j<n_states; ++j) {
+				if (!std::binary_search(sorted_observed.begin(), sorted_observed.end(), j)) {
+					unobserved.push_back(j);
+				}
+			}
+			for (int i=0; i<k; ++i) {
+				int r = urandom(i, n_unobserved);
+				std::swap(unobserved[i], unobserved[r]);
+				next_states.push_back(unobserved[i]);
+			}
+		} else {
+			// Rejection sampling is cheap while few states are taken.
+			int n_observed = (int) next_states.size();
+			while ((int) next_states.size() < n_observed + k) {
+				int j = urandom(0, n_states);
+				if (!std::binary_search(sorted_observed.begin(), sorted_observed.end(), j)
+					&& std::find(next_states.begin() + n_observed, next_states.end(), j) == next_states.end()) {
+					next_states.push_back(j);
+				}
+			}
+		}
+		for (int i=0; i<k; ++i) {
+			real y = gengam(1.0, shape);
+			probabilities.push_back(y);
+			sum += y;
+		}
+	}
+
+	real invsum = 1.0 / sum;
+	for (unsigned int i=0; i<probabilities.size(); ++i) {
+		probabilities[i] *= invsum;
+	}
+}
+
 Vector DirichletTransitions::getMarginal(int state, int action) const
 {
 	auto got = P.find(DiscreteStateAction(state, action));
@@ -129,6 +231,33 @@ real DirichletTransitions::marginal_pdf(int state, int action, int next_state) c
 	return got->second.marginal_pdf(next_state);
 }
 
+/** Get the parameters of the observed next states of (state, action).
+
+	The observed next states and their parameters are returned in
+	next_states and alpha, and every other next state has parameter
+	prior_mass. The return value is the sum of all parameters, or 0
+	if the state-action pair has not been visited. This costs
+	O(next_states.size()) rather than O(n_states).
+ */
+real DirichletTransitions::getObservedParameters(int state, int action,
+												 std::vector<int>& next_states,
+												 std::vector<real>& alpha) const
+{
+	next_states.clear();
+	alpha.clear();
+	DiscreteStateAction SA(state, action);
+	auto got = P.find(SA);
+	if (got == P.end()) {
+		return 0.0;
+	}
+	next_states = successors.find(SA)->second;
+	alpha.resize(next_states.size());
+	for (unsigned int i=0; i<next_states.size(); ++i) {
+		alpha[i] = got->second.Alpha(next_states[i]);
+	}
+	return got->second.getMass();
+}
+
 int DirichletTransitions::getCounts(int state, int action) const
 {
 	DiscreteStateAction SA(state, action);
@@ -15,6 +15,7 @@
 #include "TransitionDistribution.h"
 #include "Dirichlet.h"
 #include "DirichletFiniteOutcomes.h"
+#include <vector>
 
 /** Discrete transition distribution that is Dirichlet
 
@@ -33,6 +34,8 @@ public:
 	bool uniform_unknown; ///< whether to use a uniform distribution for unknown states
 	/// The set of Dirichlet distributions
 	std::unordered_map<DiscreteStateAction, DirichletDistribution> P;
+	/// The next states observed so far, in order of first observation
+	std::unordered_map<DiscreteStateAction, std::vector<int> > successors;
 
 	/// The standard constructor
 	DirichletTransitions(int n_states_, int n_actions_,
@@ -56,9 +59,19 @@ public:
 	/// Generate a multinomial distribution parameter vector
 	virtual Vector generate(int state, int action) const;
 
+	/// Generate a sparse multinomial distribution parameter vector
+	virtual void generateSparse(int state, int action, int tail_size,
+								std::vector<int>& next_states,
+								std::vector<real>& probabilities) const;
+
 	/// Get the marginal probability of the next state
 	virtual real marginal_pdf(int state, int action, int next_state) const;
 
+	/// Get the parameters of the observed next states only
+	virtual real getObservedParameters(int state, int action,
+									   std::vector<int>& next_states,
+									   std::vector<real>& alpha) const;
+
 	/// Get the number of visits to this state-action pair
 	int getCounts(int state, int action) const;
 };
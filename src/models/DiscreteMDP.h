@@ -140,18 +140,42 @@ public:
 	{
 		transition_distribution.SetTransition(s, a, s2, p);
 	}
+	/// Set all transitions of (s, a). A frozen MDP stays frozen.
 	virtual void setTransitionProbabilities(int s, int a, const Vector& p, real threshold = 0)
 	{
 		assert(s>=0 && s<n_states);
 		assert(p.Size() == n_states);
-		for (int s2=0; s2<n_states; ++s2) {
-			transition_distribution.SetTransition(s, a, s2, p(s2));
-		}
+		transition_distribution.SetTransitions(s, a, p);
+	}
+	/// Set all transitions of (s, a) to weights / mass. A frozen MDP stays frozen.
+	void setTransitionWeights(int s, int a, const Vector& weights, real mass)
+	{
+		assert(s>=0 && s<n_states);
+		transition_distribution.SetTransitions(s, a, weights, mass);
+	}
+	/// Change some transition weights of (s, a), and its total mass.
+	void updateTransitionWeights(int s, int a,
+								 const std::vector<int>& next_states,
+								 const std::vector<real>& weights,
+								 real mass)
+	{
+		assert(s>=0 && s<n_states);
+		transition_distribution.UpdateTransitions(s, a, next_states, weights, mass);
 	}
 	virtual const DiscreteStateSet& getNextStates(int s, int a) const
 	{
 		return transition_distribution.getNextStates(s, a);
 	}
+	/// Pack the transitions into CSR form for fast planning.
+	/// Changing a single transition probability afterwards undoes this.
+	void Freeze()
+	{
+		transition_distribution.Freeze();
+	}
+	bool isFrozen() const
+	{
+		return transition_distribution.isFrozen();
+	}
 
 	void AperiodicityTransform(real tau);
 	bool Check() const;
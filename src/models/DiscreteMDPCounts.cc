@@ -49,22 +49,14 @@ DiscreteMDPCounts::DiscreteMDPCounts (int n_states, int n_actions, real init_tra
             Serror("Unknown distribution family %d\n", reward_family);
         }
     }
-    for (int s=0; s<n_states; s++) {
-		for (int a=0; a<n_actions; a++) {
-			for (int s_next=0; s_next<n_states; s_next++) {
-				real p = transitions.marginal_pdf(s, a, s_next);
-				mean_mdp.setTransitionProbability(s, a, s_next, p);
-				real expected_reward = getExpectedReward(s,a);
-				mean_mdp.reward_distribution.setFixedReward(s, a, expected_reward);
-			}
-		}
-	}
+    MarkAllStale();
 }
 
 
 DiscreteMDPCounts::DiscreteMDPCounts(const DiscreteMDPCounts& model) :
 	MDPModel(model.n_states, model.n_actions),
 	use_sampling(model.use_sampling),
+	sparse_tail(model.sparse_tail),
 	transitions(model.transitions),
 	mean_mdp(model.mean_mdp),
 	reward_family(model.reward_family),
@@ -88,16 +80,8 @@ DiscreteMDPCounts::DiscreteMDPCounts(const DiscreteMDPCounts& model) :
 			Serror("Unknown distribution family %d\n", reward_family);
 		}
 	}
-	for (int s=0; s<n_states; s++) {
-		for (int a=0; a<n_actions; a++) {
-			for (int s_next=0; s_next<n_states; s_next++) {
-				real p = transitions.marginal_pdf(s, a, s_next);
-				mean_mdp.setTransitionProbability(s, a, s_next, p);
-				real expected_reward = getExpectedReward(s,a);
-				mean_mdp.reward_distribution.setFixedReward(s, a, expected_reward);
-			}
-		}
-	}
+	// The reward estimators are not copied, so all rewards change.
+	MarkAllStale();
 }
 
 /// CHECK: Some parameters are not copied
@@ -129,6 +113,48 @@ DiscreteMDP* DiscreteMDPCounts::CreateMDP() const
 }
 #endif
 
+/// Mark every row of the mean MDP as out of date
+void DiscreteMDPCounts::MarkAllStale() const
+{
+    stale.assign(N, true);
+    weighted.assign(N, false);
+    stale_rows.resize(N);
+    for (int i=0; i<N; ++i) {
+        stale_rows[i] = i;
+    }
+}
+
+/** Bring the out of date rows of the mean MDP up to date.
+
+	Rows that already hold the Dirichlet parameters only have the
+	weights of their observed next states and their mass replaced.
+	Other rows are written in full once: visited rows get all their
+	parameters, and unvisited rows the prior marginal.
+ */
+void DiscreteMDPCounts::UpdateMeanMDP() const
+{
+    std::vector<int> next_states;
+    std::vector<real> alpha;
+    for (unsigned int i=0; i<stale_rows.size(); ++i) {
+        int ID = stale_rows[i];
+        int s = ID / n_actions;
+        int a = ID % n_actions;
+        if (weighted[ID]) {
+            real mass = transitions.getObservedParameters(s, a, next_states, alpha);
+            mean_mdp.updateTransitionWeights(s, a, next_states, alpha, mass);
+        } else if (transitions.getCounts(s, a) > 0) {
+            real mass = transitions.getObservedParameters(s, a, next_states, alpha);
+            mean_mdp.setTransitionWeights(s, a, transitions.getParameters(s, a), mass);
+            weighted[ID] = true;
+        } else {
+            mean_mdp.setTransitionProbabilities(s, a, transitions.getMarginal(s, a));
+        }
+        mean_mdp.reward_distribution.setFixedReward(s, a, getExpectedReward(s, a));
+        stale[ID] = false;
+    }
+    stale_rows.clear();
+}
+
 void DiscreteMDPCounts::setFixedRewards(const Matrix& rewards)
 {
 	//logmsg("Setting fixed rewards\n");
@@ -139,6 +165,7 @@ void DiscreteMDPCounts::setFixedRewards(const Matrix& rewards)
             ER[ID] = new UnknownSingularDistribution();
             ER[ID]->Observe(rewards(s,a));
             mean_mdp.reward_distribution.setFixedReward(s, a, rewards(s,a));
+            MarkDirty(s, a);
 			//printf("R: %d %d %f -> %f\n",
 			//	   s, a, rewards(s,a), ER[ID]->getMean());
         }
@@ -151,14 +178,8 @@ void DiscreteMDPCounts::AddTransition(int s, int a, real r, int s2)
     //printf ("(%d, %d) [%.2f] -> %d\n", s, a, r, s2);
     transitions.Observe(s, a, s2);
     ER[ID]->Observe(r);
-
-    real expected_reward = getExpectedReward(s,a);
-    mean_mdp.reward_distribution.setFixedReward(s, a, expected_reward);
-    for (int s_next=0; s_next<n_states; s_next++) {
-		real p = transitions.marginal_pdf(s, a, s_next);
-        mean_mdp.setTransitionProbability(s, a, s_next, p);
-    }
-    
+    MarkStale(s, a);
+    MarkDirty(s, a);
 }
 
 //void DiscreteMDPCounts::SetNextReward(int s, int a, real r)
@@ -254,6 +275,21 @@ void DiscreteMDPCounts::ShowModelStatistics() const
 DiscreteMDP* DiscreteMDPCounts::generate() const
 {
     DiscreteMDP* mdp = new DiscreteMDP(n_states, n_actions, NULL);
+    if (sparse_tail > 0) {
+        std::vector<int> next_states;
+        std::vector<real> probabilities;
+        for (int s=0; s<n_states; s++) {
+            for (int a=0; a<n_actions; a++) {
+                transitions.generateSparse(s, a, sparse_tail, next_states, probabilities);
+                real expected_reward = GenerateReward(s,a);
+                mdp->reward_distribution.addFixedReward(s, a, expected_reward);
+                for (unsigned int i=0; i<next_states.size(); i++) {
+                    mdp->setTransitionProbability(s, a, next_states[i], probabilities[i]);
+                }
+            }
+        }
+        return mdp;
+    }
     for (int s=0; s<n_states; s++) {
         for (int a=0; a<n_actions; a++) {
             //Vector C =  P[getID (s,a)].getMarginal();
@@ -278,6 +314,7 @@ const DiscreteMDP * const DiscreteMDPCounts::getMeanMDP() const
 	//DiscreteMDP* mdp = new DiscreteMDP(n_states, n_actions);
 	//CopyMeanMDP(mdp);
     //    return mdp;
+    UpdateMeanMDP();
     return &mean_mdp;
 }
 
@@ -24,6 +24,20 @@
 #include <unordered_map>
 
 /** This implementation of an MDP model is based on transition counts.
+
+	The mean MDP is materialised lazily. Observations only mark the
+	affected state-action pair as stale, and its row of the mean MDP
+	is brought up to date the next time getMeanMDP() or CopyMeanMDP()
+	is called. Planners should therefore fetch the mean MDP again
+	after adding transitions, rather than keep the pointer from an
+	earlier call.
+
+	Once a state-action pair has been visited, its row of the mean MDP
+	holds the Dirichlet parameters as transition weights, with their
+	sum as the mass of the row. Since the parameters of unobserved next
+	states never change, updating a stale row only rewrites the
+	observed next states and the mass, which costs O(k log n_states) for k
+	observed next states instead of O(n_states).
  */
 class DiscreteMDPCounts : public MDPModel
 {
@@ -36,11 +50,15 @@ public:
     };
 protected:
 	bool use_sampling = false;
+	int sparse_tail = 0; ///< if positive, generate() returns sparse samples
 	/// Dirichlet distribution for transitions
     DirichletTransitions transitions; 
 	/// Vector of estimators on ER.
     std::vector<ConjugatePrior*> ER; 
-    DiscreteMDP mean_mdp; ///< a model of the mean MDP
+    mutable DiscreteMDP mean_mdp; ///< a model of the mean MDP
+    mutable std::vector<bool> stale; ///< whether a row of mean_mdp is out of date
+    mutable std::vector<int> stale_rows; ///< IDs of the out of date rows
+    mutable std::vector<bool> weighted; ///< whether a row of mean_mdp holds the Dirichlet parameters
 	DiscreteMDP* sampled_mdp = NULL; ///< a model of the mean MDP 
     RewardFamily reward_family; ///< reward family to be used
     int N;
@@ -51,6 +69,16 @@ protected:
         return s*n_actions + a;
     }
     Vector getDirichletParameters (int s, int a) const;
+    void MarkStale(int s, int a) const
+    {
+        int ID = getID(s, a);
+        if (!stale[ID]) {
+            stale[ID] = true;
+            stale_rows.push_back(ID);
+        }
+    }
+    void MarkAllStale() const;
+    void UpdateMeanMDP() const;
 public:
     DiscreteMDPCounts (int n_states, int n_actions, real init_transition_count= 0.5, RewardFamily reward_family=NORMAL);
 	void useSampling(bool sampling) {
@@ -59,6 +87,17 @@ public:
 			sampled_mdp = generate();
 		}
 	}
+	/** Make generate() return sparse MDPs.
+
+		Each sampled row only has the observed next states plus
+		tail_size unobserved ones, which share the sampled probability
+		of the unobserved states. See DirichletTransitions::generateSparse().
+		A tail_size of zero restores dense sampling.
+	*/
+	void useSparseSampling(int tail_size)
+	{
+		sparse_tail = tail_size;
+	}
 	// copy constructor
 	DiscreteMDPCounts(const DiscreteMDPCounts& model);
 	virtual DiscreteMDPCounts* Clone() const;
@@ -72,6 +111,10 @@ public:
     virtual real getExpectedReward (int s, int a) const;
 
     virtual void Reset();
+    virtual bool TracksDirtyStateActions() const
+    {
+        return true;
+    }
     virtual void ShowModel() const;
 	virtual void ShowModelStatistics() const;
 
@@ -28,17 +28,19 @@ void GPBandit::run(int times) {
 		play(x);
 	}
 	gp.Observe(testedData,testedValues);
+	gp.setCandidates(examples);
+	Vector candidate_mean;
+	Vector candidate_var;
 	int its = 0;
 	while(its+banditsToTry < times) {
 		predictionVector = Vector(n_untested);
 		meanVector = Vector(n_untested);
 		real maxVal = 0;
 		int bestIndex = -1;
+		gp.CandidatePrediction(candidate_mean, candidate_var);
 		for(uint i=0;i<untested.size();i++) {
-			real mean;
-			real var;
-			Vector z = examples.getRow(untested[i]);
-			gp.Prediction(z,mean,var);
+			real mean = candidate_mean(untested[i]);
+			real var = candidate_var(untested[i]);
 			real value = mean + sqrt(betaFunction(delta)) * var;
 			if(value > maxVal) {
 				maxVal = value;
@@ -49,7 +51,8 @@ void GPBandit::run(int times) {
 		}
 		// play best bandit
 		play(bestIndex);
-		gp.Observe(testedData,testedValues);
+		int last = testedValues.Size() - 1;
+		gp.AddObservation(testedData.getRow(last), testedValues(last));
 		its++;
 	}
 	return;
@@ -89,7 +92,7 @@ void GPBandit::play(int index) {
 		testedData.setRow(0, v);
 	}
 	else {
-		testedData = testedData.AddRow(v);
+		testedData.AppendRow(v);
 	}
 	rewardHistory.AddElement(rewardData(realIndex)+noise);
 }
@@ -97,7 +97,7 @@ void GaussianProcessRPBandit::addObservation(const Matrix& X_, const Vector& Y_)
 		X__[i] = X_.getRow(i);
 		Y__[i] = Y_(i);
 
-		X = X.AddRow(X_.getRow(i));
+		X.AppendRow(X_.getRow(i));
 		Y.AddElement(Y_(i));
 	}
 	gp.AddObservation(X__,Y__);
@@ -110,7 +110,7 @@ void GaussianProcessRPBandit::addObservation(const Vector& x_, const real& y_)
 		X.setRow(0,x_);
 	}
 	else {
-		X = X.AddRow(x_);
+		X.AppendRow(x_);
 	}
 	d = x_.Size();
 	std::vector<Vector> X__(1);
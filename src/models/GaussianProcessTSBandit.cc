@@ -69,7 +69,7 @@ real GaussianProcessTSBandit::descend(const Matrix& X_, const Matrix& learnedMat
 				//value = mean + sqrt(beta(X.Rows())) * var; //UCB
 				Matrix tmpMatrix = Matrix(learnedMatrix);
 				Vector tmpVector = Vector(learnedVector);
-				tmpMatrix = tmpMatrix.AddRow(X_.getRow(i));
+				tmpMatrix.AppendRow(X_.getRow(i));
 				tmpVector.AddElement(value);
 				real tmp = descend(X_,tmpMatrix,tmpVector,i,depth+1,horizon,probability);
 				if(tmp>QVal)
@@ -139,7 +139,7 @@ void GaussianProcessTSBandit::addObservation(const Matrix& X_, const Vector& Y_)
 		X__[i] = X_.getRow(i);
 		Y__[i] = Y_(i);
 
-		X = X.AddRow(X_.getRow(i));
+		X.AppendRow(X_.getRow(i));
 		Y.AddElement(Y_(i));
 	}
 	gp.AddObservation(X__,Y__);
@@ -152,7 +152,7 @@ void GaussianProcessTSBandit::addObservation(const Vector& x_, const real& y_)
 		X.setRow(0,x_);
 	}
 	else {
-		X = X.AddRow(x_);
+		X.AppendRow(x_);
 	}
 	d = x_.Size();
 	std::vector<Vector> X__(1);
@@ -13,6 +13,7 @@
 #include "BasisSet.h"
 #include "Distribution.h"
 #include "Random.h"
+#include "ParallelFor.h"
 
 /** Create a model
     
@@ -94,6 +95,40 @@ Vector& KNNClassifier::Output(const Vector& x)
     return output;
 }
 
+/** Predict the label probabilities for each row of X.
 
-
-
+    Row i of P is the same as Output(x) for x the i-th row of X. The
+    neighbours of all points are found with one batch query, and the
+    points are split among n_threads threads.
+ */
+void KNNClassifier::Output(const Matrix& X, Matrix& P, int n_threads) const
+{
+    assert(n_inputs == X.Columns());
+    int T = X.Rows();
+    std::vector<int> indices;
+    std::vector<real> distances;
+    kd_tree.FindKNearestNeighbours(X, K, indices, distances, n_threads);
+    if (P.Rows() != T || P.Columns() != n_classes) {
+        P.Resize(T, n_classes);
+    }
+    real init_value = 1.0 / (1 + samples.size());
+    real w = 1.0 / (real) K;
+    ParallelFor(T, n_threads,
+                [&](int begin, int end, int block) {
+                    Vector p(n_classes);
+                    for (int t=begin; t<end; ++t) {
+                        for (int i=0; i<n_classes; ++i) {
+                            p(i) = init_value;
+                        }
+                        int k = 0;
+                        for (; k<K && indices[t * K + k] >= 0; ++k) {
+                            p += kd_tree.getObject(indices[t * K + k])->Py * w;
+                        }
+                        if (k==0) {
+                            p += w;
+                        }
+                        p /= p.Sum();
+                        P.setRow(t, p);
+                    }
+                });
+}
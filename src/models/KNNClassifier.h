@@ -52,6 +52,7 @@ public:
         return ArgMax(Output(x));
     }
     virtual Vector& Output(const Vector& x);
+    void Output(const Matrix& X, Matrix& P, int n_threads = 1) const;
     virtual real Observe(const Vector& x, const int& label)
     {
 		real p_y_x = Output(x)(label);
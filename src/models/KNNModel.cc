@@ -13,6 +13,7 @@
 #include "BasisSet.h"
 #include "Distribution.h"
 #include "Random.h"
+#include "ParallelFor.h"
 
 /** Create a model
     
@@ -31,7 +32,7 @@ KNNModel::KNNModel(int n_actions_, int n_dim_, real gamma_, bool optimistic, rea
       max_samples(-1), threshold(n_actions * 10)
 {
     for (int i=0; i<n_actions; ++i) {
-        kd_tree[i] = new KDTree<TrajectorySample> (n_dim);
+        kd_tree[i] = new FlatKDTree<TrajectorySample> (n_dim);
     }
 }
 
@@ -43,6 +44,22 @@ KNNModel::~KNNModel()
     }
 }
 
+/** Find the K nearest samples of an action.
+
+    The search is exact, unless SetApproximateSearch() was used, in
+    which case the work done is added to the search statistics.
+ */
+void KNNModel::FindNeighbours(int action, const Vector& x, int K,
+                              std::vector<std::pair<real, int> >& node_list)
+{
+    if (search_mode.Exact()) {
+        kd_tree[action]->FindKNearestNeighbours(x, K, node_list);
+    } else {
+        kd_tree[action]->FindKNearestNeighbours(x, K, search_mode, node_list,
+                                                &search_statistics);
+    }
+}
+
 /** Add a sample to the model
     
     \param sample sample to add
@@ -55,15 +72,13 @@ KNNModel::~KNNModel()
 void KNNModel::AddSample(TrajectorySample sample, int K, real beta)
 {
     if (max_samples < 0 || samples.size() < (uint) max_samples) {
-        OrderedFixedList<KDNode> node_list = kd_tree[sample.a]->FindKNearestNeighbours(sample.s, K);
+        std::vector<std::pair<real, int> > node_list;
+        FindNeighbours(sample.a, sample.s, K, node_list);
         RBF rbf(sample.s, beta);
-        //std::list<std::pair<real, KDNode*> >::iterator it;
-        KDTree<TrajectorySample>::iterator it;
 
         real w = 0;
-        for (it = node_list.S.begin(); it != node_list.S.end(); ++it) {
-            KDNode* node = it->second;
-            TrajectorySample* near_sample = kd_tree[sample.a]->getObject(node);
+        for (uint k=0; k<node_list.size(); ++k) {
+            TrajectorySample* near_sample = kd_tree[sample.a]->getObject(node_list[k].second);
             w += rbf.Evaluate(near_sample->s);
         }
         if (w < urandom()*threshold) {
@@ -104,29 +119,72 @@ void KNNModel::GetExpectedTransition(real alpha, Vector& x, int action, real& re
         y[i] = 0;
     }
 
-    OrderedFixedList<KDNode> node_list = kd_tree[action]->FindKNearestNeighbours(x, K);
-    
-    std::list<std::pair<real, KDNode*> >::iterator it;
+    std::vector<std::pair<real, int> > node_list;
+    FindNeighbours(action, x, K, node_list);
     
     real sum = 0;
     Vector w(K);
-    int i=0;
-    for (it = node_list.S.begin(); it != node_list.S.end(); ++it, ++i) {
-        KDNode* node = it->second;
-        TrajectorySample* sample = kd_tree[action]->getObject(node);
+    for (uint i=0; i<node_list.size(); ++i) {
+        TrajectorySample* sample = kd_tree[action]->getObject(node_list[i].second);
         w[i] =  rbf.Evaluate(sample->s);
         sum += w[i];
     }
     w /= sum;
-    i = 0;
-    for (it = node_list.S.begin(); it != node_list.S.end(); ++it, ++i) {
-        KDNode* node = it->second;
-        TrajectorySample* sample = kd_tree[action]->getObject(node);
+    for (uint i=0; i<node_list.size(); ++i) {
+        TrajectorySample* sample = kd_tree[action]->getObject(node_list[i].second);
         y += (sample->s2 + (x - sample->s)*alpha)* w[i];
         reward += sample->r * w[i];
     }
 }
 
+/** Get the expected transitions from each row of X.
+
+    This gives the same rewards and rows of Y as calling
+    GetExpectedTransition() on each row of X, but the neighbours of
+    all points are found with one batch query, and the points are
+    split among n_threads threads.
+ */
+void KNNModel::GetExpectedTransitions(real alpha, const Matrix& X, int action, Vector& rewards, Matrix& Y,
+                                      int K, real b, int n_threads)
+{
+    assert(n_dim == X.Columns());
+    int T = X.Rows();
+    std::vector<int> indices;
+    std::vector<real> distances;
+    kd_tree[action]->FindKNearestNeighbours(X, K, indices, distances, n_threads, search_mode,
+                                            search_mode.Exact() ? NULL : &search_statistics);
+    rewards.Resize(T);
+    if (Y.Rows() != T || Y.Columns() != n_dim) {
+        Y.Resize(T, n_dim);
+    }
+    ParallelFor(T, n_threads,
+                [&](int begin, int end, int block) {
+                    Vector w(K);
+                    for (int t=begin; t<end; ++t) {
+                        Vector x = X.getRow(t);
+                        RBF rbf(x, b);
+                        Vector y(n_dim);
+                        real reward = 0.0;
+                        real sum = 0;
+                        w.Clear();
+                        int n_neighbours = 0;
+                        for (; n_neighbours<K && indices[t * K + n_neighbours] >= 0; ++n_neighbours) {
+                            TrajectorySample* sample = kd_tree[action]->getObject(indices[t * K + n_neighbours]);
+                            w[n_neighbours] = rbf.Evaluate(sample->s);
+                            sum += w[n_neighbours];
+                        }
+                        w /= sum;
+                        for (int i=0; i<n_neighbours; ++i) {
+                            TrajectorySample* sample = kd_tree[action]->getObject(indices[t * K + i]);
+                            y += (sample->s2 + (x - sample->s)*alpha)* w[i];
+                            reward += sample->r * w[i];
+                        }
+                        Y.setRow(t, y);
+                        rewards[t] = reward;
+                    }
+                });
+}
+
 /** Get the expected value for an action
     
     Add the probability that there is a posibility to go to an 
@@ -136,15 +194,13 @@ real KNNModel::GetExpectedActionValue(Vector& x, int action, int K, real b)
 {
     RBF rbf(x, b);
 
-    OrderedFixedList<KDNode> node_list = kd_tree[action]->FindKNearestNeighbours(x, K);
-    
-    std::list<std::pair<real, KDNode*> >::iterator it;
+    std::vector<std::pair<real, int> > node_list;
+    FindNeighbours(action, x, K, node_list);
     
     real sum = 0;
     real Q = 0.0;
-    for (it = node_list.S.begin(); it != node_list.S.end(); ++it) {
-        KDNode* node = it->second;
-        TrajectorySample* sample = kd_tree[action]->getObject(node);
+    for (uint i=0; i<node_list.size(); ++i) {
+        TrajectorySample* sample = kd_tree[action]->getObject(node_list[i].second);
         real w =  rbf.Evaluate(sample->s);
         Q += sample->V * w;
         sum += w;
@@ -210,16 +266,14 @@ void KNNModel::UpdateValue(TrajectorySample& start_sample,
     Vector Q(n_actions);
 
     for (int a=0; a<n_actions; ++a) {
-        OrderedFixedList<KDNode> node_list = kd_tree[a]->FindKNearestNeighbours(start_sample.s, K);
-        
-        KDTree<TrajectorySample>::iterator it;
+        std::vector<std::pair<real, int> > node_list;
+        FindNeighbours(a, start_sample.s, K, node_list);
     
         real sum = 0;
         Q[a] = 0.0;
         //printf("Action %d: ", a);
-        for (it = node_list.S.begin(); it != node_list.S.end(); ++it) {
-            KDNode* node = it->second;
-            TrajectorySample* sample = kd_tree[a]->getObject(node);
+        for (uint i=0; i<node_list.size(); ++i) {
+            TrajectorySample* sample = kd_tree[a]->getObject(node_list[i].second);
             Vector y = sample->s2 + (start_sample.s - sample->s) * alpha;
             real w =  rbf.Evaluate(sample->s);
             real Qa_i = (sample->r + gamma*GetExpectedValue(y, K, b));
@@ -231,7 +285,7 @@ void KNNModel::UpdateValue(TrajectorySample& start_sample,
             sum += w;
         }
         Q[a] /= sum;
-        if (node_list.S.size() == 0) {
+        if (node_list.size() == 0) {
             Q[a] = 0.0;
         }
         //printf ("-> %f\n", Q[a]);
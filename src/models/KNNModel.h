@@ -13,7 +13,7 @@
 #define KNN_MODEL_H
 
 #include "Vector.h"
-#include "KDTree.h"
+#include "FlatKDTree.h"
 #include <list>
 #include <vector>
 
@@ -41,7 +41,7 @@ class KNNModel
 protected:
     int n_actions; ///< The number of actions
     int n_dim; ///< The number of state dimensions
-    std::vector<KDTree<TrajectorySample>*> kd_tree; ///< One tree per action
+    std::vector<FlatKDTree<TrajectorySample>*> kd_tree; ///< One tree per action
     //RBFBasisSet basis;
     std::list<TrajectorySample> samples;
     real gamma;
@@ -50,11 +50,17 @@ protected:
     real r_max;
     int max_samples;
     real threshold;
+    KNNSearchMode search_mode; ///< accuracy of neighbour searches
+    KNNSearchStatistics search_statistics; ///< work done by approximate searches
+    void FindNeighbours(int action, const Vector& x, int K,
+                        std::vector<std::pair<real, int> >& node_list);
 public:	
     KNNModel(int n_actions, int n_dim, real gamma_ = 0.9, bool optimistic = true, real optimism_=0.1, real r_max_=0.0);
     ~KNNModel();
     void AddSample(TrajectorySample sample, int K, real beta);
     void GetExpectedTransition(real alpha, Vector& x, int action, real& reward, Vector& y, int K, real b);
+    void GetExpectedTransitions(real alpha, const Matrix& X, int action, Vector& rewards, Matrix& Y,
+                                int K, real b, int n_threads = 1);
     real GetExpectedActionValue(Vector& x, int a, int K, real b);
     real GetExpectedValue(Vector& x, int K, real b);
     int GetBestAction(Vector& x, int K, real b);
@@ -66,6 +72,22 @@ public:
     {
         max_samples = max_samples_;
     }
+    /** Use approximate neighbour searches.
+
+        \param epsilon the relative distance error allowed
+        \param max_leaves the maximum number of leaves searched (<= 0: no limit)
+
+        With the defaults, searches are exact.
+     */
+    void SetApproximateSearch(real epsilon = 0, int max_leaves = 0)
+    {
+        search_mode = KNNSearchMode(epsilon, max_leaves);
+    }
+    /// Work done by approximate searches so far
+    KNNSearchStatistics& getSearchStatistics()
+    {
+        return search_statistics;
+    }
 };
 
 
@@ -85,7 +85,7 @@ void LinearBandit::play(int index) {
 		testedData.setRow(0, v);
 	}
 	else {
-		testedData = testedData.AddRow(v);
+		testedData.AppendRow(v);
 	}
 	rewardHistory.AddElement(rewardData(realIndex)+noise);
 }
@@ -161,7 +161,7 @@ public:
 		}
 		SP = SP_;
 	}
-	const Vector getState()
+	Vector getState()
 	{
 		return environment->getSTate();
 	}
@@ -263,7 +263,7 @@ public:
     {
         return environment->StateLowerBound();
     }	
-	const Vector getNextState(const Vector& state, const int& action)
+	Vector getNextState(const Vector& state, const int& action)
 	{
 		return regression_t[action]->generate(state);
 	}
@@ -58,6 +58,20 @@ class MDPModel
 protected:
     int n_states; ///< number of states (or dimensionality of state space)
     int n_actions; ///< number of actions (or dimensionality of action space)
+    std::vector<DiscreteStateAction> dirty_state_actions; ///< state-actions changed since the last ClearDirtyStateActions()
+    std::vector<bool> is_dirty; ///< whether each state-action is in dirty_state_actions
+    /// Record that the model of (s, a) has changed
+    void MarkDirty(int s, int a)
+    {
+        if (is_dirty.empty()) {
+            is_dirty.resize(n_states * n_actions, false);
+        }
+        int ID = s * n_actions + a;
+        if (!is_dirty[ID]) {
+            is_dirty[ID] = true;
+            dirty_state_actions.push_back(DiscreteStateAction(s, a));
+        }
+    }
 public:
     MDPModel (int n_states, int n_actions)
     {
@@ -106,6 +120,24 @@ public:
         // does nothing
     }
     virtual void Reset() = 0;
+    /// Whether the model reports the state-actions it changes through getDirtyStateActions()
+    virtual bool TracksDirtyStateActions() const
+    {
+        return false;
+    }
+    /// The state-actions whose mean model changed since the last ClearDirtyStateActions()
+    const std::vector<DiscreteStateAction>& getDirtyStateActions() const
+    {
+        return dirty_state_actions;
+    }
+    void ClearDirtyStateActions()
+    {
+        for (unsigned int i=0; i<dirty_state_actions.size(); ++i) {
+            const DiscreteStateAction& SA = dirty_state_actions[i];
+            is_dirty[SA.state * n_actions + SA.action] = false;
+        }
+        dirty_state_actions.clear();
+    }
     virtual DiscreteMDP* CreateMDP() const;
     virtual DiscreteMDP* generate() const = 0;
     virtual const DiscreteMDP* const getMeanMDP() const = 0;
@@ -79,7 +79,7 @@ public:
 	void addFixedReward(int s, int a, real reward);
 	void setFixedReward(int s, int a, real reward);
     void Show();
-    Vector getExpectedRewardVector() const
+    const Vector& getExpectedRewardVector() const
     {
         return ER;
     }
@@ -36,9 +36,31 @@ void DiscreteTransitionDistribution::SetTransition(int state,
 													real probability)
 {	
 	assert(probability >= 0 && probability <= 1);
+	if (frozen) {
+		Unfreeze();
+	}
+	int i = state * n_actions + action;
+	if (row_mass[i] != 1.0) {
+		// express the rest of the row as probabilities first
+		const DiscreteStateSet& next = getNextStates(state, action);
+		for (DiscreteStateSet::const_iterator j = next.begin(); j != next.end(); ++j) {
+			P[DiscreteTransition(state, action, *j)] /= row_mass[i];
+		}
+		row_mass[i] = 1.0;
+	}
+	StoreTransition(state, action, next_state, probability);
+}
+
+/// Update the hash maps only, leaving any CSR arrays as they are.
+void DiscreteTransitionDistribution::StoreTransition(int state,
+													  int action,
+													  int next_state,
+													  real weight)
+{
+	assert(weight >= 0);
 	DiscreteTransition transition = DiscreteTransition(state, action, next_state);
-	if (probability > 0) {
-		P[transition] = probability;
+	if (weight > 0) {
+		P[transition] = weight;
 		DiscreteStateAction SA(state, action);
 		next_states[SA].insert(next_state);
 	} else {
@@ -48,32 +70,179 @@ void DiscreteTransitionDistribution::SetTransition(int state,
 		DiscreteStateAction SA(state, action);
 		auto got = next_states.find(SA);
 		if (got != next_states.end()) {
-			DiscreteStateSet states = got->second;
-			states.erase(next_state);
+			got->second.erase(next_state);
 		}
 	}
 }
 
+/** Set the transition weights of (state, action).
+
+	The probability of each next state becomes weights(next_state) /
+	mass. Unlike SetTransition(), this does not discard the CSR arrays:
+	if the distribution is frozen, only the row of (state, action) is
+	re-packed, through FreezeRow().
+ */
+void DiscreteTransitionDistribution::SetTransitions(int state,
+													int action,
+													const Vector& weights,
+													real mass)
+{
+	assert(weights.Size() == n_states);
+	assert(mass > 0);
+	for (int next_state=0; next_state<n_states; ++next_state) {
+		StoreTransition(state, action, next_state, weights(next_state));
+	}
+	row_mass[state * n_actions + action] = mass;
+	if (frozen) {
+		FreezeRow(state, action);
+	}
+}
+
+/** Change the weights of some next states of (state, action).
+
+	The weights of the other next states are kept, and the mass of
+	the row is set to mass, so the cost is proportional to the number
+	of changed weights. While frozen, weights of successors that are
+	already in the CSR row are overwritten in place, and the row is
+	only re-packed when its set of successors changes.
+ */
+void DiscreteTransitionDistribution::UpdateTransitions(int state,
+													   int action,
+													   const std::vector<int>& successors,
+													   const std::vector<real>& weights,
+													   real mass)
+{
+	assert(successors.size() == weights.size());
+	assert(mass > 0);
+	int i = state * n_actions + action;
+	bool repack = false;
+	for (unsigned int k=0; k<successors.size(); ++k) {
+		int next_state = successors[k];
+		StoreTransition(state, action, next_state, weights[k]);
+		if (frozen && !repack) {
+			int* begin = row_next_state.data() + row_start[i];
+			int* end = row_next_state.data() + row_end[i];
+			int* got = std::lower_bound(begin, end, next_state);
+			if (got != end && *got == next_state && weights[k] > 0) {
+				row_weight[got - row_next_state.data()] = weights[k];
+			} else {
+				repack = true;
+			}
+		}
+	}
+	row_mass[i] = mass;
+	if (repack) {
+		FreezeRow(state, action);
+	}
+}
+
 real DiscreteTransitionDistribution::GetTransition(int state,
 												   int action,
 												   int next_state) const
 {	
-	DiscreteTransition transition(state, action, next_state);
-	auto got = P.find(transition);
-	if (got == P.end() ){
-		return 0.0;
-	} else {
-		return got->second;
+	return GetWeight(state, action, next_state) / getMass(state, action);
+}
+
+/** Build the compressed-sparse-row copy of the transitions.
+
+	Only successors with non-zero weight are stored. Rows are
+	sorted by next state, so that pdf() can use a binary search.
+ */
+void DiscreteTransitionDistribution::Freeze()
+{
+	int n_rows = n_states * n_actions;
+	row_start.resize(n_rows);
+	row_end.resize(n_rows);
+	row_capacity.resize(n_rows);
+	row_next_state.clear();
+	row_weight.clear();
+	row_next_state.reserve(P.size());
+	row_weight.reserve(P.size());
+	for (int s=0; s<n_states; s++) {
+		for (int a=0; a<n_actions; a++) {
+			int i = s * n_actions + a;
+			row_start[i] = row_next_state.size();
+			auto got = next_states.find(DiscreteStateAction(s, a));
+			if (got == next_states.end()) {
+				row_end[i] = row_start[i];
+				row_capacity[i] = 0;
+				continue;
+			}
+			for (DiscreteStateSet::const_iterator it = got->second.begin();
+				 it != got->second.end();
+				 ++it) {
+				real weight = GetWeight(s, a, *it);
+				if (weight > 0) {
+					row_next_state.push_back(*it);
+					row_weight.push_back(weight);
+				}
+			}
+			row_end[i] = row_next_state.size();
+			row_capacity[i] = row_end[i] - row_start[i];
+		}
+	}
+	frozen = true;
+}
+
+/** Re-pack the CSR row of (state, action) after it has changed.
+
+	The row is written in place if it fits in the space it had so
+	far, and otherwise appended to the end of the arrays. Once more
+	than half of the arrays is unused, everything is re-packed with
+	Freeze(), so that the cost stays proportional to the size of the
+	changed rows.
+ */
+void DiscreteTransitionDistribution::FreezeRow(int state, int action)
+{
+	assert(frozen);
+	int i = state * n_actions + action;
+	const DiscreteStateSet& next = getNextStates(state, action);
+	int n = next.size();
+	if (n > row_capacity[i]) {
+		row_start[i] = row_next_state.size();
+		row_capacity[i] = n;
+		row_next_state.resize(row_start[i] + n);
+		row_weight.resize(row_start[i] + n);
+	}
+	int k = row_start[i];
+	for (DiscreteStateSet::const_iterator j = next.begin(); j != next.end(); ++j) {
+		row_next_state[k] = *j;
+		row_weight[k] = GetWeight(state, action, *j);
+		++k;
+	}
+	row_end[i] = k;
+	if (row_next_state.size() > 2 * P.size() + n_states) {
+		Freeze();
 	}
 }
 
+void DiscreteTransitionDistribution::Unfreeze()
+{
+	frozen = false;
+	row_start.clear();
+	row_end.clear();
+	row_capacity.clear();
+	row_next_state.clear();
+	row_weight.clear();
+}
+
 int DiscreteTransitionDistribution::generate(int state, int action) const
 {
-	real X = urandom();
+	real X = urandom() * getMass(state, action);
 	real sum = 0.0;
+	if (frozen) {
+		int end = getRowEnd(state, action);
+		for (int k=getRowBegin(state, action); k<end; ++k) {
+			sum += row_weight[k];
+			if (X <= sum) {
+				return row_next_state[k];
+			}
+		}
+		Swarning("This statement should never be reached\n");
+		return urandom(0, n_states);
+	}
 	for (int i=0; i<n_states; ++i) {
-		real probability = GetTransition(state, action, i);
-		sum += probability;
+		sum += GetWeight(state, action, i);
 		if (X <= sum) {
 			return i;
 		}
@@ -84,6 +253,15 @@ int DiscreteTransitionDistribution::generate(int state, int action) const
 
 real DiscreteTransitionDistribution::pdf(int state, int action, int next_state) const
 {
+	if (frozen) {
+		const int* begin = row_next_state.data() + getRowBegin(state, action);
+		const int* end = row_next_state.data() + getRowEnd(state, action);
+		const int* got = std::lower_bound(begin, end, next_state);
+		if (got == end || *got != next_state) {
+			return 0.0;
+		}
+		return row_weight[got - row_next_state.data()] / getMass(state, action);
+	}
 	return GetTransition(state, action, next_state);
 }
 
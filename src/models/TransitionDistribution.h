@@ -13,13 +13,17 @@
 #define TRANSITION_DISTRIBUTION_H
 
 #include "real.h"
+#include "Vector.h"
 #include "DiscreteStateSet.h"
 #include "StateAction.h"
 #include "HashCombine.h"
 #include "debug.h"
 #include <cstdio>
+#include <cassert>
 #include <map>
 #include <unordered_map>
+#include <vector>
+#include <algorithm>
 
 template <typename StateType, typename ActionType>
 class TransitionDistribution
@@ -78,6 +82,26 @@ namespace std
 /** Discrete transition distribution.
 
 	In this model, we employ an unorder map of actual transitions, as well as a map of next states.
+
+	Once the model has been fully specified, Freeze() copies it into
+	a compressed-sparse-row (CSR) layout: for each state-action pair
+	\f$i = s n_A + a\f$, the successors and their weights are
+	stored contiguously in row_next_state[row_start[i] .. row_end[i]]
+	and row_weight[...], sorted by next state. While frozen,
+	pdf() and generate() are served from the CSR arrays, and so are
+	the sweeps of ValueIteration. getNextStates() still returns the
+	std::set of each pair, which Freeze() packs from, so that callers
+	that hold on to the set keep working; loops that run on every
+	sweep should use getRowBegin() and getRowEnd() instead. A later call
+	to SetTransition() discards the CSR arrays again, while SetTransitions() and
+	UpdateTransitions() only re-pack the row they change.
+
+	Each row is stored as non-negative weights together with its total
+	mass, and the probability of a successor is its weight divided by
+	the mass of the row. The mass is 1 unless it is given explicitly
+	to SetTransitions() or UpdateTransitions(). This lets a caller that
+	keeps counts, such as a Dirichlet posterior, change a few weights
+	and the mass without rewriting the rest of the row.
  */
 template<>
 class TransitionDistribution<int, int>
@@ -87,11 +111,32 @@ public:
 	int n_actions; ///< the maximum number of actions
 	DiscreteStateSet empty_set; ///< included for convenience
 	/// The implementation of the discrete transition distribution
-	std::unordered_map<DiscreteTransition, real> P;  ///< gives the actual probabilities
+	std::unordered_map<DiscreteTransition, real> P;  ///< gives the transition weights
 	std::unordered_map<DiscreteStateAction, DiscreteStateSet> next_states; ///< next states for quick access
+	std::vector<int> row_start; ///< CSR: offset of the first successor of each state-action pair
+	std::vector<int> row_end; ///< CSR: one past the offset of the last successor
+	std::vector<int> row_capacity; ///< CSR: space reserved for each state-action pair
+	std::vector<int> row_next_state; ///< CSR: successor states
+	std::vector<real> row_weight; ///< CSR: successor weights
+	std::vector<real> row_mass; ///< total weight of each state-action pair
+	bool frozen; ///< whether the CSR arrays are valid
+protected:
+	void StoreTransition(int state, int action, int next_state, real weight);
+	/// Get the stored weight of a state transition
+	real GetWeight(int state, int action, int next_state) const
+	{
+		auto got = P.find(DiscreteTransition(state, action, next_state));
+		if (got == P.end()) {
+			return 0.0;
+		}
+		return got->second;
+	}
+public:
 	TransitionDistribution(int n_states_, int n_actions_)
 		: n_states(n_states_),
-		  n_actions(n_actions_)
+		  n_actions(n_actions_),
+		  row_mass(n_states_ * n_actions_, 1.0),
+		  frozen(false)
 	{
 	}
 	
@@ -110,6 +155,15 @@ public:
 	/// Set a state transition
 	virtual void SetTransition(int state, int action, int next_state, real probability);
 
+	/// Set all transitions from a state-action pair, keeping the CSR form
+	void SetTransitions(int state, int action, const Vector& weights, real mass = 1.0);
+
+	/// Change some transition weights of a state-action pair, keeping the CSR form
+	void UpdateTransitions(int state, int action,
+						   const std::vector<int>& successors,
+						   const std::vector<real>& weights,
+						   real mass);
+
 	/// Get a state transition
 	virtual real GetTransition(int state, int action, int next_state) const;
 
@@ -117,6 +171,33 @@ public:
 	virtual int generate(int state, int action) const;
 	/// Get the probability of the next state
 	virtual real pdf(int state, int action, int next_state) const;
+	/// Build the CSR representation of the transitions
+	void Freeze();
+	/// Discard the CSR representation
+	void Unfreeze();
+	/// Re-pack the CSR row of a single state-action pair
+	void FreezeRow(int state, int action);
+	bool isFrozen() const
+	{
+		return frozen;
+	}
+	/// First CSR index of the successors of (state, action). Only valid when frozen.
+	int getRowBegin(int state, int action) const
+	{
+		assert(frozen);
+		return row_start[state * n_actions + action];
+	}
+	/// One past the last CSR index of the successors of (state, action). Only valid when frozen.
+	int getRowEnd(int state, int action) const
+	{
+		assert(frozen);
+		return row_end[state * n_actions + action];
+	}
+	/// The total weight of the successors of (state, action)
+	real getMass(int state, int action) const
+	{
+		return row_mass[state * n_actions + action];
+	}
 	/// Return the set of next states.
 	/// In this case, if a state has not been visited before, then we assume that the next-state set is empty. This means that value iteration will stop upon reaching this state-action pair.
 	const DiscreteStateSet& getNextStates(int state, int action) const
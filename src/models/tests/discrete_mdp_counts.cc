@@ -10,6 +10,7 @@
  ***************************************************************************/
 
 #include "DiscreteMDPCounts.h"
+#include "Random.h"
 
 int main(void)
 {
@@ -29,7 +30,96 @@ int main(void)
 	DiscreteMDPCounts* clone = belief.Clone();
 
 	delete clone;
-	
-	return 0;
+
+	// Sparse samples only keep the observed next states plus a short tail.
+	int n_errors = 0;
+	{
+		int n_big = 1000;
+		int tail_size = 2;
+		DiscreteMDPCounts big_belief(n_big, n_actions, dirichlet_mass, reward_prior);
+		for (int t=0; t<5000; ++t) {
+			int s = urandom(0, 10);
+			big_belief.AddTransition(s, t % n_actions, urandom(), (s + urandom(0, 3)) % n_big);
+		}
+		big_belief.useSparseSampling(tail_size);
+		DiscreteMDP* sample = big_belief.generate();
+		for (int s=0; s<n_big; ++s) {
+			for (int a=0; a<n_actions; ++a) {
+				const DiscreteStateSet& next = sample->getNextStates(s, a);
+				real sum = 0;
+				int n_next = 0;
+				for (DiscreteStateSet::const_iterator i=next.begin(); i!=next.end(); ++i) {
+					sum += sample->getTransitionProbability(s, a, *i);
+					n_next++;
+				}
+				int max_next = (s < 10) ? 3 + tail_size : tail_size;
+				if (fabs(sum - 1.0) > 1e-6 || n_next > max_next) {
+					n_errors++;
+				}
+			}
+		}
+		delete sample;
+	}
+	// With a full tail, sparse samples list every next state exactly once.
+	{
+		int n_small = 12;
+		DirichletTransitions dirichlet(n_small, 1, 0.1);
+		for (int t=0; t<50; ++t) {
+			dirichlet.Observe(t % 3, 0, urandom(0, 5));
+		}
+		for (int s=0; s<3; ++s) {
+			std::vector<int> next_states;
+			std::vector<real> probabilities;
+			dirichlet.generateSparse(s, 0, n_small, next_states, probabilities);
+			std::vector<int> times_listed(n_small);
+			for (unsigned int i=0; i<next_states.size(); ++i) {
+				times_listed[next_states[i]]++;
+			}
+			for (int j=0; j<n_small; ++j) {
+				if (times_listed[j] != 1) {
+					printf ("ERROR: next state %d of %d listed %d times\n", j, s, times_listed[j]);
+					n_errors++;
+				}
+			}
+		}
+	}
+	// Mean rows that are patched after each step match rows written from scratch.
+	{
+		int n_mean = 20;
+		DiscreteMDPCounts mean_belief(n_mean, n_actions, dirichlet_mass, reward_prior);
+		for (int round=0; round<20; ++round) {
+			for (int t=0; t<30; ++t) {
+				int s = urandom(0, n_mean);
+				mean_belief.AddTransition(s, t % n_actions, urandom(), (s + urandom(0, 4)) % n_mean);
+			}
+			const DiscreteMDP* mean_mdp = mean_belief.getMeanMDP();
+			DiscreteMDPCounts rebuilt_belief(mean_belief);
+			const DiscreteMDP* rebuilt_mdp = rebuilt_belief.getMeanMDP();
+			for (int s=0; s<n_mean; ++s) {
+				for (int a=0; a<n_actions; ++a) {
+					real sum = 0;
+					for (int s2=0; s2<n_mean; ++s2) {
+						real p = mean_mdp->getTransitionProbability(s, a, s2);
+						sum += p;
+						if (p != rebuilt_mdp->getTransitionProbability(s, a, s2)
+							|| fabs(p - mean_belief.getTransitionProbability(s, a, s2)) > 1e-12) {
+							printf ("ERROR: mean transition %d %d %d: %f\n", s, a, s2, p);
+							n_errors++;
+						}
+					}
+					if (fabs(sum - 1.0) > 1e-9) {
+						printf ("ERROR: mean transitions %d %d sum to %f\n", s, a, sum);
+						n_errors++;
+					}
+				}
+			}
+		}
+	}
+	if (n_errors) {
+		printf ("# %d ERRORS found\n", n_errors);
+	} else {
+		printf ("# All tests OK\n");
+	}
+	return n_errors;
 }
 
@@ -0,0 +1,142 @@
+/* -*- Mode: C++; -*- */
+/***************************************************************************
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ ***************************************************************************/
+
+#ifdef MAKE_MAIN
+
+#include "KNNModel.h"
+#include "ConditionalKDNNClassifier.h"
+#include "Random.h"
+#include <cmath>
+
+/// Check batch transitions against GetExpectedTransition() on each point.
+int knn_model_test(int n_threads)
+{
+    printf ("# Testing KNNModel batch transitions with %d threads\n", n_threads);
+    int n_errors = 0;
+    int n_actions = 2;
+    int n_dim = 2;
+    int K = 4;
+    real alpha = 0.5;
+    real beta = 1.0;
+    KNNModel model(n_actions, n_dim);
+    for (int t=0; t<500; ++t) {
+        Vector s(n_dim);
+        Vector s2(n_dim);
+        for (int i=0; i<n_dim; ++i) {
+            s(i) = 2.0 * urandom() - 1.0;
+            s2(i) = s(i) + 0.2 * urandom() - 0.1;
+        }
+        int a = urandom(0, n_actions);
+        model.AddSample(TrajectorySample(s, a, urandom(), s2, false), K, beta);
+    }
+
+    int T = 37;
+    Matrix X(T, n_dim);
+    for (int t=0; t<T; ++t) {
+        for (int i=0; i<n_dim; ++i) {
+            X(t, i) = 2.0 * urandom() - 1.0;
+        }
+    }
+    for (int a=0; a<n_actions; ++a) {
+        Vector rewards;
+        Matrix Y;
+        model.GetExpectedTransitions(alpha, X, a, rewards, Y, K, beta, n_threads);
+        for (int t=0; t<T; ++t) {
+            Vector x = X.getRow(t);
+            Vector y(n_dim);
+            real reward;
+            model.GetExpectedTransition(alpha, x, a, reward, y, K, beta);
+            if (fabs(reward - rewards(t)) > 1e-12) {
+                printf ("ERROR: action %d, point %d: reward %f, batch %f\n",
+                        a, t, reward, rewards(t));
+                n_errors++;
+            }
+            for (int i=0; i<n_dim; ++i) {
+                if (fabs(y(i) - Y(t, i)) > 1e-12) {
+                    printf ("ERROR: action %d, point %d, dimension %d: %f, batch %f\n",
+                            a, t, i, y(i), Y(t, i));
+                    n_errors++;
+                }
+            }
+        }
+    }
+    return n_errors;
+}
+
+/// Check batch outputs against Output() on each point.
+int conditional_classifier_test(int n_threads)
+{
+    printf ("# Testing ConditionalKDNNClassifier batch outputs with %d threads\n", n_threads);
+    int n_errors = 0;
+    int n_dim = 2;
+    int n_classes = 3;
+    Vector lower_bound(n_dim);
+    Vector upper_bound(n_dim);
+    for (int i=0; i<n_dim; ++i) {
+        lower_bound(i) = -1.0;
+        upper_bound(i) = 1.0;
+    }
+    ConditionalKDNNClassifier classifier(2, 8, lower_bound, upper_bound, n_classes);
+    for (int t=0; t<500; ++t) {
+        Vector x(n_dim);
+        for (int i=0; i<n_dim; ++i) {
+            x(i) = 2.0 * urandom() - 1.0;
+        }
+        int y = (x(0) < 0) ? 0 : ((x(1) < 0) ? 1 : 2);
+        if (urandom() < 0.1) {
+            y = urandom(0, n_classes);
+        }
+        classifier.Observe(x, y);
+    }
+    if (classifier.NChildren() == 0) {
+        printf ("ERROR: the tree was not split\n");
+        n_errors++;
+    }
+
+    int T = 53;
+    Matrix X(T, n_dim);
+    for (int t=0; t<T; ++t) {
+        for (int i=0; i<n_dim; ++i) {
+            X(t, i) = 2.0 * urandom() - 1.0;
+        }
+    }
+    Matrix P;
+    classifier.Output(X, P, n_threads);
+    for (int t=0; t<T; ++t) {
+        Vector p = classifier.Output(X.getRow(t));
+        for (int i=0; i<n_classes; ++i) {
+            if (fabs(p(i) - P(t, i)) > 1e-12) {
+                printf ("ERROR: point %d, class %d: %f, batch %f\n",
+                        t, i, p(i), P(t, i));
+                n_errors++;
+            }
+        }
+    }
+    return n_errors;
+}
+
+int main(void)
+{
+    setRandomSeed(1);
+    int n_errors = 0;
+    n_errors += knn_model_test(1);
+    n_errors += knn_model_test(4);
+    n_errors += conditional_classifier_test(1);
+    n_errors += conditional_classifier_test(4);
+
+    if (n_errors) {
+        printf ("# %d ERRORS found\n", n_errors);
+    } else {
+        printf ("# All tests OK\n");
+    }
+    return n_errors;
+}
+
+#endif
@@ -3,6 +3,7 @@
 #include "TransitionDistribution.h"
 #include "real.h"
 #include "Random.h"
+#include <cmath>
 
 void DisplayTransitions(const DiscreteTransitionDistribution& kernel);
 
@@ -32,6 +33,71 @@ int main ()
 
 	DisplayTransitions(kernel);
 
+	printf("Checking frozen transitions\n");
+	kernel.Freeze();
+	int n_errors = 0;
+	for (int i=0; i<n_states; i++) {
+		for (int a=0; a<n_actions; a++) {
+			for (int j=0; j<n_states; j++) {
+				if (kernel.pdf(i, a, j) != kernel.GetTransition(i, a, j)) {
+					printf("Mismatch at %d %d %d\n", i, a, j);
+					n_errors++;
+				}
+			}
+		}
+	}
+	printf("%d errors\n", n_errors);
+
+	printf("Patching frozen rows\n");
+	DiscreteTransitionDistribution patched(n_states, 2);
+	patched.Freeze();
+	for (int round=0; round<10; round++) {
+		for (int i=0; i<n_states; i++) {
+			for (int a=0; a<2; a++) {
+				Vector p(n_states);
+				int n_next = 1 + (int) floor(urandom() * n_states);
+				for (int j=0; j<n_next; j++) {
+					p((i + j) % n_states) = 1.0 / (real) n_next;
+				}
+				patched.SetTransitions(i, a, p);
+			}
+		}
+		if (!patched.isFrozen()) {
+			printf("SetTransitions() unfroze the kernel\n");
+			n_errors++;
+		}
+		DiscreteTransitionDistribution rebuilt(n_states, 2);
+		for (int i=0; i<n_states; i++) {
+			for (int a=0; a<2; a++) {
+				for (int j=0; j<n_states; j++) {
+					rebuilt.SetTransition(i, a, j, patched.GetTransition(i, a, j));
+				}
+			}
+		}
+		rebuilt.Freeze();
+		for (int i=0; i<n_states; i++) {
+			for (int a=0; a<2; a++) {
+				int n_patched = patched.getRowEnd(i, a) - patched.getRowBegin(i, a);
+				int n_rebuilt = rebuilt.getRowEnd(i, a) - rebuilt.getRowBegin(i, a);
+				if (n_patched != n_rebuilt) {
+					printf("Row size mismatch at %d %d\n", i, a);
+					n_errors++;
+					continue;
+				}
+				for (int k=0; k<n_patched; k++) {
+					int k_patched = patched.getRowBegin(i, a) + k;
+					int k_rebuilt = rebuilt.getRowBegin(i, a) + k;
+					if (patched.row_next_state[k_patched] != rebuilt.row_next_state[k_rebuilt]
+						|| patched.row_weight[k_patched] != rebuilt.row_weight[k_rebuilt]) {
+						printf("Row mismatch at %d %d\n", i, a);
+						n_errors++;
+					}
+				}
+			}
+		}
+	}
+	printf("%d errors\n", n_errors);
+
 	printf("Clearing transitions for action 0\n");
 	for (int i=0; i<n_states; i++) {
 		int a = 0;
@@ -42,7 +108,7 @@ int main ()
 
 	DisplayTransitions(kernel);
 	
-	return 0;
+	return n_errors;
 }
 
 void DisplayTransitions(const DiscreteTransitionDistribution& kernel) 
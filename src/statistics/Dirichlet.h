@@ -45,6 +45,10 @@ public:
     {
         return alpha[i];
     }
+    real Alpha(int i) const
+    {
+        return alpha[i];
+    }
     int size() const
     {
         return n;
@@ -20,10 +20,57 @@ DoubleKernelCDE::DoubleKernelCDE(int n_x_dimensions,
     n_x(n_x_dimensions),
     n_y(n_y_dimensions),
     b_x(initial_bandwidth),
-    b_y(initial_bandwidth)
+    b_y(initial_bandwidth),
+    x_tree(n_x_dimensions),
+    xy_tree(n_x_dimensions + n_y_dimensions),
+    xy_tree_b_y(initial_bandwidth),
+    tolerance(1e-6)
 {
 }
 
+/// The point x, scaled so that the x kernel has unit bandwidth.
+Vector DoubleKernelCDE::ScaledX(const Vector& x) const
+{
+    return x * sqrt(2.0);
+}
+
+/// The point (x, y), scaled so that the joint kernel has unit bandwidth.
+Vector DoubleKernelCDE::ScaledXY(const Vector& x, const Vector& y) const
+{
+    Vector z(n_x + n_y);
+    for (int i=0; i<n_x; ++i) {
+        z(i) = sqrt(2.0) * x(i);
+    }
+    for (int i=0; i<n_y; ++i) {
+        z(n_x + i) = y(i) / b_y;
+    }
+    return z;
+}
+
+/// Rebuild the joint tree if the bandwidth has changed.
+void DoubleKernelCDE::UpdateTree()
+{
+    if (xy_tree_b_y == b_y) {
+        return;
+    }
+    xy_tree_b_y = b_y;
+    Matrix Z(D.size(), n_x + n_y);
+    for (uint k=0; k<D.size(); ++k) {
+        Z.setRow(k, ScaledXY(D[k].x, D[k].y));
+    }
+    xy_tree.Build(Z, std::vector<const void*>(D.size(), (const void*) NULL));
+}
+
+/// Add a point
+void DoubleKernelCDE::AddPoint(const Vector& x, const Vector& y)
+{
+    D.push_back(PointPair(x, y));
+    x_tree.AddVector(ScaledX(x), NULL);
+    if (xy_tree_b_y == b_y) {
+        xy_tree.AddVector(ScaledXY(x, y), NULL);
+    }
+}
+
 real DoubleKernelCDE::Observe(const Vector& x, const Vector& y)
 {
     real p = pdf(x, y);
@@ -41,7 +88,8 @@ real DoubleKernelCDE::pdf(const Vector& x, const Vector& y)
      For the i-th point, calculate
      K_y(y - y_i)
 
-     
+     The sums are over the points found with
+     void_FlatKDTree::FindKernelNeighbours().
  */
 real DoubleKernelCDE::log_pdf(const Vector& x, const Vector& y)
 {
@@ -54,26 +102,19 @@ real DoubleKernelCDE::log_pdf(const Vector& x, const Vector& y)
         printf ("! %f %f\n", r, exp(r));
         return r;
     }
-        // otherwise, do the kernel estimate
-    real ib2 = 1.0 / (b_y * b_y);
-    real log_Z = LOG_ZERO;
-    real log_P = LOG_ZERO;
-    for (std::vector<PointPair>::iterator it = D.begin();
-         it != D.end();
-         ++it) {
-        real d_x = SquareNorm(&x, &(it->x));
-        real d_y = SquareNorm(&y, &(it->y));
-        real log_p_i = C - 0.5 * d_y * ib2;
-        real log_p_c = -d_x;
-        log_P = logAdd(log_P, log_p_c + log_p_i);
-        log_Z = logAdd(log_Z, log_p_c);
-    }
+    // otherwise, do the kernel estimate
+    UpdateTree();
+    // log_p_c = -|x - x_i|^2
+    real log_Z = x_tree.LogKernelSum(ScaledX(x), 1.0, tolerance);
+    // log_p_c + log_p_i = C - |x - x_i|^2 - 0.5 |y - y_i|^2 / b_y^2
+    real log_P = C + xy_tree.LogKernelSum(ScaledXY(x, y), 1.0, tolerance);
     return log_P - log_Z - log(b_y);
 }
 
 void DoubleKernelCDE::BootstrapBandwidth(bool stochastic)
 {
     DoubleKernelCDE kde(n_x, n_y, b_x);
+    kde.tolerance = tolerance;
     std::vector<PointPair> test_data;
     fprintf(stderr, "Bootstrapping bandiwdth\n");
     for (std::vector<PointPair>::iterator it = D.begin();
@@ -15,11 +15,18 @@
 
 #include <vector>
 #include "Vector.h"
+#include "FlatKDTree.h"
 
 /** Double Kernel method for conditional density estimation.
 
     Estimate P(x | y) = sum_c K_c(x) P(c | y).
 
+    Both kernels are Gaussian, so the two sums of log_pdf() are kernel
+    sums over the scaled points \f$\sqrt{2} x_i\f$ and \f$(\sqrt{2}
+    x_i, y_i / b_y)\f$. These are kept in two FlatKDTree indices, and
+    points whose total contribution to a sum is less than tolerance
+    times the sum are skipped. The second tree is rebuilt whenever
+    \f$b_y\f$ changes.
  */
 class DoubleKernelCDE
 {
@@ -39,15 +46,19 @@ protected:
     std::vector<PointPair> D;
     real b_x;
     real b_y;
+    void_FlatKDTree x_tree; ///< the scaled x_i
+    void_FlatKDTree xy_tree; ///< the scaled (x_i, y_i)
+    real xy_tree_b_y; ///< the b_y used for xy_tree
+    Vector ScaledX(const Vector& x) const;
+    Vector ScaledXY(const Vector& x, const Vector& y) const;
+    void UpdateTree();
 public:
+    real tolerance; ///< Relative error allowed in the kernel sums (0: exact)
 
     DoubleKernelCDE(int n_x_dimensions,
                     int n_y_dimensions,
                     real initial_bandwidth);
-    void AddPoint(const Vector& x, const Vector& y)
-    {
-        D.push_back(PointPair(x, y));
-    }
+    void AddPoint(const Vector& x, const Vector& y);
     real Observe(const Vector& x, const Vector& y); 
     real pdf(const Vector& x, const Vector& y);
     real log_pdf(const Vector& x, const Vector& y);
@@ -10,13 +10,18 @@
  ***************************************************************************/
 
 #include "GaussianProcess.h"
+#include <stdexcept>
+#include <utility>
+#include <algorithm>
 
 /// Create a new GP with observations in R^d
 GaussianProcess::GaussianProcess(Matrix& Sigma_p_,
                                  real noise_variance_)
     : Sigma_p(Sigma_p_),
+      window(0),
       noise_variance(noise_variance_),
-      X2(Matrix::Null(Sigma_p.Rows(), Sigma_p.Columns()))
+      X2(Matrix::Null(Sigma_p.Rows(), Sigma_p.Columns())),
+      n_cached(0)
 {
     Accuracy = Sigma_p.Inverse();
     A = Accuracy;
@@ -25,9 +30,11 @@ GaussianProcess::GaussianProcess(Matrix& Sigma_p_,
 GaussianProcess::GaussianProcess(real noise_variance_,
 								 Vector scale_length_,
 								 real sig_var_)
-	: noise_variance(noise_variance_),
+	: window(0),
+	  noise_variance(noise_variance_),
 	  scale_length(scale_length_),
-	  sig_var(sig_var_)
+	  sig_var(sig_var_),
+	  n_cached(0)
 {
 	N = 0;
 }
@@ -39,9 +46,11 @@ GaussianProcess::GaussianProcess(Matrix& X_,
 								 real sig_var_)
 	: X(X_),
 	  Y(Y_),
+	  window(0),
 	  noise_variance(noise_variance_),
 	  scale_length(scale_length_),
-	  sig_var(sig_var_)
+	  sig_var(sig_var_),
+	  n_cached(0)
 {
 	N = X.Rows();
 	UpdateGaussianProcess();
@@ -124,19 +133,172 @@ void GaussianProcess::Observe(std::vector<Vector>& x, std::vector<real>& y)
 }
 
 
- void GaussianProcess::AddObservation(const Vector& x, const real& y)
- {
-	 Serror ("Not implemented\n");
-	 exit(-1);	 
- }
+/** Add a single observation.
+
+	With the covariance factored as \f$K = L^\top L\f$, the factor of
+	the covariance with the new point is
+	\f[
+	\begin{pmatrix} L & c \\ 0 & d \end{pmatrix},
+	\qquad L^\top c = k, \quad d^2 = k(x,x) + \sigma^2 - c^\top c,
+	\f]
+	where \f$k\f$ is the kernel between x and the existing samples.
+	This costs O(N^2) rather than the O(N^3) of a new factorisation.
+*/
+void GaussianProcess::AddObservation(const Vector& x, const real& y)
+{
+	Vector k = Kernel(x);
+	Vector c = SolveTransposed(k);
+	real d2 = sig_var*sig_var + noise_variance*noise_variance - Product(c, c);
+	if (d2 <= 0) {
+		throw std::runtime_error("Could not add observation, covariance not positive definite");
+	}
+
+	// X and L may have more rows than N, so that they only need to be
+	// copied when their capacity doubles.
+	if (N == 0 || X.Rows() <= N) {
+		Matrix X_new(std::max(1, 2 * N), x.Size());
+		for (int i=0; i<N; ++i) {
+			X_new.setRow(i, X.getRow(i));
+		}
+		X = std::move(X_new);
+	}
+	if (L.Rows() <= N) {
+		int capacity = std::max(1, 2 * N);
+		Matrix L_new(capacity, capacity);
+		for (int i=0; i<N; ++i) {
+			for (int j=i; j<N; ++j) {
+				L_new(i, j) = L(i, j);
+			}
+		}
+		L = std::move(L_new);
+	}
+	X.setRow(N, x);
+	for (int i=0; i<N; ++i) {
+		L(i, N) = c(i);
+	}
+	L(N, N) = sqrt(d2);
+	Y.AddElement(y);
+	z.AddElement((y - Product(c, z)) / L(N, N));
+	N++;
+
+	if (window > 0 && N > window) {
+		while (N > window) {
+			RemoveFirstObservation();
+		}
+		z = SolveTransposed(Y);
+	}
+	alpha = BackSubstitute(z);
+}
+
+/// Keep at most window_ samples, dropping the oldest ones
+void GaussianProcess::setWindow(int window_)
+{
+	window = window_;
+	if (window > 0 && N > window) {
+		while (N > window) {
+			RemoveFirstObservation();
+		}
+		z = SolveTransposed(Y);
+		alpha = BackSubstitute(z);
+	}
+}
+
+/** Remove the oldest observation.
+
+	Writing the factor as
+	\f[
+	L = \begin{pmatrix} l_{11} & l^\top \\ 0 & L_2 \end{pmatrix},
+	\f]
+	the covariance of the remaining points is \f$L_2^\top L_2 + l
+	l^\top\f$, whose factor is obtained from \f$L_2\f$ with a rank-one
+	update in O(N^2). The caller must update z and alpha.
+*/
+void GaussianProcess::RemoveFirstObservation()
+{
+	assert(N > 0);
+	int n = N - 1;
+	Vector l(n);
+	for (int i=0; i<n; ++i) {
+		l(i) = L(0, i + 1);
+	}
+	// Shift everything up by one sample in place, so that X, Y and L
+	// keep their capacity and the next AddObservation() does not
+	// have to reallocate them.
+	for (int i=0; i<n; ++i) {
+		for (int j=i; j<n; ++j) {
+			L(i, j) = L(i + 1, j + 1);
+		}
+	}
+	for (int i=0; i<n; ++i) {
+		for (int c=0; c<X.Columns(); ++c) {
+			X(i, c) = X(i + 1, c);
+		}
+		Y(i) = Y(i + 1);
+	}
+	Y.Resize(n);
+
+	// rank-one update with Givens rotations
+	for (int i=0; i<n; ++i) {
+		real r = sqrt(L(i, i)*L(i, i) + l(i)*l(i));
+		real c = r / L(i, i);
+		real s = l(i) / L(i, i);
+		L(i, i) = r;
+		for (int j=i+1; j<n; ++j) {
+			L(i, j) = (L(i, j) + s*l(j)) / c;
+			l(j) = c*l(j) - s*L(i, j);
+		}
+	}
+	N = n;
+	n_cached = 0;
+}
+
+/// Solve \f$L^\top v = b\f$ by forward substitution, going through
+/// L by rows
+Vector GaussianProcess::SolveTransposed(const Vector& b) const
+{
+	Vector v = b;
+	for (int j=0; j<N; ++j) {
+		v(j) /= L(j, j);
+		real v_j = v(j);
+		for (int i=j+1; i<N; ++i) {
+			v(i) -= L(j, i) * v_j;
+		}
+	}
+	return v;
+}
+
+/// Solve \f$L v = b\f$ by back substitution
+Vector GaussianProcess::BackSubstitute(const Vector& b) const
+{
+	Vector v = b;
+	for (int i=N-1; i>=0; --i) {
+		real sum = v(i);
+		for (int j=i+1; j<N; ++j) {
+			sum -= L(i, j) * v(j);
+		}
+		v(i) = sum / L(i, i);
+	}
+	return v;
+}
 
 void GaussianProcess::UpdateGaussianProcess()
 {
+	if (window > 0 && N > window) {
+		Matrix X_new(window, X.Columns());
+		Vector Y_new(window);
+		for (int i=0; i<window; ++i) {
+			X_new.setRow(i, X.getRow(N - window + i));
+			Y_new(i) = Y(N - window + i);
+		}
+		X = X_new;
+		Y = Y_new;
+		N = window;
+	}
 	Covariance();
 	L = K.Cholesky();
-	inv_L = L.Inverse();
-	inv_K = inv_L*Transpose(inv_L);
-	alpha = inv_K*Y; 
+	z = SolveTransposed(Y);
+	alpha = BackSubstitute(z);
+	n_cached = 0;
 }
 
 real GaussianProcess::GeneratePrediction(const Vector& x)
@@ -175,6 +337,121 @@ void GaussianProcess::Prediction(Vector& x, real& mean, real& var)
 	var	     = PredictiveVariance(k);
 }
 
+/// Predict the rows of Xq in one pass
+void GaussianProcess::Prediction(const Matrix& Xq, Vector& mean_q, Vector& var_q)
+{
+	int M = Xq.Rows();
+	std::vector<real> Kq;
+	std::vector<real> V;
+	CrossKernel(Xq, 0, Kq);
+	SolveTransposedBlock(M, 0, Kq, V);
+	PredictBlock(M, Kq, V, mean_q, var_q);
+}
+
+/// Cache the kernel block for a fixed set of query points (one per row)
+void GaussianProcess::setCandidates(const Matrix& candidates_)
+{
+	candidates = candidates_;
+	n_cached = 0;
+}
+
+/// Predict the points given to setCandidates(), reusing the previous work
+void GaussianProcess::CandidatePrediction(Vector& mean_q, Vector& var_q)
+{
+	int M = candidates.Rows();
+	if (n_cached == 0) {
+		candidate_kernel.clear();
+		candidate_solution.clear();
+	}
+	CrossKernel(candidates, n_cached, candidate_kernel);
+	SolveTransposedBlock(M, n_cached, candidate_kernel, candidate_solution);
+	n_cached = N;
+	PredictBlock(M, candidate_kernel, candidate_solution, mean_q, var_q);
+}
+
+/** Append the kernel between samples [begin, N) and the rows of Xq
+	to Kq, which holds one row of Xq.Rows() values per sample.
+*/
+void GaussianProcess::CrossKernel(const Matrix& Xq, int begin, std::vector<real>& Kq) const
+{
+	int M = Xq.Rows();
+	int d = Xq.Columns();
+	std::vector<real> query(M * d);
+	for (int q=0; q<M; ++q) {
+		for (int j=0; j<d; ++j) {
+			query[q*d + j] = Xq(q, j) / scale_length(j);
+		}
+	}
+	real sig_noise = sig_var*sig_var;
+	Kq.resize(N * M);
+	std::vector<real> sample(d);
+	for (int i=begin; i<N; ++i) {
+		for (int j=0; j<d; ++j) {
+			sample[j] = X(i, j) / scale_length(j);
+		}
+		real* K_i = &Kq[i * M];
+		for (int q=0; q<M; ++q) {
+			const real* x_q = &query[q * d];
+			real delta = 0;
+			for (int j=0; j<d; ++j) {
+				real diff = x_q[j] - sample[j];
+				delta += diff * diff;
+			}
+			K_i[q] = sig_noise*exp(-0.5*delta);
+		}
+	}
+}
+
+/** Extend the solution V of L' V = Kq to rows [begin, N).
+
+	Row i only depends on the rows before it, so the rows of earlier
+	samples stay valid as long as L only grows.
+*/
+void GaussianProcess::SolveTransposedBlock(int M, int begin, const std::vector<real>& Kq, std::vector<real>& V) const
+{
+	V.resize(N * M);
+	for (int i=begin; i<N; ++i) {
+		real* V_i = &V[i * M];
+		const real* K_i = &Kq[i * M];
+		for (int q=0; q<M; ++q) {
+			V_i[q] = K_i[q];
+		}
+		for (int j=0; j<i; ++j) {
+			real L_ji = L(j, i);
+			const real* V_j = &V[j * M];
+			for (int q=0; q<M; ++q) {
+				V_i[q] -= L_ji * V_j[q];
+			}
+		}
+		real inv_L_ii = 1.0 / L(i, i);
+		for (int q=0; q<M; ++q) {
+			V_i[q] *= inv_L_ii;
+		}
+	}
+}
+
+/// Means and variances from the kernel block and its triangular solve
+void GaussianProcess::PredictBlock(int M, const std::vector<real>& Kq, const std::vector<real>& V, Vector& mean_q, Vector& var_q) const
+{
+	std::vector<real> mean_sum(M, 0.0);
+	std::vector<real> var_sum(M, sig_var*sig_var);
+	for (int i=0; i<N; ++i) {
+		const real* K_i = &Kq[i * M];
+		const real* V_i = &V[i * M];
+		real alpha_i = alpha(i);
+		for (int q=0; q<M; ++q) {
+			mean_sum[q] += K_i[q] * alpha_i;
+			var_sum[q] -= V_i[q] * V_i[q];
+		}
+	}
+	mean_q.Resize(M);
+	var_q.Resize(M);
+	for (int q=0; q<M; ++q) {
+		mean_q(q) = mean_sum[q];
+		var_q(q) = var_sum[q];
+	}
+}
+
 real GaussianProcess::PredictiveMean(const Vector& k)
 {
 	real mean = Product(k, alpha); ///(mean = k'*alpha) 
@@ -183,7 +460,7 @@ real GaussianProcess::PredictiveMean(const Vector& k)
 
 real GaussianProcess::PredictiveVariance(const Vector& k)
 {
-	Vector v = Transpose(inv_L)*k;
+	Vector v = SolveTransposed(k);
 	real var = sig_var*sig_var - Product(v,v);
 	return var;
 }
@@ -196,7 +473,7 @@ void GaussianProcess::Covariance()
 	for(int i=0; i<N; ++i) { 
 		Vector S = X.getRow(i);
 		for(int j = i; j < N; ++j) {
-			real delta = ((S - X.getRow(j))/scale_length).SquareNorm();
+			real delta = ((Lazy(S) - X.getRow(j))/scale_length).SquareNorm();
 			delta = sig_var*sig_var*exp(-0.5*delta);
 			if(i == j) {
 				K(i,j) = delta + noise_variance*noise_variance;
@@ -218,7 +495,7 @@ Matrix GaussianProcess::CovarianceDerivatives(int p)
 	for(int i=0; i<N; ++i) { 
 		Vector S = X.getRow(i);
 		for(int j = i; j < N; ++j) {
-			real delta = ((S - X.getRow(j))/scale_length).SquareNorm();
+			real delta = ((Lazy(S) - X.getRow(j))/scale_length).SquareNorm();
 			KK(i,j) = delta;
 			KK(j,i) = KK(i,j);
 			KE(i,j) = exp(-0.5*delta);
@@ -243,7 +520,7 @@ Vector GaussianProcess::Kernel(const Vector& x)
 	Vector k(N);
 	real sig_noise = sig_var*sig_var;
 	for(int i=0; i<N; ++i) { 
-		real delta = ((x - X.getRow(i))/scale_length).SquareNorm();
+		real delta = ((Lazy(x) - X.getRow(i))/scale_length).SquareNorm();
 		delta = sig_noise*exp(-0.5*delta);
 		k(i) = delta; 
 	}
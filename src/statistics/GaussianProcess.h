@@ -23,21 +23,36 @@
 /** Gaussian process. 
     
     This is a {\em conditional} distribution.
+
+	Observe() recomputes the Cholesky factor of the covariance from
+	scratch, while AddObservation() extends it by one row and column
+	in O(N^2). All solves with the covariance use triangular
+	substitution on the factor. With setWindow(), only the most recent
+	observations are kept, and the oldest one is removed from the
+	factor by a rank-one update.
+
+	Many points can be predicted at once with Prediction(const
+	Matrix&, Vector&, Vector&). When the same points are predicted
+	repeatedly, as for the arms of a bandit, they can be given to
+	setCandidates() instead. The kernel block and triangular solve
+	for the candidates are then cached, and only extended by one row
+	per AddObservation(), so CandidatePrediction() costs O(MN) rather
+	than O(MN^2) for M candidates.
  */
 class GaussianProcess
 {
 protected:
-	Matrix X; ///< Samples
+	Matrix X; ///< Samples, in the first N rows
 	Vector Y; ///< Output
 	int N;  ///< Total number of samples
 	Vector alpha; 
+	Vector z; ///< Solution of L' z = Y, so that L alpha = z
     Matrix Sigma_p;
     Matrix Accuracy;
     Matrix A;
-	Matrix L;  ///< Cholesky Decomposition (L is an upper tringular matrix)
-	Matrix inv_L;
-	Matrix K;  ///< Kernel(Covariance) Matrix
-	Matrix inv_K; ///< Inverse Covariance Matrix (Precision)
+	Matrix L;  ///< Cholesky Decomposition (L is an upper tringular matrix), in the first N rows and columns
+	Matrix K;  ///< Kernel(Covariance) Matrix, only set by Observe()
+	int window; ///< maximum number of samples kept, 0 for all
 	/// Kernel hyperparameters.
     real noise_variance;	///< noise variance
 	Vector scale_length;	///< lenght scale
@@ -45,6 +60,16 @@ protected:
     Matrix X2; ///< observation co-variance
     Vector mean;
     Matrix covariance;
+	Matrix candidates; ///< Points whose predictions are cached
+	std::vector<real> candidate_kernel; ///< Kernel with the candidates, one row per sample
+	std::vector<real> candidate_solution; ///< Solution of L' V = candidate_kernel
+	int n_cached; ///< Number of samples included in the candidate cache
+	void CrossKernel(const Matrix& Xq, int begin, std::vector<real>& Kq) const;
+	void SolveTransposedBlock(int M, int begin, const std::vector<real>& Kq, std::vector<real>& V) const;
+	void PredictBlock(int M, const std::vector<real>& Kq, const std::vector<real>& V, Vector& mean_q, Vector& var_q) const;
+	Vector SolveTransposed(const Vector& b) const;
+	Vector BackSubstitute(const Vector& b) const;
+	void RemoveFirstObservation();
 public:
     GaussianProcess(Matrix& Sigma_p_,
                     real noise_variance_);
@@ -58,6 +83,8 @@ public:
 					real hyp_u_);
     virtual ~GaussianProcess();
 	virtual int getNSamples() { return N; }
+	/// Keep at most window_ samples (0 for no limit)
+	virtual void setWindow(int window_);
     virtual Vector generate();
     virtual real pdf(Vector& x, real y);
     virtual void Observe(Vector& x, real y);
@@ -68,6 +95,9 @@ public:
 	virtual real GeneratePrediction(const Vector& x);
 	virtual real GeneratePredictionKernel(const Vector& k);
 	virtual void Prediction(Vector& x, real& mean, real& var);
+	virtual void Prediction(const Matrix& Xq, Vector& mean_q, Vector& var_q);
+	virtual void setCandidates(const Matrix& candidates_);
+	virtual void CandidatePrediction(Vector& mean_q, Vector& var_q);
 	virtual real PredictiveMean(const Vector& x);
 	virtual real PredictiveVariance(const Vector& x);
 	virtual void Covariance();
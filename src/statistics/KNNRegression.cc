@@ -10,6 +10,7 @@
  ***************************************************************************/
 
 #include "KNNRegression.h"
+#include "ParallelFor.h"
 
 /// Constructor
 KNNRegression::KNNRegression(int m, int n) : M(m), N(n), kd_tree(m) 
@@ -36,14 +37,16 @@ void KNNRegression::Evaluate(const Vector& x, Vector& y, int K) const
         y[i] = 0;
     }
 
-    OrderedFixedList<KDNode> node_list = kd_tree.FindKNearestNeighbours(x, K);
-    
-    std::list<std::pair<real, KDNode*> >::iterator it;
+    std::vector<std::pair<real, int> > node_list;
+    if (search_mode.Exact()) {
+        kd_tree.FindKNearestNeighbours(x, K, node_list);
+    } else {
+        kd_tree.FindKNearestNeighbours(x, K, search_mode, node_list, &search_statistics);
+    }
     
     real sum = 0;
-    for (it = node_list.S.begin(); it != node_list.S.end(); ++it) {
-        KDNode* node = it->second;
-        const PointPair* point_pair = kd_tree.getObject(node);
+    for (uint i=0; i<node_list.size(); ++i) {
+        const PointPair* point_pair = kd_tree.getObject(node_list[i].second);
         real w = rbf.Evaluate(point_pair->x);
 		//printf("R: "); point_pair->x.print(stdout);
 		//printf("X: "); rbf.center.print(stdout);
@@ -58,5 +61,40 @@ void KNNRegression::Evaluate(const Vector& x, Vector& y, int K) const
     //y.print(stdout);
 }
 
+/** Obtain K-nearest neighbour estimates of E[y | x] for each row of X.
 
-
+    Row i of Y is the estimate for row i of X, the same as given by
+    Evaluate(const Vector&, Vector&, int). The neighbours of all points
+    are found with one batch query, and the points are split among
+    n_threads threads.
+ */
+void KNNRegression::Evaluate(const Matrix& X, Matrix& Y, const int K, int n_threads) const
+{
+    int T = X.Rows();
+    std::vector<int> indices;
+    std::vector<real> distances;
+    kd_tree.FindKNearestNeighbours(X, K, indices, distances, n_threads,
+                                   search_mode, &search_statistics);
+    if (Y.Rows() != T || Y.Columns() != N) {
+        Y.Resize(T, N);
+    }
+    ParallelFor(T, n_threads,
+                [&](int begin, int end, int block) {
+                    Vector y(N);
+                    for (int t=begin; t<end; ++t) {
+                        RBF rbf(X.getRow(t), 10.0);
+                        y.Clear();
+                        real sum = 0;
+                        for (int k=0; k<K && indices[t * K + k] >= 0; ++k) {
+                            const PointPair* point_pair = kd_tree.getObject(indices[t * K + k]);
+                            real w = rbf.Evaluate(point_pair->x);
+                            y += point_pair->y * w;
+                            sum += w;
+                        }
+                        if (sum > 0) {
+                            y /= sum;
+                        }
+                        Y.setRow(t, y);
+                    }
+                });
+}
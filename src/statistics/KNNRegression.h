@@ -12,10 +12,11 @@
 #ifndef KNN_REGRESSION_H
 #define KNN_REGRESSION_H
 
-#include "KDTree.h"
+#include "FlatKDTree.h"
 //#include "CoverTree.h"
 #include "PointPair.h"
 #include "BasisSet.h"
+#include <list>
 
 /** K-Nearest-Neighbour regression */
 class KNNRegression
@@ -23,14 +24,35 @@ class KNNRegression
 protected:
     int M; ///< Tree and conditioning variable dimension
     int N; ///< Dimension of the conditioned variable
-	KDTree<PointPair> kd_tree; ///< The tree
+	FlatKDTree<PointPair> kd_tree; ///< The tree
 	//CoverTree<PointPair> kd_tree;
     //RBFBasisSet basis;
     std::list<PointPair> pairs; ///< A list of pairs
+    KNNSearchMode search_mode; ///< accuracy of neighbour searches
+    mutable KNNSearchStatistics search_statistics; ///< work done by approximate searches
 public:	
     KNNRegression(int m, int n);
     void AddElement(const PointPair& p);
     void Evaluate(const Vector&x, Vector& y, const int K) const;
+    void Evaluate(const Matrix& X, Matrix& Y, const int K, int n_threads = 1) const;
+    /** Use approximate neighbour searches.
+
+        \param epsilon the relative distance error allowed
+        \param max_leaves the maximum number of leaves searched (<= 0: no limit)
+
+        With the defaults, searches are exact. The statistics are
+        updated by Evaluate(), so concurrent calls must not use
+        approximate search.
+     */
+    void SetApproximateSearch(real epsilon = 0, int max_leaves = 0)
+    {
+        search_mode = KNNSearchMode(epsilon, max_leaves);
+    }
+    /// Work done by approximate searches so far
+    KNNSearchStatistics& getSearchStatistics() const
+    {
+        return search_statistics;
+    }
 };
 
 
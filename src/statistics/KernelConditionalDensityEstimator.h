@@ -60,6 +60,12 @@ public:
         //p_x.BootstrapBandwidth();
 
     }
+    /// The maximum number of points to keep in each estimator (<= 0: no limit)
+    void SetMaxPoints(int max_points)
+    {
+        p_xy.SetMaxPoints(max_points);
+        p_x.SetMaxPoints(max_points);
+    }
     void Show()
     {
 		printf ("# Kernel CDE\n");
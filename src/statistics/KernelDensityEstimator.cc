@@ -10,6 +10,7 @@
  ***************************************************************************/
 
 #include "KernelDensityEstimator.h"
+#include <algorithm>
 
 /// Constructor
 KernelDensityEstimator::KernelDensityEstimator(int n_dimensions,
@@ -18,8 +19,11 @@ KernelDensityEstimator::KernelDensityEstimator(int n_dimensions,
     : n(n_dimensions),
       b(initial_bandwidth),
       change_b(true),
+      tolerance(1e-6),
       nearest_neighbour_size(knn),
-      kd_tree(n_dimensions)
+      max_points(0),
+      kd_tree(n_dimensions),
+      total_weight(0)
 {
     
 }
@@ -37,11 +41,63 @@ real KernelDensityEstimator::Observe(const Vector& x)
 void KernelDensityEstimator::AddPoint(const Vector& x,  real w)
 {
     points.push_back(WeightedPoint(x, w));
-    if (nearest_neighbour_size > 0) {
-        kd_tree.AddVectorObject(x, &points.back());
+    kd_tree.AddVectorObject(x, &points.back());
+    weights.push_back(w);
+    total_weight += w;
+    if (max_points > 0 && (int) points.size() > max_points) {
+        Compress(std::max(max_points / 2, 1));
     }
 }
 
+/** Merge the closest points until at most n_points remain.
+
+    Each merged pair is replaced by its weighted mean, with the sum of
+    the weights, so that the total weight does not change.
+ */
+void KernelDensityEstimator::Compress(int n_points)
+{
+    assert(n_points > 0);
+    while ((int) points.size() > n_points) {
+        std::vector<std::pair<int, int> > pairs;
+        kd_tree.PairNearestNeighbours(points.size() - n_points, pairs);
+        std::vector<bool> merged(kd_tree.size(), false);
+        std::list<WeightedPoint> compressed;
+        for (uint k=0; k<pairs.size(); ++k) {
+            const WeightedPoint* p = kd_tree.getObject(pairs[k].first);
+            const WeightedPoint* q = kd_tree.getObject(pairs[k].second);
+            real w = p->w + q->w;
+            compressed.push_back(WeightedPoint((p->x * p->w + q->x * q->w) / w, w));
+            merged[pairs[k].first] = true;
+            merged[pairs[k].second] = true;
+        }
+        for (int i=0; i<kd_tree.size(); ++i) {
+            if (!merged[i]) {
+                compressed.push_back(*kd_tree.getObject(i));
+            }
+        }
+        points.swap(compressed);
+        Rebuild();
+    }
+}
+
+/// Rebuild the tree and the weights from the list of points
+void KernelDensityEstimator::Rebuild()
+{
+    Matrix X(points.size(), n);
+    std::vector<WeightedPoint*> objects;
+    weights.clear();
+    total_weight = 0;
+    for (std::list<WeightedPoint>::iterator it = points.begin();
+         it != points.end();
+         ++it) {
+        X.setRow(objects.size(), it->x);
+        objects.push_back(&(*it));
+        weights.push_back(it->w);
+        total_weight += it->w;
+    }
+    kd_tree.Build(X, objects);
+}
+
 real KernelDensityEstimator::log_pdf(const Vector& x)
 {
     real C = - 0.5 * ((real) n) * log(2.0 * M_PI);
@@ -59,33 +115,18 @@ real KernelDensityEstimator::log_pdf(const Vector& x)
     real ib2 = 1.0 / (b * b);
     real log_P = LOG_ZERO;
     if (nearest_neighbour_size == 0) {
-        for (std::list<WeightedPoint>::iterator it = points.begin();
-             it != points.end();
-             ++it) {
-            real d = SquareNorm(&x, &(it->x));
-            real log_p_i = C - 0.5 * d * ib2;
-            log_P = logAdd(log_P, log_p_i);
-        }
+        log_P = C + kd_tree.LogKernelSum(x, b, tolerance, &weights[0], total_weight);
     } else {
-        int K = points.size();
-        if (K > nearest_neighbour_size) {
-            K = nearest_neighbour_size;
-        }
-        OrderedFixedList<KDNode> node_list = kd_tree.FindKNearestNeighbours(x, K);
-        
-        for (std::list<std::pair<real, KDNode*> >::iterator it = node_list.S.begin();
-             it != node_list.S.end();
-             ++it) {
-            KDNode* node = it->second;
-            WeightedPoint* p = kd_tree.getObject(node);
-            real d = SquareNorm(&x, &(p->x));
-            real log_p_i = C - 0.5 * d * ib2;
+        std::vector<std::pair<real, int> > node_list;
+        kd_tree.FindKNearestNeighbours(x, nearest_neighbour_size, node_list);
+        for (uint i=0; i<node_list.size(); ++i) {
+            real log_p_i = C - 0.5 * node_list[i].first * ib2
+                + log(weights[node_list[i].second]);
             log_P = logAdd(log_P, log_p_i);
         }
     }
 
-    real N = (real) points.size(); 
-    return log_P - log(b) - log(N);
+    return log_P - log(b) - log(total_weight);
 }
 
 /// Use bootstrapping to estimate the bandwidth
@@ -100,7 +141,7 @@ void KernelDensityEstimator::BootstrapBandwidth()
         if (urandom() < 0.3) {
             test_data.push_back(*it);
         } else {
-            kde.AddPoint(it->x);
+            kde.AddPoint(it->x, it->w);
         }
     }
 
@@ -13,7 +13,7 @@
 #define KERNEL_DENSITY_ESTIMATOR_H
 
 #include "NormalDistribution.h"
-#include "KDTree.h"
+#include "FlatKDTree.h"
 #include "Vector.h"
 #include <list>
 
@@ -25,6 +25,16 @@
     \f[
     P(y | z) = P(y, z) / P(z).
     \f]
+
+    The points are kept in a FlatKDTree. When all points are used
+    (knn = 0), the kernel sum skips points whose total contribution is
+    less than tolerance times the sum, so that the log pdf is within
+    \f$\log(1 - \textrm{tolerance})\f$ of the exact one.
+
+    For long streams, SetMaxPoints() bounds the number of points kept.
+    When there are more, the closest pairs of points are merged into
+    their weighted means, until half as many remain. The estimate is
+    then a weighted sum over these centroids.
  */
 class KernelDensityEstimator
 {
@@ -44,6 +54,7 @@ public:
     int n; ///< The number of dimensions
     real b; ///< The bandwidth
     bool change_b; ///< Whether be should be able to change
+    real tolerance; ///< Relative error allowed in the kernel sum (0: exact)
     std::list<WeightedPoint> points; ///< A list of weighted points
     real Observe(const Vector& x); 
     void AddPoint(const Vector& x, real w = 1);
@@ -54,12 +65,22 @@ public:
     }
     real log_pdf(const Vector& x);
     void BootstrapBandwidth();
+    void Compress(int n_points);
+    /// The maximum number of points to keep (<= 0: no limit)
+    void SetMaxPoints(int max_points_)
+    {
+        max_points = max_points_;
+    }
     void Show()
     {
     }
 protected:
     int nearest_neighbour_size; ///< what size to use for the nearest neighbour
-    KDTree<WeightedPoint> kd_tree; ///< The tree, for faster access
+    int max_points; ///< maximum number of points kept
+    FlatKDTree<WeightedPoint> kd_tree; ///< The tree, for faster access
+    std::vector<real> weights; ///< The point weights, in tree order
+    real total_weight; ///< The sum of the weights
+    void Rebuild();
     
     
 };
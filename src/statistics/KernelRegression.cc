@@ -10,6 +10,7 @@
  ***************************************************************************/
 
 #include "KernelRegression.h"
+#include <algorithm>
 
 /// Constructor
 KernelRegression::KernelRegression(int n_dimensions_x,
@@ -20,8 +21,11 @@ KernelRegression::KernelRegression(int n_dimensions_x,
 	  n_y(n_dimensions_y),
       b(initial_bandwidth),
       change_b(true),
+      tolerance(1e-6),
       nearest_neighbour_size(knn),
-      kd_tree(n_dimensions_x)
+      max_points(0),
+      kd_tree(n_dimensions_x),
+      total_weight(0)
 {
     
 }
@@ -35,15 +39,69 @@ real KernelRegression::Observe(const Vector& x, const Vector& y)
 }
 
 
-/// Add a point x with weight w (defaults to w = 1)
-void KernelRegression::AddPoint(const Vector& x,  const Vector& y)
+/// Add a point x with output y and weight w (defaults to w = 1)
+void KernelRegression::AddPoint(const Vector& x,  const Vector& y, real w)
 {
-    points.push_back(PointPair(x, y));
-    if (nearest_neighbour_size > 0) {
-        kd_tree.AddVectorObject(x, &points.back());
+    points.push_back(PointPair(x, y, w));
+    kd_tree.AddVectorObject(x, &points.back());
+    weights.push_back(w);
+    total_weight += w;
+    if (max_points > 0 && (int) points.size() > max_points) {
+        Compress(std::max(max_points / 2, 1));
     }
 }
 
+/** Merge the closest points until at most n_points remain.
+
+    Each merged pair is replaced by its weighted mean, with the sum of
+    the weights. Points are paired by their distance in x only.
+ */
+void KernelRegression::Compress(int n_points)
+{
+    assert(n_points > 0);
+    while ((int) points.size() > n_points) {
+        std::vector<std::pair<int, int> > pairs;
+        kd_tree.PairNearestNeighbours(points.size() - n_points, pairs);
+        std::vector<bool> merged(kd_tree.size(), false);
+        std::list<PointPair> compressed;
+        for (uint k=0; k<pairs.size(); ++k) {
+            const PointPair* p = kd_tree.getObject(pairs[k].first);
+            const PointPair* q = kd_tree.getObject(pairs[k].second);
+            real w = p->w + q->w;
+            compressed.push_back(PointPair((p->x * p->w + q->x * q->w) / w,
+                                           (p->y * p->w + q->y * q->w) / w,
+                                           w));
+            merged[pairs[k].first] = true;
+            merged[pairs[k].second] = true;
+        }
+        for (int i=0; i<kd_tree.size(); ++i) {
+            if (!merged[i]) {
+                compressed.push_back(*kd_tree.getObject(i));
+            }
+        }
+        points.swap(compressed);
+        Rebuild();
+    }
+}
+
+/// Rebuild the tree and the weights from the list of points
+void KernelRegression::Rebuild()
+{
+    Matrix X(points.size(), n_x);
+    std::vector<PointPair*> objects;
+    weights.clear();
+    total_weight = 0;
+    for (std::list<PointPair>::iterator it = points.begin();
+         it != points.end();
+         ++it) {
+        X.setRow(objects.size(), it->x);
+        objects.push_back(&(*it));
+        weights.push_back(it->w);
+        total_weight += it->w;
+    }
+    kd_tree.Build(X, objects);
+}
+
 Vector KernelRegression::expected_value(const Vector& x) 
 {
 
@@ -55,46 +113,28 @@ Vector KernelRegression::expected_value(const Vector& x)
     }
 
     // otherwise, do the kernel estimate
-	real log_P = LOG_ZERO;
-
     real ib2 = 1.0 / (b * b);
+    std::vector<std::pair<real, int> > node_list;
     if (nearest_neighbour_size == 0) {
-        for (std::list<PointPair>::const_iterator it = points.begin();
-             it != points.end();
-             ++it) {
-            real d = SquareNorm(&x, &(it->x));
-            real log_p_i = - 0.5 * d * ib2;
-            log_P = logAdd(log_P, log_p_i);
-			real p_i = exp(log_p_i);
-			y += it->y * p_i;
-		}
+        kd_tree.FindKernelNeighbours(x, b, tolerance, node_list, &weights[0], total_weight);
     } else {
-        int K = points.size();
-        if (K > nearest_neighbour_size) {
-            K = nearest_neighbour_size;
-        }
-        OrderedFixedList<KDNode> node_list = kd_tree.FindKNearestNeighbours(x, K);
-		real max_log_p_i;
-		{
-			std::list<std::pair<real, KDNode*> >::iterator it = node_list.S.begin();
-			KDNode* node = it->second;
-            PointPair* p = kd_tree.getObject(node);
-			real d = SquareNorm(&x, &(p->x));
-			max_log_p_i =  - 0.5 * d * ib2;
-		}
-        for (std::list<std::pair<real, KDNode*> >::iterator it = node_list.S.begin();
-             it != node_list.S.end();
-             ++it) {
-            KDNode* node = it->second;
-            PointPair* p = kd_tree.getObject(node);
-            real d = SquareNorm(&x, &(p->x));
-            real log_p_i =  - 0.5 * d * ib2 - max_log_p_i;
-			real p_i = exp(log_p_i);
-            log_P = logAdd(log_P, log_p_i);
-			y += p->y * p_i;
+        kd_tree.FindKNearestNeighbours(x, nearest_neighbour_size, node_list);
+    }
+    // Weights are relative to the nearest point, to avoid underflow.
+    real min_d = node_list[0].first;
+    for (uint i=1; i<node_list.size(); ++i) {
+        min_d = std::min(min_d, node_list[i].first);
+    }
+    real P = 0;
+    for (uint i=0; i<node_list.size(); ++i) {
+        const PointPair* p = kd_tree.getObject(node_list[i].second);
+        real p_i = p->w * exp(- 0.5 * (node_list[i].first - min_d) * ib2);
+        P += p_i;
+        for (int j=0; j<n_y; ++j) {
+            y(j) += p_i * p->y(j);
         }
     }
-	return y * exp(-log_P);
+	return y / P;
 	//    return exp(log_Y - log_P);
 }
 
@@ -110,7 +150,7 @@ void KernelRegression::BootstrapBandwidth()
         if (urandom() < 0.3) {
             test_data.push_back(*it);
         } else {
-            kde.AddPoint(it->x, it->y);
+            kde.AddPoint(it->x, it->y, it->w);
         }
     }
 
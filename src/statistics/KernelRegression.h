@@ -13,12 +13,20 @@
 #define KERNEL_REGRESSION_H
 
 #include "NormalDistribution.h"
-#include "KDTree.h"
+#include "FlatKDTree.h"
 #include "Vector.h"
 #include <list>
 
 /** Kernel method for regression.
 
+    The points are kept in a FlatKDTree. When all points are used
+    (knn = 0), points whose total kernel weight is less than tolerance
+    times the total are skipped.
+
+    As for KernelDensityEstimator, SetMaxPoints() bounds the number of
+    points kept, by merging the closest pairs of points when there are
+    too many. A merged pair has the weighted mean of the x and y of the
+    two points, and the sum of their weights.
  */
 class KernelRegression
 {
@@ -28,8 +36,9 @@ public:
     {
         Vector x;
         Vector y;
-        PointPair(const Vector& x_, const Vector y_)
-            : x(x_), y(y_)
+        real w;
+        PointPair(const Vector& x_, const Vector y_, real w_ = 1)
+            : x(x_), y(y_), w(w_)
         { }
     };
     KernelRegression(int n_dimensions_x,
@@ -40,21 +49,32 @@ public:
     int n_y; ///< The number of dimensions in y
     real b; ///< The bandwidth
     bool change_b; ///< Whether be should be able to change
+    real tolerance; ///< Relative error allowed in the kernel sums (0: exact)
     std::list<PointPair> points; ///< A list of weighted points
     real Observe(const Vector& x, const Vector& y); 
-    void AddPoint(const Vector& x, const Vector& y);
+    void AddPoint(const Vector& x, const Vector& y, real w = 1);
     Vector expected_value(const Vector& x);
 	real log_pdf(const Vector& x, const Vector& y)
 	{
 		return - (y - expected_value(x)).SquareNorm();
 	}
     void BootstrapBandwidth();
+    void Compress(int n_points);
+    /// The maximum number of points to keep (<= 0: no limit)
+    void SetMaxPoints(int max_points_)
+    {
+        max_points = max_points_;
+    }
     void Show()
     {
     }
 protected:
     int nearest_neighbour_size; ///< what size to use for the nearest neighbour
-    KDTree<PointPair> kd_tree; ///< The tree, for faster access
+    int max_points; ///< maximum number of points kept
+    FlatKDTree<PointPair> kd_tree; ///< The tree, for faster access
+    std::vector<real> weights; ///< The point weights, in tree order
+    real total_weight; ///< The sum of the weights
+    void Rebuild();
     
     
 };
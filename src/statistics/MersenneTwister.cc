@@ -15,23 +15,47 @@
 #include <ctime>
 
 // The initial seed.
-unsigned long MersenneTwister::initial_seed;
+thread_local unsigned long MersenneTwister::initial_seed;
+unsigned long MersenneTwister::master_seed = 0;
+bool MersenneTwister::has_master_seed = false;
+std::mutex MersenneTwister::master_mutex;
+std::atomic<int> MersenneTwister::n_threads(0);
+thread_local int MersenneTwister::thread_index = -1;
 
 ///// Code for the Mersenne Twister random generator....
 const int MersenneTwister::n = 624;
 const int MersenneTwister::m = 397;
-int MersenneTwister::left = 1;
-int MersenneTwister::initf = 0;
-unsigned long *MersenneTwister::next;
-unsigned long MersenneTwister::state[MersenneTwister::n]; /* the array for the state vector  */
+thread_local int MersenneTwister::left = 1;
+thread_local int MersenneTwister::initf = 0;
+thread_local unsigned long *MersenneTwister::next;
+thread_local unsigned long MersenneTwister::state[MersenneTwister::n]; /* the array for the state vector  */
 ////////////////////////////////////////////////////////
+int MersenneTwister::getThreadIndex()
+{
+  if (thread_index < 0) {
+    thread_index = n_threads++;
+  }
+  return thread_index;
+}
+
+/// Seed with the master seed plus the thread number. The master seed
+/// is taken from the clock if no seed has been given on thread 0.
 void MersenneTwister::seed()
 {
-  time_t ltime;
-  struct tm *today;
-  time(&ltime);
-  today = localtime(&ltime);
-  manualSeed((unsigned long)today->tm_sec);
+  unsigned long the_seed;
+  {
+    std::lock_guard<std::mutex> lock(master_mutex);
+    if (!has_master_seed) {
+      time_t ltime;
+      struct tm *today;
+      time(&ltime);
+      today = localtime(&ltime);
+      master_seed = (unsigned long)today->tm_sec;
+      has_master_seed = true;
+    }
+    the_seed = master_seed + getThreadIndex();
+  }
+  manualSeed(the_seed);
 }
 
 ///////////// The next 4 methods are taken from http://www.math.keio.ac.jp/matumoto/emt.html
@@ -94,6 +118,11 @@ void MersenneTwister::seed()
 
 void MersenneTwister::manualSeed(unsigned long the_seed_)
 {
+  if (getThreadIndex() == 0) {
+    std::lock_guard<std::mutex> lock(master_mutex);
+    master_seed = the_seed_;
+    has_master_seed = true;
+  }
   initial_seed = the_seed_;
   state[0]= initial_seed & 0xffffffffUL;
   for(int j = 1; j < n; j++)
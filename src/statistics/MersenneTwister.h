@@ -15,18 +15,34 @@
 
 #include "real.h"
 #include "RandomNumberGenerator.h"
+#include <atomic>
+#include <mutex>
 
-// This is a static Mersenne Twister random number generator
+/** This is a static Mersenne Twister random number generator.
+
+    The state is kept per thread, so that threads drawing from it (for
+    example through urandom()) do not race. Threads are numbered in
+    the order in which they first use the generator. A thread that has
+    not called manualSeed() is seeded with the master seed plus its
+    number, so that worker threads get different streams. The master
+    seed is set by manualSeed() on thread 0, normally the main thread,
+    or else from the clock.
+*/
 class MersenneTwister 
 {
 protected:
-	static unsigned long initial_seed;
+	static unsigned long master_seed; ///< seed of thread 0; guarded by master_mutex
+	static bool has_master_seed; ///< whether master_seed is set
+	static std::mutex master_mutex;
+	static std::atomic<int> n_threads;
+	static thread_local int thread_index;
+	static thread_local unsigned long initial_seed;
     static const int n;
     static const int m;
-    static unsigned long state[]; /* the array for the state vector  */
-    static int left;
-    static int initf;
-    static unsigned long *next;
+    static thread_local unsigned long state[]; /* the array for the state vector  */
+    static thread_local int left;
+    static thread_local int initf;
+    static thread_local unsigned long *next;
     static void nextState();
 public:
     ~MersenneTwister();
@@ -37,6 +53,9 @@ public:
 
     /// Returns the starting seed used.
     static unsigned long getInitialSeed();
+
+    /// The number of the calling thread, from 0.
+    static int getThreadIndex();
 	
     /// Generates a uniform 32 bits integer.
     static unsigned long random();
@@ -99,15 +99,15 @@ void SparseGaussianProcess::AddObservation(const Vector& x, const real& y)
 		real rr =  Product(iKk, k);
 		mu = (1.0 - rr);
 		if(mu > v) {
-			inv_K = (mu*inv_K) + OuterProduct(iKk,iKk);
+			inv_K *= mu;
+			inv_K += OuterProduct(iKk,iKk);
 			iKk = iKk*(-1.0);
-			inv_K = inv_K.AddRow(iKk);
+			inv_K.AppendRow(iKk);
 			iKk.AddElement(1.0);
-			inv_K = inv_K.AddColumn(iKk);
-			Matrix kk = inv_K*(1/mu);
-			inv_K= kk;
+			inv_K.AppendColumn(iKk);
+			inv_K *= 1/mu;
 			N++;
-			X = X.AddRow(x);
+			X.AppendRow(x);
 			Y.AddElement(y);
 		}
 	}
@@ -188,7 +188,7 @@ void SparseGaussianProcess::Covariance()
 	for(int i=0; i<N; ++i) { 
 		Vector S = X.getRow(i);
 		for(int j = i; j < N; ++j) {
-			real delta = ((S - X.getRow(j))/scale_length).SquareNorm();
+			real delta = ((Lazy(S) - X.getRow(j))/scale_length).SquareNorm();
 			delta = sig_var*sig_var*exp(-0.5*delta);
 			if(i == j) {
 				K(i,j) = delta + noise_variance*noise_variance;
@@ -206,7 +206,7 @@ Vector SparseGaussianProcess::Kernel(const Vector& x)
 	Vector k(N);
 	real sig_noise = sig_var*sig_var;
 	for(int i=0; i<N; ++i) { 
-		real delta = ((x - X.getRow(i))/scale_length).SquareNorm();
+		real delta = ((Lazy(x) - X.getRow(i))/scale_length).SquareNorm();
 		delta = sig_noise*exp(-0.5*delta);
 		k(i) = delta; 
 	}
@@ -219,7 +219,7 @@ Vector SparseGaussianProcess::Kernel(const Vector& x, const Vector& scale)
 	Vector k(N);
 	real sig_noise = sig_var*sig_var;
 	for(int i=0; i<N; ++i) { 
-		real delta = ((x - X.getRow(i))/scale).SquareNorm();
+		real delta = ((Lazy(x) - X.getRow(i))/scale).SquareNorm();
 		k(i) = sig_noise*exp(-0.5*delta);
 	}
 	return k;
@@ -44,7 +44,132 @@ int main (int argc, char** argv)
 	}
 	
 	GP.Observe(InputData, OutputData);
-    return 0;
+
+	// Incremental updates should agree with fitting all the data at once.
+	int n_errors = 0;
+	{
+		int n_samples = 200;
+		int window = 50;
+		Vector scale_length(n_dim);
+		for (int n=0; n<n_dim; ++n) {
+			scale_length(n) = 1.0;
+		}
+		GaussianProcess online(0.1, scale_length, 1.0);
+		GaussianProcess windowed(0.1, scale_length, 1.0);
+		windowed.setWindow(window);
+		Matrix X(n_samples, n_dim);
+		Vector Y(n_samples);
+		for (int t=0; t<n_samples; ++t) {
+			Vector x(n_dim);
+			for (int n=0; n<n_dim; ++n) {
+				x(n) = normal.generate();
+			}
+			X.setRow(t, x);
+			Y(t) = sin(x.Sum()) + 0.1 * normal.generate();
+			online.AddObservation(x, Y(t));
+			windowed.AddObservation(x, Y(t));
+		}
+		GaussianProcess batch(0.1, scale_length, 1.0);
+		batch.Observe(X, Y);
+		Matrix X_recent(window, n_dim);
+		Vector Y_recent(window);
+		for (int t=0; t<window; ++t) {
+			X_recent.setRow(t, X.getRow(n_samples - window + t));
+			Y_recent(t) = Y(n_samples - window + t);
+		}
+		GaussianProcess recent(0.1, scale_length, 1.0);
+		recent.Observe(X_recent, Y_recent);
+		if (windowed.getNSamples() != window) {
+			n_errors++;
+		}
+		for (int t=0; t<20; ++t) {
+			Vector x(n_dim);
+			for (int n=0; n<n_dim; ++n) {
+				x(n) = normal.generate();
+			}
+			real mean, var, batch_mean, batch_var;
+			online.Prediction(x, mean, var);
+			batch.Prediction(x, batch_mean, batch_var);
+			if (fabs(mean - batch_mean) > 1e-6 || fabs(var - batch_var) > 1e-6) {
+				n_errors++;
+			}
+			windowed.Prediction(x, mean, var);
+			recent.Prediction(x, batch_mean, batch_var);
+			if (fabs(mean - batch_mean) > 1e-6 || fabs(var - batch_var) > 1e-6) {
+				n_errors++;
+			}
+		}
+		if (fabs(online.LogLikelihood() - batch.LogLikelihood()) > 1e-6) {
+			n_errors++;
+		}
+
+		// Batch and cached predictions agree with single ones.
+		int n_queries = 30;
+		Matrix Q(n_queries, n_dim);
+		for (int q=0; q<n_queries; ++q) {
+			for (int n=0; n<n_dim; ++n) {
+				Q(q, n) = normal.generate();
+			}
+		}
+		GaussianProcess cached(0.1, scale_length, 1.0);
+		cached.setCandidates(Q);
+		for (int t=0; t<n_samples; ++t) {
+			cached.AddObservation(X.getRow(t), Y(t));
+			if (t % 50 == 0) {
+				Vector cached_mean, cached_var;
+				cached.CandidatePrediction(cached_mean, cached_var);
+			}
+		}
+		Vector batch_means, batch_vars, cached_mean, cached_var;
+		online.Prediction(Q, batch_means, batch_vars);
+		cached.CandidatePrediction(cached_mean, cached_var);
+		for (int q=0; q<n_queries; ++q) {
+			Vector x = Q.getRow(q);
+			real mean, var;
+			online.Prediction(x, mean, var);
+			if (fabs(mean - batch_means(q)) > 1e-6 || fabs(var - batch_vars(q)) > 1e-6
+				|| fabs(mean - cached_mean(q)) > 1e-6 || fabs(var - cached_var(q)) > 1e-6) {
+				n_errors++;
+			}
+		}
+	}
+
+	// The lazy kernel gives the same values as plain Vector arithmetic.
+	{
+		int n_inputs = 3;
+		int n_samples = 10;
+		real sig_var = 1.5;
+		Vector scale_length(n_inputs);
+		for (int n=0; n<n_inputs; ++n) {
+			scale_length(n) = 0.5 + n;
+		}
+		GaussianProcess gp(0.1, scale_length, sig_var);
+		std::vector<Vector> X(n_samples);
+		for (int t=0; t<n_samples; ++t) {
+			X[t] = Vector(n_inputs);
+			for (int n=0; n<n_inputs; ++n) {
+				X[t](n) = normal.generate();
+			}
+			gp.AddObservation(X[t], normal.generate());
+		}
+		Vector x(n_inputs);
+		for (int n=0; n<n_inputs; ++n) {
+			x(n) = normal.generate();
+		}
+		Vector k = gp.Kernel(x);
+		for (int t=0; t<n_samples; ++t) {
+			real delta = ((x - X[t])/scale_length).SquareNorm();
+			if (k(t) != sig_var*sig_var*exp(-0.5*delta)) {
+				n_errors++;
+			}
+		}
+	}
+	if (n_errors) {
+		printf ("# %d ERRORS found\n", n_errors);
+	} else {
+		printf ("# All tests OK\n");
+	}
+    return n_errors;
 }
 
 #endif
@@ -0,0 +1,136 @@
+/* -*- Mode: C++; -*- */
+/***************************************************************************
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ ***************************************************************************/
+
+#ifdef MAKE_MAIN
+
+#include "KernelDensityEstimator.h"
+#include "KernelRegression.h"
+#include "Random.h"
+#include "EasyClock.h"
+
+/// Draw a point near the curve x_1 = x_0^2
+Vector Sample()
+{
+    Vector x(2);
+    x(0) = urandom();
+    x(1) = x(0) * x(0) + 0.1 * urandom();
+    return x;
+}
+
+/// Compare a density estimator with a bounded number of points to an unbounded one.
+int kernel_density_compression_test(int T, int max_points)
+{
+    printf ("# Testing density estimation with %d points, at most %d kept\n",
+            T, max_points);
+    KernelDensityEstimator kde(2, 0.05, 0);
+    KernelDensityEstimator bounded_kde(2, 0.05, 0);
+    bounded_kde.SetMaxPoints(max_points);
+    for (int t=0; t<T; ++t) {
+        Vector x = Sample();
+        kde.AddPoint(x);
+        bounded_kde.AddPoint(x);
+    }
+
+    int n_errors = 0;
+    if ((int) bounded_kde.points.size() > max_points) {
+        printf ("ERROR: %d points kept\n", (int) bounded_kde.points.size());
+        n_errors++;
+    }
+    real total_weight = 0;
+    for (std::list<KernelDensityEstimator::WeightedPoint>::iterator it = bounded_kde.points.begin();
+         it != bounded_kde.points.end();
+         ++it) {
+        total_weight += it->w;
+    }
+    if (fabs(total_weight - T) > 1e-6) {
+        printf ("ERROR: total weight %f, should be %d\n", total_weight, T);
+        n_errors++;
+    }
+
+    int n_test = 1000;
+    real log_p = 0;
+    real bounded_log_p = 0;
+    for (int t=0; t<n_test; ++t) {
+        Vector x = Sample();
+        log_p += kde.log_pdf(x);
+        bounded_log_p += bounded_kde.log_pdf(x);
+    }
+    log_p /= (real) n_test;
+    bounded_log_p /= (real) n_test;
+    printf ("# Average log-likelihood: %f (all points), %f (%d points)\n",
+            log_p, bounded_log_p, (int) bounded_kde.points.size());
+    if (fabs(log_p - bounded_log_p) > 0.1) {
+        printf ("ERROR: log-likelihood differs by %f\n", log_p - bounded_log_p);
+        n_errors++;
+    }
+    return n_errors;
+}
+
+/// Compare a kernel regression with a bounded number of points to an unbounded one.
+int kernel_regression_compression_test(int T, int max_points)
+{
+    printf ("# Testing regression with %d points, at most %d kept\n",
+            T, max_points);
+    KernelRegression kernel_regression(2, 1, 0.05);
+    KernelRegression bounded_kernel_regression(2, 1, 0.05);
+    bounded_kernel_regression.SetMaxPoints(max_points);
+    Vector y(1);
+    for (int t=0; t<T; ++t) {
+        Vector x = Sample();
+        y(0) = sin(6 * x(0));
+        kernel_regression.AddPoint(x, y);
+        bounded_kernel_regression.AddPoint(x, y);
+    }
+
+    int n_errors = 0;
+    if ((int) bounded_kernel_regression.points.size() > max_points) {
+        printf ("ERROR: %d points kept\n", (int) bounded_kernel_regression.points.size());
+        n_errors++;
+    }
+
+    int n_test = 1000;
+    real error = 0;
+    real bounded_error = 0;
+    for (int t=0; t<n_test; ++t) {
+        Vector x = Sample();
+        real y_t = sin(6 * x(0));
+        real e = kernel_regression.expected_value(x)(0) - y_t;
+        real bounded_e = bounded_kernel_regression.expected_value(x)(0) - y_t;
+        error += e * e;
+        bounded_error += bounded_e * bounded_e;
+    }
+    error /= (real) n_test;
+    bounded_error /= (real) n_test;
+    printf ("# Mean squared error: %f (all points), %f (%d points)\n",
+            error, bounded_error, (int) bounded_kernel_regression.points.size());
+    if (bounded_error > 2 * error + 0.01) {
+        printf ("ERROR: mean squared error too large\n");
+        n_errors++;
+    }
+    return n_errors;
+}
+
+int main(void)
+{
+    setRandomSeed(1);
+    int n_errors = 0;
+    n_errors += kernel_density_compression_test(10000, 1000);
+    n_errors += kernel_density_compression_test(10000, 100);
+    n_errors += kernel_regression_compression_test(10000, 1000);
+
+    if (n_errors) {
+        printf ("# %d ERRORS found\n", n_errors);
+    } else {
+        printf ("# All tests OK\n");
+    }
+    return n_errors;
+}
+
+#endif